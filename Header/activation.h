@@ -0,0 +1,159 @@
+/*
+* 	Header-file for the activation functions of layers
+*
+* 	Each activation is a policy: a struct of static inline functions that a layer takes as a template argument,
+* 	so that the loops of CalcOutputs and FindDeltas are compiled for it and call nothing per neuron
+*/
+
+#ifndef ACTIVATION_H
+#define ACTIVATION_H
+
+#include "library.h"
+
+//Slope of the leaky ReLU for negative sums
+const double LEAKY_RELU_SLOPE = 0.01;
+
+///<summary>
+/// Output = 1 / (1 + exp( - Sum ) ), as SigmoidalLayerNetwork has always used
+///</summary>
+struct SigmoidActivation {
+
+	//LayerType() of a hidden layer using it, and name as printed
+	static const char TYPE = 'M';
+	static const char * Name () { return "sigmoid"; }
+
+	//Floating-point operations of one delta
+	static const int DELTA_FLOPS = 3;
+
+	static inline double Apply (double sum) { return 1 / (1 + exp( -1 * sum)); }
+
+	//Slope of the activation, from its output
+	static inline double Slope (double output) { return output * (1 - output); }
+};
+
+///<summary>
+/// Output = tanh ( Sum ), in -1..1, with a slope of 1 at 0 rather than the sigmoid's 0.25
+///</summary>
+struct TanhActivation {
+
+	static const char TYPE = 'T';
+	static const char * Name () { return "tanh"; }
+
+	static const int DELTA_FLOPS = 3;
+
+	static inline double Apply (double sum) { return tanh (sum); }
+
+	static inline double Slope (double output) { return 1 - output * output; }
+};
+
+///<summary>
+/// Output = max ( 0, Sum ): no exp, and no saturation for positive sums
+///</summary>
+struct ReluActivation {
+
+	static const char TYPE = 'R';
+	static const char * Name () { return "relu"; }
+
+	static const int DELTA_FLOPS = 1;
+
+	static inline double Apply (double sum) { return (sum > 0) ? sum : 0; }
+
+	static inline double Slope (double output) { return (output > 0) ? 1 : 0; }
+};
+
+///<summary>
+/// Output = Sum, or LEAKY_RELU_SLOPE * Sum if negative, so neurons with negative sums still learn
+///</summary>
+struct LeakyReluActivation {
+
+	static const char TYPE = 'E';
+	static const char * Name () { return "leaky_relu"; }
+
+	static const int DELTA_FLOPS = 1;
+
+	static inline double Apply (double sum) { return (sum > 0) ? sum : LEAKY_RELU_SLOPE * sum; }
+
+	//The output has the sign of the sum
+	static inline double Slope (double output) { return (output > 0) ? 1 : LEAKY_RELU_SLOPE; }
+};
+
+///<summary>
+/// Output = 0.2 * Sum + 0.5, limited to 0..1: a piecewise-linear sigmoid without exp
+///</summary>
+struct HardSigmoidActivation {
+
+	static const char TYPE = 'H';
+	static const char * Name () { return "hard_sigmoid"; }
+
+	static const int DELTA_FLOPS = 1;
+
+	static inline double Apply (double sum)
+	{
+		double output = 0.2 * sum + 0.5;
+		return (output < 0) ? 0 : (output > 1) ? 1 : output;
+	}
+
+	static inline double Slope (double output) { return (output > 0 && output < 1) ? 0.2 : 0; }
+};
+
+///<summary>
+/// Applies an activation, in place, to count weighted sums
+///</summary>
+template <class Act> inline void ActivateValues (double values[], int count)
+{
+	for (int value_counter=0; value_counter < count; value_counter++)
+		values[value_counter] = Act::Apply (values[value_counter]);
+}
+
+///<summary>
+/// Calculates deltas = Slope ( Outputs ) * Errors of count neurons
+///</summary>
+template <class Act> inline void ActivationDeltas (const double outputs[], const double errors[], double deltas[], int count)
+{
+	for (int output_index=0; output_index < count; output_index++)
+		deltas[output_index] = Act::Slope (outputs[output_index]) * errors[output_index];
+}
+
+///<summary>
+/// Replaces count weighted sums by their softmax, exp( Sum ) / SUM{ exp( Sums ) }: positive and adding to 1.
+/// The largest sum is taken from each before exp, so no sum is too large or too small to give an answer
+///</summary>
+void Softmax (double values[], int count);
+
+///<summary>
+/// Returns true if option is the LayerType() of a hidden layer with an activation of its own:
+/// 'T' tanh, 'R' ReLU, 'E' leaky ReLU or 'H' hard sigmoid (see MakeNet)
+///</summary>
+bool IsHiddenActivation (char option);
+
+///<summary>
+/// Returns the output of a layer of the given LayerType() for a weighted sum, as its CalcOutputs would,
+/// for code that reads layers one value at a time such as the Predictor. A softmax layer ('C') depends on
+/// all of its sums, so the sum is returned as it is and Softmax() is applied once the layer is done
+///</summary>
+double ActivateSum (char layerType, double sum);
+
+///<summary>
+/// Applies the activation of a layer of the given LayerType(), in place, to whole rows of weighted sums,
+/// as its Activate would. The switch is made once; each case is a loop compiled for its activation
+///
+///<argument="char layerType"> LayerType() of the layer</argument>
+///<argument="double values[]"> Array containing rows of weighted sums</argument>
+///<argument="int count"> Amount of values, a multiple of rowLength</argument>
+///<argument="int rowLength"> Neurons of the layer, by which softmax ('C') takes its rows</argument>
+///</summary>
+void ActivateLayerValues (char layerType, double values[], int count, int rowLength);
+
+///<summary>
+/// Calculates the deltas of count neurons of a layer of the given LayerType() from their errors and outputs, as its
+/// FindDeltas would. Linear and softmax layers take the errors as their deltas, softmax as it is trained on the
+/// cross-entropy. errors[] may be deltas[] itself
+///</summary>
+void LayerValueDeltas (char layerType, const double outputs[], const double errors[], double deltas[], int count);
+
+///<summary>
+/// Returns the name of the activation of a layer of the given LayerType()
+///</summary>
+const char * ActivationName (char layerType);
+
+#endif
@@ -0,0 +1,80 @@
+/*
+* 	Header-file for arenas: single aligned blocks of memory from which many arrays are carved
+*/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "library.h"
+
+//Alignment of the block and of every array carved from it : one cache line
+const size_t ARENA_ALIGN = 64;
+
+//Size of a huge page, and so the smallest block worth backing with them
+const size_t ARENA_HUGE_PAGE = 2 * 1024 * 1024;
+
+///<summary>
+/// One aligned block of memory, zeroed on creation, from which arrays are handed out in turn.
+/// Arrays are never freed on their own : the whole block is returned when the arena is deleted
+///</summary>
+class Arena {
+
+	protected:
+
+		//Start of the block
+		char *block;
+
+		//Size of the block, and bytes handed out so far
+		size_t capacity;
+		size_t used;
+
+		//True if the block came from mmap rather than the heap
+		bool mapped;
+
+		//Whether new arenas of at least ARENA_HUGE_PAGE bytes ask for huge pages
+		static bool hugePagesByDefault;
+
+	public:
+
+		///<summary>
+		/// Constructor, allocates and zeroes the block
+		///
+		///<argument="size_t bytes"> Size of the block, as found by adding up Bytes() of every array</argument>
+		///<argument="bool hugePages"> If true, and the block is large enough, back it with huge pages where the system allows</argument>
+		///</summary>
+		Arena (size_t bytes, bool hugePages = hugePagesByDefault);
+
+		///<summary>
+		/// Destructor, returns the whole block
+		///</summary>
+		~Arena ();
+
+		///<summary>
+		/// Returns the space an array of count items of the given size takes in an arena, including alignment.
+		/// Ends the program if it is too large for a size_t
+		///</summary>
+		static size_t Bytes (size_t count, size_t itemSize = sizeof(double));
+
+		///<summary>
+		/// Sets whether arenas ask for huge pages unless told otherwise
+		///</summary>
+		static void SetHugePages (bool useHugePages);
+
+		///<summary>
+		/// Returns the address of the next count doubles in the block, ending the program if they do not fit
+		///</summary>
+		double * Doubles (size_t count);
+
+		///<summary>
+		/// Returns the address of the next count chars in the block, ending the program if they do not fit
+		///</summary>
+		char * Chars (size_t count);
+
+		///<summary>
+		/// Returns the size of the block and the bytes handed out so far
+		///</summary>
+		size_t Capacity ();
+		size_t Used ();
+};
+
+#endif
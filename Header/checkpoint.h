@@ -0,0 +1,247 @@
+/*
+* 	Header-file for binary checkpoints of networks and their training state
+*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "library.h"
+
+//Version written into, and expected from, every checkpoint
+const int CHECKPOINT_VERSION = 1;
+
+///<summary>
+/// Training state saved alongside the weights, so that training can carry on exactly where it stopped
+///</summary>
+struct TrainingState {
+
+	//Epochs done so far
+	long long epoch;
+
+	//Learning parameters: {learning-rate, momentum}
+	double learningParameters[2];
+
+	//Epochs ordered so far by the generator ordering the rows (see SampleOrder::GetState), and its strategy
+	unsigned long long rngState;
+	int orderStrategy;
+};
+
+///<summary>
+/// Size and activation of one layer, as stored in a checkpoint
+///</summary>
+struct CheckpointLayer {
+
+	int numInputs;
+	int numNeurons;
+
+	//LayerType() of the layer : 'L', 'S' or 'M', 'C' for a softmax output layer, or for a hidden layer 'T', 'R', 'E' or 'H' (see activation.h)
+	int layerType;
+
+	int reserved;
+};
+
+///<summary>
+/// Fixed-size start of a checkpoint file. Every section after it starts at the given offset, aligned
+/// to a cache line, so that a mapped file can be read in place
+///</summary>
+struct CheckpointHeader {
+
+	//"ANNCKPT" and a 0
+	char magic[8];
+
+	int version;
+	int numLayers;
+
+	//LayerType() of the first layer
+	int networkType;
+
+	//1 if the min/max of the training data are stored
+	int hasScaling;
+
+	TrainingState state;
+
+	//Sizes and datatype of the training data
+	int datatype;
+	int numInputs;
+	int numOutputs;
+	int reserved;
+
+	//Total amount of weights, in SetTheWeights order
+	long long numWeights;
+
+	//Offsets, from the start of the file, of the layers, the min/max, the weights and the changes in weights
+	long long layersOffset;
+	long long scalingOffset;
+	long long weightsOffset;
+	long long deltaWeightsOffset;
+
+	//Size of the whole file
+	long long totalBytes;
+};
+
+///<summary>
+/// Saves and loads networks as versioned binary files holding the topology, activations, weights,
+/// changes in weights (momentum state), training state and, optionally, the min/max of the training data.
+/// Files are written to a temporary name, synced, then renamed, so a crash never leaves half a checkpoint;
+/// they are loaded by memory-mapping, so weights are copied straight from the page cache
+///</summary>
+class Checkpoint {
+
+	public:
+
+		///<summary>
+		/// Fills layers[] with the size and type of each layer of the network
+		///
+		///<argument="LinearLayerNetwork *net"> Network to describe</argument>
+		///<argument="vector<CheckpointLayer> &layers"> Onto which the layers are stored, first to last</argument>
+		///</summary>
+		static void Describe (LinearLayerNetwork *net, vector<CheckpointLayer> &layers);
+
+		///<summary>
+		/// Writes a checkpoint from weights and changes in weights that have already been copied out of a network
+		///
+		///<argument="const char *filename"> Path and filename of the checkpoint</argument>
+		///<argument="vector<CheckpointLayer> &layers"> Layers, as found by Describe()</argument>
+		///<argument="const double weights[]"> All weights, in SetTheWeights order</argument>
+		///<argument="const double deltaWeights[]"> All changes in weights, in the same order</argument>
+		///<argument="const TrainingState &state"> Training state</argument>
+		///<argument="const DataScaling *scaling"> Min/max of the training data, or 0</argument>
+		///<argument="bool sync"> If true, the file is flushed to disk before it is renamed into place</argument>
+		///
+		///<return="bool"> True if the checkpoint was written</return>
+		///</summary>
+		static bool WriteFile (const char *filename, vector<CheckpointLayer> &layers, const double weights[], const double deltaWeights[],
+							   const TrainingState &state, const DataScaling *scaling, bool sync = true);
+
+		///<summary>
+		/// Saves a network to a checkpoint
+		///
+		///<argument="const char *filename"> Path and filename of the checkpoint</argument>
+		///<argument="LinearLayerNetwork *net"> Network to save</argument>
+		///<argument="const TrainingState &state"> Training state</argument>
+		///<argument="dataset *data"> If given, its min/max are saved so raw data can be scaled later</argument>
+		///
+		///<return="bool"> True if the checkpoint was written</return>
+		///</summary>
+		static bool Save (const char *filename, LinearLayerNetwork *net, const TrainingState &state, dataset *data = 0);
+
+		///<summary>
+		/// Loads a checkpoint, making a new network with the saved weights and changes in weights
+		///
+		///<argument="const char *filename"> Path and filename of the checkpoint</argument>
+		///<argument="TrainingState &state"> Onto which the training state is copied</argument>
+		///<argument="DataScaling *scaling"> If given, onto which the min/max of the training data are copied (numinputs is 0 if none were saved)</argument>
+		///
+		///<return="LinearLayerNetwork*"> The network, or 0 if the file is missing or not a valid checkpoint</return>
+		///</summary>
+		static LinearLayerNetwork * Load (const char *filename, TrainingState &state, DataScaling *scaling = 0);
+};
+
+///<summary>
+/// Takes checkpoints of a network every N epochs and/or T seconds without holding up training.
+/// After each epoch the trainer calls Poll(): if a checkpoint is due and the last one has been written,
+/// the weights and changes in weights are copied into buffers made at construction, and a background
+/// thread writes and syncs them. If the last one is still being written, nothing is copied and Poll()
+/// tries again next epoch, so training never waits for the disk.
+/// Files rotate through base.0.ckpt .. base.(keep-1).ckpt, overwriting the oldest
+///</summary>
+class CheckpointScheduler {
+
+	protected:
+
+		//Start of each file name, and how many files are kept
+		string baseName;
+		int keep;
+
+		//Checkpoint due after this many epochs or seconds (0 for never)
+		int everyEpochs;
+		double everySeconds;
+
+		//Network layout and min/max of the training data, found once
+		vector<CheckpointLayer> layers;
+		DataScaling scaling;
+		bool hasScaling;
+
+		//Preallocated copies of the weights, changes in weights and training state
+		vector<double> weights;
+		vector<double> deltaWeights;
+		TrainingState state;
+
+		//Epoch and time of the last copy taken
+		long long lastEpoch;
+		chrono::steady_clock::time_point lastTime;
+
+		//Slot the next file is written to
+		int nextSlot;
+
+		//Counts of files written and of due checkpoints put off as a write was in progress
+		atomic<int> written;
+		int deferred;
+
+		//True while the background thread is writing a copy
+		bool busy;
+		bool stopping;
+		mutex lock;
+		condition_variable wake;
+		condition_variable idle;
+		thread worker;
+
+		///<summary>
+		/// Loop run by the background thread: waits for a copy, writes it, and marks itself idle
+		///</summary>
+		void WriteLoop ();
+
+	public:
+
+		///<summary>
+		/// Constructor, sizes the buffers for the network and starts the background thread
+		///
+		///<argument="const char *baseName"> Start of the name of each file</argument>
+		///<argument="LinearLayerNetwork *net"> Network to checkpoint</argument>
+		///<argument="int everyEpochs"> Epochs between checkpoints, 0 for none by epoch</argument>
+		///<argument="double everySeconds"> Seconds between checkpoints, 0 for none by time</argument>
+		///<argument="int keep"> Amount of files kept in rotation</argument>
+		///<argument="dataset *data"> If given, its min/max are saved in every file</argument>
+		///</summary>
+		CheckpointScheduler (const char *baseName, LinearLayerNetwork *net, int everyEpochs, double everySeconds = 0, int keep = 3, dataset *data = 0);
+
+		///<summary>
+		/// Destructor, waits for the last write to finish
+		///</summary>
+		~CheckpointScheduler ();
+
+		///<summary>
+		/// Called after each epoch: takes a copy for the background thread if a checkpoint is due and it is idle
+		///
+		///<argument="LinearLayerNetwork *net"> Network being trained</argument>
+		///<argument="const TrainingState &state"> Training state after the epoch</argument>
+		///
+		///<return="bool"> True if a copy was taken</return>
+		///</summary>
+		bool Poll (LinearLayerNetwork *net, const TrainingState &state);
+
+		///<summary>
+		/// Waits until the copy being written, if any, is on disk
+		///</summary>
+		void Flush ();
+
+		///<summary>
+		/// Returns the amount of files written, and of due checkpoints put off
+		///</summary>
+		int Written ();
+		int Deferred ();
+
+		///<summary>
+		/// Loads the checkpoint with the most epochs from the rotating files of baseName
+		///
+		///<argument="const char *baseName"> Start of the name of each file</argument>
+		///<argument="int keep"> Amount of files kept in rotation</argument>
+		///<argument="TrainingState &state"> Onto which the training state is copied</argument>
+		///<argument="DataScaling *scaling"> If given, onto which the min/max of the training data are copied</argument>
+		///
+		///<return="LinearLayerNetwork*"> The network, or 0 if there is no valid checkpoint</return>
+		///</summary>
+		static LinearLayerNetwork * LoadLatest (const char *baseName, int keep, TrainingState &state, DataScaling *scaling = 0);
+};
+
+#endif
@@ -0,0 +1,120 @@
+/*
+* 	Header-file for counting hardware events (cycles, instructions, cache and branch misses) with perf_event_open
+*/
+
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include "library.h"
+
+///<summary>
+/// Events counted, in the order they are printed
+///</summary>
+enum HardwareEvent {
+
+	EVENT_CYCLES,
+	EVENT_INSTRUCTIONS,
+	EVENT_L1D_MISSES,		//Level 1 data cache read misses
+	EVENT_LLC_MISSES,		//Last level cache misses
+	EVENT_BRANCH_MISSES,
+	HARDWARE_EVENTS
+};
+
+//Values summing up a count: IPC, then L1D, LLC and branch misses per row
+const int COUNTER_SUMMARY = HARDWARE_EVENTS - 1;
+
+///<summary>
+/// Counts hardware events of the calling thread, in user space, between Start() and Stop().
+/// Each event is opened on its own, so one the processor or kernel does not offer is left out and the
+/// rest still counted; if none can be opened (not Linux, no counters in a virtual machine, or
+/// perf_event_paranoid too strict) Available() is false and Start()/Stop() do nothing.
+/// When the kernel shares counters between more events than the processor has, counts are scaled up
+/// by the share of the time each was counting
+///</summary>
+class HardwareCounters {
+
+	protected:
+
+		//File of each event, or -1 if it could not be opened
+		int files[HARDWARE_EVENTS];
+
+		//Counts between the last Start() and Stop()
+		long long counts[HARDWARE_EVENTS];
+
+		//Reason the first event that could not be opened failed
+		string error;
+
+	public:
+
+		///<summary>
+		/// Constructor, opens a counter for each event, stopped
+		///</summary>
+		HardwareCounters ();
+
+		///<summary>
+		/// Destructor, closes the counters
+		///</summary>
+		~HardwareCounters ();
+
+		///<summary>
+		/// Returns true if at least one event could be opened
+		///</summary>
+		bool Available ();
+
+		///<summary>
+		/// Returns true if the given event is counted
+		///</summary>
+		bool Counted (HardwareEvent event);
+
+		///<summary>
+		/// Returns the reason an event could not be opened, or an empty string
+		///</summary>
+		const char * Error ();
+
+		///<summary>
+		/// Sets the counters to 0 and starts them
+		///</summary>
+		void Start ();
+
+		///<summary>
+		/// Stops the counters and reads them
+		///</summary>
+		void Stop ();
+
+		///<summary>
+		/// Returns the count of an event between the last Start() and Stop(), or -1 if it is not counted
+		///</summary>
+		long long Count (HardwareEvent event);
+
+		///<summary>
+		/// Returns instructions per cycle, or 0 if either is not counted
+		///</summary>
+		double InstructionsPerCycle ();
+
+		///<summary>
+		/// Returns the count of an event divided by the rows presented, or 0 if it is not counted
+		///</summary>
+		double PerSample (HardwareEvent event, long long samples);
+
+		///<summary>
+		/// Stores the IPC, then L1D, LLC and branch misses per row, each -1 if not counted
+		///
+		///<argument="long long samples"> Rows presented between Start() and Stop()</argument>
+		///<argument="double summary[]"> Array of COUNTER_SUMMARY values onto which they are stored</argument>
+		///</summary>
+		void Summarise (long long samples, double summary[]);
+
+		///<summary>
+		/// Prints the IPC and misses per row of those events counted, on the current line
+		///
+		///<argument="long long samples"> Rows presented between Start() and Stop()</argument>
+		///</summary>
+		void Print (long long samples);
+
+		///<summary>
+		/// Prints a summary as Print() does, so it can be printed on a thread other than the one counted
+		///</summary>
+		static void PrintSummary (const double summary[]);
+};
+
+#endif
@@ -0,0 +1,133 @@
+/*
+* 	Header-file for k-fold cross-validation of networks
+*/
+
+#ifndef CROSSVAL_H
+#define CROSSVAL_H
+
+#include "library.h"
+
+///<summary>
+/// Results of training and testing one fold
+///</summary>
+struct FoldResult {
+
+	//Sum of the mean sum squared errors of each output, on the held-out rows
+	double sse;
+
+	//Mean over the outputs of the % correct classifications, on the held-out rows
+	double correct;
+
+	//Wall time taken to train and test the fold, in seconds
+	double seconds;
+
+	//Amount of rows learnt from and held out
+	int trainRows;
+	int testRows;
+};
+
+///<summary>
+/// Trains k networks on one shared, read-only dataset, each with a different fold held out,
+/// running up to numThreads folds at once on separate cores
+///</summary>
+class CrossValidator {
+
+	protected:
+
+		//The shared dataset, only ever read from
+		dataset &data;
+
+		//Amount of folds
+		int numFolds;
+
+		//Maximum amount of folds trained at once
+		int numThreads;
+
+		//Network setup, as passed to MakeNet()
+		char networkOption;
+		int hiddenNodes;
+
+		//Layers of the DeepNetwork each fold is made as instead, if any
+		vector<LayerSpec> layers;
+
+		//Amount of epochs each fold is trained for
+		int maxEpoch;
+
+		//Learning parameters: {learning-rate, momentum}
+		double learningParameters[2];
+
+		//Results of each fold
+		FoldResult *results;
+
+		///<summary>
+		/// Fills rows[] with the indices of the rows learnt from (isTest = false) or held out (isTest = true) in a fold.
+		/// Rows are dealt round-robin so that sorted data (e.g. grouped by class) is spread over all folds
+		///
+		///<argument="int fold"> Index of the fold</argument>
+		///<argument="bool isTest"> Whether to select the held-out rows</argument>
+		///<argument="int rows[]"> Array onto which the indices are stored</argument>
+		///
+		///<return="int"> Amount of rows selected</return>
+		///</summary>
+		int SelectRows (int fold, bool isTest, int rows[]);
+
+		///<summary>
+		/// Trains and tests one network on one fold, storing the result
+		///
+		///<argument="int fold"> Index of the fold</argument>
+		///<argument="LinearLayerNetwork *net"> Untrained network for this fold</argument>
+		///</summary>
+		void RunFold (int fold, LinearLayerNetwork *net);
+
+	public:
+
+		///<summary>
+		/// Constructor
+		///
+		///<argument="dataset &data"> Dataset to be split into folds</argument>
+		///<argument="int numFolds"> Amount of folds</argument>
+		///<argument="int numThreads"> Maximum amount of folds trained at once</argument>
+		///<argument="char networkOption"> Network to be made, as passed to MakeNet()</argument>
+		///<argument="int hiddenNodes"> Number of hidden nodes for multi-layered networks</argument>
+		///<argument="int maxEpoch"> Amount of epochs each fold is trained for</argument>
+		///<argument="const double learningParameters[]"> Array containing the parameters: {learning-rate, momentum}</argument>
+		///</summary>
+		CrossValidator (dataset &data, int numFolds, int numThreads, char networkOption, int hiddenNodes, int maxEpoch, const double learningParameters[]);
+
+		///<summary>
+		/// Destructor
+		///</summary>
+		~CrossValidator ();
+
+		///<summary>
+		/// Makes each fold a DeepNetwork of the given layers, rather than the network of networkOption
+		///
+		///<argument="const vector<LayerSpec> &specs"> Size and type of each layer, first to last, as IsValidNetwork() checks</argument>
+		///</summary>
+		void UseLayers (const vector<LayerSpec> &specs);
+
+		///<summary>
+		/// Makes a network for each fold, then trains and tests all folds.
+		/// Each fold's random weights come from its own stream of the seed, so they only depend on the seed and the fold
+		///
+		///<argument="int weight_option"> Seed for the random-number generator</argument>
+		///</summary>
+		void Run (int weight_option);
+
+		///<summary>
+		/// Returns the result of the nth fold
+		///</summary>
+		FoldResult & GetFold (int n);
+
+		///<summary>
+		/// Returns the amount of folds, which may differ from that asked for : at least 2, and no more than the rows
+		///</summary>
+		int HowManyFolds ();
+
+		///<summary>
+		/// Prints the result of each fold, then the mean and variance of SSE and % correct classifications
+		///</summary>
+		void PrintReport ();
+};
+
+#endif
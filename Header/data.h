@@ -16,12 +16,28 @@
 
 #include "library.h"
 
+class MetricsAccumulator;
+
+struct DataScaling {
+	// the min/max used to scale a data set, kept so that raw data can later be scaled the same way
+	int numinputs;
+	int numoutputs;
+	int datatype;			// 0 for logic, 1 for numerical, 2 for classifier, 3 for one-hot classes
+	vector<double> mindata;	// min of each input then each target
+	vector<double> maxdata;	// max of each input then each target
+	void ScaleInputs(const double raw[], double scaled[]) const;
+		// scale one row of raw inputs into 0.1..0.9, as the data set scales its inputs when read
+	void RescaleOutputs(const double scaled[], double raw[]) const;
+		// rescale one row of network outputs back into the units of the targets, as dataset::RescaleValue
+		// with no min/max stored (mindata empty) both just copy, numinputs and numoutputs must still be set
+};
+
 class dataset {
 	int numdataset;
 	int numinputs;
 	int numoutputs;
 	int numinrow;		// is numinputs + 2 * numoutputs
-	int datatype;		// 0 for logic, 1 for numerical, 2 for classifier
+	int datatype;		// 0 for logic, 1 for numerical, 2 for classifier, 3 for one-hot classes
 	double *alldata;	// array for inputs, outputs and targets
 	double *mindata;	// array for minimum values of each input/target
 	double *maxdata;	// array for maxuimum values of each input/target
@@ -29,12 +45,14 @@ class dataset {
 	double *classifications;  // array for % of correct classifications
 	double *scaleddata;	// for rescaling outputs at end for display
 	char *dataname;		// name of data
-	void GetMemory(char *name);
+	Arena *memory;		// one block holding all of the arrays above
+	friend class MetricsAccumulator;	// reads sizes, datatype and min/max
+	void GetMemory(const char *name);
 	void ScaleInsTargets(void);
 public:
 	dataset();
-	dataset(char *filename, char *name);
-	dataset(int nin, int nout, int nset, double data[], char *name);
+	dataset(const char *filename, const char *name);
+	dataset(int nin, int nout, int nset, double data[], const char *name);
 	~dataset();
 	double * GetNthInputs (int n);
 		// return (address of) array of inputs of nth item in data set
@@ -54,28 +72,46 @@ public:
 		// calculate and return address of array of % of correct classifications
 	double * CalcScaledData (int n, char which);
 		// calculate and return address of scaled version for nth output set
+	void GetScaling (DataScaling &scaling);
+		// copy the sizes, datatype and min/max of inputs and targets into scaling
+	double RescaleValue (int column, double value);
+		// return value rescaled as the column-th entry of a row, without using any buffer of the set
+	bool MakeOneHot (void);
+		// replace the class of each item of a classifier set (one target, datatype 2) by one target per class,
+		// 1 for its class and 0 for the others; the set becomes datatype 3, whose items are classified by
+		// the largest output, as given by a softmax layer. Returns false, changing nothing, for any other set
 	int numIns (void);
 		// return number of inputs
 	int numOuts (void);
 		// return number of outputs
 	int numData (void);
 		// return number of data sets
-	void printarray (char *s, char which, int n, int nl = 0);
+	int numInRow (void);
+		// return number of values in each row : inputs, targets and outputs
+	int dataType (void);
+		// return datatype : 0 for logic, 1 for numerical, 2 for classifier, 3 for one-hot classes
+	void printarray (const char *s, char which, int n, int nl = 0);
 		// print s then specifc array and \n if nl
 		// if which is 'I' print inputs; if 'O' print outputs; if 'T print targets,
 		//           if 'S' print SSEs, if C print % corerect classifications
 		// n specifies nth set of inputs,outputs,targets
-	void printdata (int showopt);
+	void printdata (int showopt, MetricsAccumulator *metrics = 0);
 		// print aspects of data set.
 		//   if showopt = 1, print ins, targets, outs, then SSE / % classification )
 	    //   if showopt = 0, just print SSE and (if logic/classifier) % classifications
-	void savedata (int goplot = 0);
+		//   if metrics given, SSE and % classifications are taken from it rather than rescanning the set
+	void savedata (int goplot = 0, WriterFormat format = WRITER_TEXT);
 		// save data set (ins, targets and outs) into file
 	    // if goplot, then call tadpole program to plot
+		// rows are rescaled here and written by a ResultWriter on a background thread
+		// format WRITER_BINARY or WRITER_COLUMNAR writes raw doubles to namefull.bin instead of text
 };
 
 void dcopy (int num, const double fromarray[], double toarray[]); 
 	/// copy num doubles from the fromarray to the toarray
 
+void arrout (const char *s, int num, double data[], int nl);
+	/// output s then the num values in array data, then \n if nl
+
 
 #endif
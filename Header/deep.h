@@ -0,0 +1,256 @@
+/*
+* 	Header-file for networks of any number of layers, each with its own activation
+*/
+
+#ifndef DEEP_H
+#define DEEP_H
+
+#include "library.h"
+
+//Most layers a DeepNetwork, or a checkpoint of one, may have
+const int DEEP_MAX_LAYERS = 64;
+
+///<summary>
+/// Size and activation of one layer of a DeepNetwork
+///</summary>
+struct LayerSpec {
+
+	int numNeurons;
+
+	//LayerType() of the layer: for hidden layers 'M' sigmoid, or 'T', 'R', 'E' or 'H' (see activation.h);
+	//for the output layer 'S' sigmoid, 'L' linear or 'C' softmax
+	char layerType;
+};
+
+///<summary>
+/// Size, type and place in the network's buffers of one layer of a DeepNetwork
+///</summary>
+struct DeepLayer {
+
+	int numInputs;
+	int numNeurons;
+	char layerType;
+
+	//Index of the layer's first weight in the weights and changes in weights, and of its first output in the outputs and deltas
+	int weightStart;
+	int neuronStart;
+
+	//Kernels of the layer's size (see kernels.h), or 0 for the loops of any size
+	const LayerKernels *kernels;
+};
+
+///<summary>
+/// Network of any number of layers, built from a list of LayerSpec. The weights of every layer are held in one
+/// buffer, in SetTheWeights order, as are the changes in weights; the outputs of every layer are held in another,
+/// as are the deltas. Passes forward and back are loops over the layers, with no next layer to call through.
+/// The first layer is this object's own, so the per-layer functions of LinearLayerNetwork work on it, as
+/// AdaptSparse and ComputeSparse need. Gives the same outputs and weights as MultiLayerNetwork for two layers
+///</summary>
+class DeepNetwork : public LinearLayerNetwork {
+
+	protected:
+
+		//Layers, first to last
+		vector<DeepLayer> layers;
+
+		//Every layer's weights and changes in weights, and every layer's outputs and deltas
+		double *allWeights;
+		double *allDeltaWeights;
+		double *allOutputs;
+		double *allDeltas;
+
+		//Total amount of weights, and of neurons
+		int totalWeights;
+		int totalNeurons;
+
+		//Most neurons of any hidden layer, by which ForwardBatch's workspace is sized
+		int widestHidden;
+
+		///<summary>
+		/// Returns the bytes of the arena holding the weights, changes in weights, outputs and deltas of the given layers
+		///</summary>
+		static size_t BufferBytes (int numInputs, const vector<LayerSpec> &specs);
+
+		///<summary>
+		/// Stores the weighted sum of each neuron of a layer in sums[], before any activation
+		///</summary>
+		void LayerSums (int layer, const double inputs[], double sums[]);
+
+		///<summary>
+		/// Applies the activation of a layer, in place, to count values, a whole number of rows of it
+		///</summary>
+		void ActivateLayer (int layer, double values[], int count);
+
+		///<summary>
+		/// Calculates the deltas of a layer from its errors and its outputs; errors[] may be the deltas themselves
+		///</summary>
+		void LayerDeltas (int layer, const double errors[], double layerDeltas[]);
+
+		///<summary>
+		/// Calculates the outputs of the layers from first onwards, each from the outputs of the one before
+		///</summary>
+		void ForwardLayers (int first);
+
+		///<summary>
+		/// Changes the weights of the layers from first onwards, each from the outputs of the one before
+		///</summary>
+		void ChangeLayers (int first, const double learningParameters[]);
+
+		///<summary>
+		/// Calculates the outputs of every layer
+		///
+		///<argument="const double Inputs[]"> An array containing inputs to the network</argument>
+		///</summary>
+		virtual void CalcOutputs (const double Inputs[]);
+
+		///<summary>
+		/// Applies the activation of the first layer, as used by the per-layer functions
+		///</summary>
+		virtual void Activate (double values[], int count);
+
+		///<summary>
+		/// Copies the outputs of the last layer into the nth output in data
+		///</summary>
+		virtual void StoreOutputs (int n, dataset &data);
+
+		///<summary>
+		/// Calculates the deltas of the last layer from the errors, then of each layer before from the deltas after it,
+		/// as MultiLayerNetwork does through PrevLayersErrors
+		///
+		///<argument="const double Errors[]"> Array containing the errors of the network (target - output)</argument>
+		///</summary>
+		virtual void FindDeltas (const double Errors[]);
+
+		///<summary>
+		/// Changes the weights of every layer, as ChangeAllWeights of each layer would
+		///
+		///<argument="const double Inputs[]"> Array containing the inputs to the network</argument>
+		///<argument="const double learningParameters[]"> Array containing the parameters: {learning-rate, momentum}</argument>
+		///</summary>
+		virtual void ChangeAllWeights (const double Inputs[], const double learningParameters[]);
+
+		///<summary>
+		/// Calculates the first layer from the non-zero inputs, then the layers after it
+		///</summary>
+		virtual void SparseCalcOutputs (const int columns[], const double values[], int count);
+
+		///<summary>
+		/// Changes the first layer's weights of the bias and non-zero inputs, then every weight of the layers after it
+		///</summary>
+		virtual void SparseChangeWeights (const int columns[], const double values[], int count, const double learningParameters[]);
+
+		///<summary>
+		/// Returns the address of the outputs of the last layer
+		///</summary>
+		virtual double * NetworkOutputs ();
+
+		///<summary>
+		/// Finds a layer's weights and changes in weights in the network's buffers
+		///</summary>
+		virtual void LayerArrays (int layer, double *&layerWeights, double *&layerDeltaWeights);
+
+	public:
+
+		///<summary>
+		/// Constructor, with random weights drawn from the first layer's to the last's.
+		/// The layers must be valid, as IsValidNetwork() checks
+		///
+		///<argument="int numInputs"> Amount of inputs to the network</argument>
+		///<argument="const vector<LayerSpec> &specs"> Size and type of each layer, first to last</argument>
+		///</summary>
+		DeepNetwork (int numInputs, const vector<LayerSpec> &specs);
+
+		///<summary>
+		/// Destructor
+		///</summary>
+		virtual ~DeepNetwork ();
+
+		///<summary>
+		/// Calculates the outputs of many rows one layer at a time, the rows of hidden layers in two halves of the workspace in turn
+		///
+		///<argument="const double inputs[]"> Array containing numRows rows of inputs, one after another</argument>
+		///<argument="int numRows"> Amount of rows</argument>
+		///<argument="double outputs[]"> Array onto which numRows rows of network outputs are stored</argument>
+		///<argument="double workspace[]"> Array of at least BatchWorkspace(numRows) doubles</argument>
+		///</summary>
+		virtual void ForwardBatch (const double inputs[], int numRows, double outputs[], double workspace[]);
+
+		///<summary>
+		/// Returns two rows of the widest hidden layer for each of numRows rows
+		///</summary>
+		virtual int BatchWorkspace (int numRows);
+
+		///<summary>
+		/// Calculates the outputs of one layer for many rows, from the network's buffer of weights
+		///</summary>
+		virtual void ForwardLayerBatch (int layer, const double inputs[], int numRows, double layerOutputs[]);
+
+		///<summary>
+		/// Initialises the weights, or the changes in weights, of every layer, in the order ReturnTheWeights gives them
+		///</summary>
+		virtual void SetTheWeights (const double initialWeights[]);
+		virtual void SetTheDeltaWeights (const double initialDeltaWeights[]);
+
+		///<summary>
+		/// Copies the weights, or the changes in weights, of every layer, first to last
+		///</summary>
+		virtual void ReturnTheWeights (double theWeights[]);
+		virtual void ReturnTheDeltaWeights (double theDeltaWeights[]);
+
+		///<summary>
+		/// Returns the amount of weights of every layer
+		///</summary>
+		virtual int HowManyWeights ();
+
+		///<summary>
+		/// Returns the amount of outputs of the last layer
+		///</summary>
+		virtual int HowManyOutputs ();
+
+		///<summary>
+		/// Returns the type of the first layer
+		///</summary>
+		virtual char LayerType ();
+
+		///<summary>
+		/// Returns the amount of layers, and the size and type of each
+		///</summary>
+		virtual int HowManyLayers ();
+		virtual void DescribeLayer (int layer, int &layerInputs, int &layerNeurons, char &layerType);
+
+		///<summary>
+		/// Returns the size of the kernels a layer runs, as KernelName does for the first
+		///</summary>
+		const char * LayerKernelName (int layer);
+};
+
+///<summary>
+/// Returns true if the layers can make a DeepNetwork: 1 to DEEP_MAX_LAYERS layers of at least one neuron,
+/// hidden layers of type 'M', 'T', 'R', 'E' or 'H', and an output layer of type 'S', 'L' or 'C'
+///
+///<argument="const vector<LayerSpec> &specs"> Size and type of each layer, first to last</argument>
+///</summary>
+bool IsValidNetwork (const vector<LayerSpec> &specs);
+
+///<summary>
+/// Reads layers written as "size type" for each, separated by commas or dashes, such as "20T,10R,3S".
+/// A type of 'S' on a hidden layer is taken as 'M', the type of a sigmoidal layer with a next layer
+///
+///<argument="const string &text"> Layers, first to last</argument>
+///<argument="vector<LayerSpec> &specs"> Onto which the layers are stored</argument>
+///
+///<return="bool"> True if every layer was read and they are valid, as IsValidNetwork() checks</return>
+///</summary>
+bool ParseLayers (const string &text, vector<LayerSpec> &specs);
+
+///<summary>
+/// Creates and returns a network of the given layers, or 0 if they are not valid
+///
+///<argument="int numInputs"> Amount of inputs to the network</argument>
+///<argument="const vector<LayerSpec> &specs"> Size and type of each layer, first to last</argument>
+///
+///<return="LinearLayerNetwork*"> Network, a DeepNetwork</return>
+///</summary>
+LinearLayerNetwork * MakeDeepNet (int numInputs, const vector<LayerSpec> &specs);
+
+#endif
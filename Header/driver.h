@@ -0,0 +1,210 @@
+/*
+* 	Header-file for running batches of experiments without the menu, reporting results as JSON
+*/
+
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include "library.h"
+
+///<summary>
+/// Setup of one experiment run
+///</summary>
+struct RunConfig {
+
+	//Network, as passed to MakeNet(), or 'D' for a DeepNetwork of the driver's layers, and its hidden nodes
+	char networkOption;
+	int hiddenNodes;
+
+	//Seed of the random weights
+	int seed;
+
+	//Learning parameters: {learning-rate, momentum}
+	double learningParameters[2];
+};
+
+///<summary>
+/// A trained run pruned to one ratio and fine-tuned (see WeightPruner), as measured on the test set, or the training set if none
+///</summary>
+struct PruneResult {
+
+	double ratio;
+
+	//Weights kept, other than biases, and bytes of the weights as a SparseWeightNetwork
+	int kept;
+	long long bytes;
+
+	//Sum of the SSE of each output, and mean % correct over the outputs
+	double sse;
+	double correct;
+};
+
+///<summary>
+/// Runs every combination of the given networks, hidden sizes, seeds and learning parameters, either training
+/// on one data set and testing on another, dense or sparse, or by k-fold cross-validation, with many runs at once on separate cores.
+/// Options are given as "--name value" arguments or as "name = value" lines of a config file; lists are
+/// separated by commas, and integer lists may hold ranges such as 0..9.
+/// Each run is written as one line of JSON, followed by a summary line
+///</summary>
+class ExperimentDriver {
+
+	protected:
+
+		//"train", "sparse" or "crossval"
+		string mode;
+
+		//Values swept over
+		string networks;
+		vector<int> hiddens;
+
+		//Layers of a DeepNetwork, as read by ParseLayers(), run instead of the networks and hidden sizes if given
+		string layerText;
+		vector<LayerSpec> layers;
+		vector<int> seeds;
+		vector<double> learningRates;
+		vector<double> momenta;
+
+		//Epochs of each run, and folds for cross-validation
+		int maxEpoch;
+		int numFolds;
+
+		//Rows of each mini-batch of training (see AdaptBatch), 1 to change the weights after every row
+		int batchSize;
+
+		//Runs (or folds) trained at once
+		int numThreads;
+
+		//Whether the arenas of the data sets and networks ask for huge pages (see Arena::SetHugePages)
+		bool hugePages;
+
+		//Ratios each trained run is pruned to in turn, smallest first, and epochs of fine-tuning after each
+		vector<double> pruneRatios;
+		int fineTuneEpochs;
+
+		//Data sets : the training (or cross-validated) set, and an optional test set
+		string trainFile;
+		string testFile;
+
+		//File the JSON is written to, "-" for the console, and the folder checkpoints of trained runs are saved in, if any
+		string outputFile;
+		string checkpointFolder;
+
+		//Every combination to run
+		vector<RunConfig> runs;
+
+		//Reason the options could not be used
+		string error;
+
+		///<summary>
+		/// Sets one option from its name and value, returning false and setting error if either is not valid
+		///</summary>
+		bool SetOption (const string &name, const string &value);
+
+		///<summary>
+		/// Fills runs[] with every combination of the values swept over
+		///</summary>
+		void MakeRuns ();
+
+		///<summary>
+		/// Makes the untrained network of a run for the given data
+		///</summary>
+		LinearLayerNetwork * MakeRunNet (const RunConfig &config, dataset &data);
+
+		///<summary>
+		/// Returns true if a run's network is a softmax classifier, so learns from the one-hot copies of the sets
+		///</summary>
+		bool IsOneHot (const RunConfig &config);
+
+		///<summary>
+		/// Trains the runs on the training set, up to numThreads at once, writing each as it finishes.
+		/// Softmax classifiers ('C') are trained and tested on the one-hot copies of the sets
+		///</summary>
+		void RunTraining (FILE *out, dataset &train, dataset *test, dataset *oneHotTrain, dataset *oneHotTest);
+
+		///<summary>
+		/// Trains the runs on a sparse training set with AdaptSparse, up to numThreads at once, each worker on copies
+		/// of the sets of its own, as the sparse passes store their outputs in the set
+		///</summary>
+		void RunSparse (FILE *out, SparseDataset &train, SparseDataset *test);
+
+		///<summary>
+		/// Cross-validates each run in turn, its folds trained numThreads at once; softmax classifiers on the one-hot copy
+		///</summary>
+		void RunCrossValidation (FILE *out, dataset &data, dataset *oneHotData);
+
+		///<summary>
+		/// Writes the setup of a run as the start of a JSON object, with no closing brace
+		///</summary>
+		void WriteConfig (FILE *out, int run);
+
+		///<summary>
+		/// Writes the summary line of every run, which took the given seconds, and closes the output
+		///</summary>
+		void WriteSummary (FILE *out, double seconds);
+
+		///<summary>
+		/// Opens the output file, or the console, setting error if it cannot be created
+		///</summary>
+		FILE * OpenOutput ();
+
+		///<summary>
+		/// Reads the sparse sets (see SparseDataset), then trains and writes the runs as Run does for dense sets
+		///</summary>
+		int RunSparseSets ();
+
+	public:
+
+		///<summary>
+		/// Constructor, sets the options to the defaults of the menu
+		///</summary>
+		ExperimentDriver ();
+
+		///<summary>
+		/// Reads options from arguments: "--name value", "--name=value", or "--config file" to read a config file
+		///
+		///<argument="int argc"> Amount of arguments</argument>
+		///<argument="char *argv[]"> Arguments</argument>
+		///<argument="int first"> Index of the first option</argument>
+		///
+		///<return="bool"> True if every option was valid</return>
+		///</summary>
+		bool ParseArguments (int argc, char *argv[], int first);
+
+		///<summary>
+		/// Reads options from a file of "name = value" lines; # starts a comment
+		///
+		///<argument="const char *filename"> Path and filename of the config file</argument>
+		///
+		///<return="bool"> True if the file was read and every option was valid</return>
+		///</summary>
+		bool ReadConfig (const char *filename);
+
+		///<summary>
+		/// Runs every combination and writes the results
+		///
+		///<return="int"> 0 if all was run, else 1 (see Error())</return>
+		///</summary>
+		int Run ();
+
+		///<summary>
+		/// Returns the reason the options could not be used, or the run failed
+		///</summary>
+		const char * Error ();
+
+		///<summary>
+		/// Prints the options and their defaults
+		///</summary>
+		static void PrintUsage (const char *program);
+};
+
+///<summary>
+/// Writes a string to a file as a quoted JSON string
+///</summary>
+void WriteJsonString (FILE *out, const string &text);
+
+///<summary>
+/// Writes a number to a file as JSON, or null if it is not finite
+///</summary>
+void WriteJsonNumber (FILE *out, double value);
+
+#endif
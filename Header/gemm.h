@@ -0,0 +1,90 @@
+/*
+* 	Header-file for the dense matrix multiply used by the batched passes of large layers
+*
+* 	C += op(A) * op(B) in blocks that fit the caches: a panel of B is packed to stay in L3, a block of A to stay in L2,
+* 	and a micro-kernel holds a GEMM_MR x GEMM_NR tile of C in registers while a sliver of B streams from L1.
+* 	Each element of C is added to one product at a time, in order of depth, so the sums are the same as a plain loop's
+*/
+
+#ifndef GEMM_H
+#define GEMM_H
+
+#include "library.h"
+
+//Rows and columns of the tile of C the micro-kernel holds in registers: 6 x 4 doubles are 12 SSE registers,
+//leaving 3 of the 16 for a sliver of B and a broadcast value of A
+const int GEMM_MR = 6;
+const int GEMM_NR = 4;
+
+//Depth of the blocks of A and B, so a GEMM_KC x GEMM_NR sliver of packed B fits in L1
+const int GEMM_KC = 256;
+
+//Rows of A packed at once, a multiple of GEMM_MR, so the GEMM_MC x GEMM_KC block fits in L2
+const int GEMM_MC = 96;
+
+//Columns of B packed at once, so the GEMM_KC x GEMM_NC panel fits in L3
+const int GEMM_NC = 2048;
+
+//Layers of fewer weights than this are left to the plain loops, as packing costs more than it saves on them
+const int GEMM_MIN_WEIGHTS = 4096;
+
+///<summary>
+/// Packing buffers and blocking of the multiply. Each thread has its own (see ThreadGemm), as they are written by every call
+///</summary>
+class GemmEngine {
+
+	protected:
+
+		//Block holding the packed A and B
+		Arena buffers;
+
+		//Block of A, GEMM_MR rows at a time, and panel of B, GEMM_NR columns at a time, each one depth after another
+		double *packedA;
+		double *packedB;
+
+		///<summary>
+		/// Packs rows x depth of op(A) into slivers of GEMM_MR rows, padding the last with zeros
+		///</summary>
+		void PackA (bool transA, const double A[], int lda, int rows, int depth);
+
+		///<summary>
+		/// Packs depth x columns of op(B) into slivers of GEMM_NR columns, padding the last with zeros
+		///</summary>
+		void PackB (bool transB, const double B[], int ldb, int depth, int columns);
+
+		///<summary>
+		/// Adds a sliver of packed A times a sliver of packed B to a tile of C, of which only rows x columns are kept
+		///</summary>
+		static void Kernel (int depth, const double a[], const double b[], double C[], int ldc, int rows, int columns);
+
+	public:
+
+		///<summary>
+		/// Constructor, allocates the packing buffers
+		///</summary>
+		GemmEngine ();
+
+		///<summary>
+		/// C += op(A) * op(B), all row-major: op(A) is m x k, op(B) is k x n and C is m x n
+		///
+		///<argument="bool transA"> If true A is stored k x m, and op(A) is its transpose</argument>
+		///<argument="bool transB"> If true B is stored n x k, and op(B) is its transpose</argument>
+		///<argument="int m, int n, int k"> Rows of C, columns of C, and depth of the products</argument>
+		///<argument="const double A[], int lda"> A, and the distance between its rows</argument>
+		///<argument="const double B[], int ldb"> B, and the distance between its rows</argument>
+		///<argument="double C[], int ldc"> C, added to, and the distance between its rows</argument>
+		///</summary>
+		void Multiply (bool transA, bool transB, int m, int n, int k, const double A[], int lda, const double B[], int ldb, double C[], int ldc);
+};
+
+///<summary>
+/// Returns the engine of the calling thread
+///</summary>
+GemmEngine & ThreadGemm ();
+
+///<summary>
+/// C += op(A) * op(B) on the engine of the calling thread, as GemmEngine::Multiply
+///</summary>
+void Gemm (bool transA, bool transB, int m, int n, int k, const double A[], int lda, const double B[], int ldb, double C[], int ldc);
+
+#endif
@@ -0,0 +1,49 @@
+/*
+* 	Header-file for the kernels of tiny layers, compiled for one size each
+*
+* 	A layer of a few inputs and neurons spends more time on its loops than on its sums. Each size registered in
+* 	kernels.cpp has its loops unrolled in full, with the weights of a neuron at constant offsets, and a layer of
+* 	that size takes them when it is made. Every kernel adds up in the same order as the loops it replaces
+*/
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include "library.h"
+
+///<summary>
+/// Kernels of one size of layer, each doing what the loops of a LinearLayerNetwork function do
+///</summary>
+struct LayerKernels {
+
+	int numInputs;
+	int numNeurons;
+
+	//Size as printed, such as "4x10"
+	const char *name;
+
+	//WeightedSums: the sum of each neuron, the bias weight first
+	void (*sums) (const double weights[], const double inputs[], double sums[]);
+
+	//PrevLayersErrors: the error of each input, its weight times the delta of each neuron added up
+	void (*errors) (const double weights[], const double deltas[], double errors[]);
+
+	//ChangeAllWeights: each change in weight and weight, from the inputs, deltas and {learning-rate, momentum}
+	void (*change) (const double inputs[], const double deltas[], double weights[], double deltaWeights[], const double learningParameters[]);
+};
+
+///<summary>
+/// Returns the kernels of a layer of the given size, or 0 if none are registered, leaving the layer to its loops
+///
+///<argument="int numInputs"> Amount of inputs of the layer</argument>
+///<argument="int numNeurons"> Amount of neurons of the layer</argument>
+///</summary>
+const LayerKernels * FindLayerKernels (int numInputs, int numNeurons);
+
+///<summary>
+/// Returns the amount of sizes registered, and the nth of them
+///</summary>
+int HowManyLayerKernels ();
+const LayerKernels & NthLayerKernels (int n);
+
+#endif
@@ -20,8 +20,12 @@ class LinearLayerNetwork {
 	
 	protected:
 		
-		//Grants "MultiLayerNetwork" access to the protected functions
+		//Grants "MultiLayerNetwork" and its variants of other activations access to the protected functions
 		friend class MultiLayerNetwork;
+		template <class Act> friend class ActivationMultiLayerNetwork;
+		
+		//Grants the benchmark (benchmark.cpp) access to the per-layer functions it times
+		friend class LayerBenchmark;
 		
 		//Stores amount of inputs
 		int numInputs;
@@ -32,6 +36,9 @@ class LinearLayerNetwork {
 		//Stores amount of weights
 		int numWeights;	
 		
+		//Place of the layer in its network, 0 for the first, by which its phases are timed (see profile.h)
+		int depth;
+		
 		//Stores neuron-outputs
 		double * outputs;
 		
@@ -43,6 +50,21 @@ class LinearLayerNetwork {
 		
 		//Stores changes in weights
 		double * deltaWeights;
+		
+		//Block holding the arrays above, if this layer owns it
+		//(layers sharing a network's arena leave this 0, and the owner frees the block)
+		Arena * memory;
+		
+		//Rows learnt so far in a pass of AdaptSparse, and for each input the rows its weights have been brought up to:
+		//weights of inputs that were zero are only changed, by momentum alone, when the input is next non-zero
+		long long sparseSteps;
+		vector<long long> columnSteps;
+		
+		//Kernels unrolled for the size of this layer (see kernels.h), or 0 for the loops of any size
+		const LayerKernels * kernels;
+		
+		//Pool the neurons of wide layers are split across (see pool.h), or 0 to run on the calling thread
+		SpinPool * pool;
   
 		
 		///<summary>
@@ -52,6 +74,56 @@ class LinearLayerNetwork {
 		///</summary>
 		virtual void CalcOutputs (const double Inputs[]);
 		
+		///<summary>
+		/// Stores the weighted sum of the inputs of each neuron in outputs[], before any activation
+		///
+		///<argument="const double Inputs[]"> An array containing inputs to the layer</argument>
+		///</summary>
+		void WeightedSums (const double Inputs[]);
+		
+		///<summary>
+		/// Stores the weighted sum of each neuron from the non-zero inputs only, giving the same sums as WeightedSums
+		///
+		///<argument="const int columns[]"> Array containing the columns of the non-zero inputs, in order</argument>
+		///<argument="const double values[]"> Array containing their values</argument>
+		///<argument="int count"> Amount of non-zero inputs</argument>
+		///</summary>
+		void SparseWeightedSums (const int columns[], const double values[], int count);
+		
+		///<summary>
+		/// Calculates the outputs of this layer from its non-zero inputs, then of any next layers as CalcOutputs does
+		///</summary>
+		virtual void SparseCalcOutputs (const int columns[], const double values[], int count);
+		
+		///<summary>
+		/// Changes the weights of this layer as ChangeAllWeights does, but only those of the bias and of non-zero inputs,
+		/// then all the weights of any next layers. The weights of the non-zero inputs must be up to date (CatchUpColumn)
+		///</summary>
+		virtual void SparseChangeWeights (const int columns[], const double values[], int count, const double learningParameters[]);
+		
+		///<summary>
+		/// Applies to the weights of one input the changes of every row learnt since they were last brought up to date,
+		/// in which that input was zero: the change in weight only decays by the momentum, so k rows at once are
+		/// weight += change * (m + m^2 + ... + m^k) and change *= m^k
+		///
+		///<argument="int column"> Input whose weights are brought up to date</argument>
+		///<argument="double momentum"> Momentum of the pass</argument>
+		///</summary>
+		void CatchUpColumn (int column, double momentum);
+		
+		///<summary>
+		/// Returns the depth of the last layer of the network
+		///</summary>
+		int OutputDepth ();
+		
+		///<summary>
+		/// Applies the activation of the layer, in place, to weighted sums: linear layers leave them as they are
+		///
+		///<argument="double values[]"> Array containing the weighted sums</argument>
+		///<argument="int count"> Amount of values</argument>
+		///</summary>
+		virtual void Activate (double values[], int count);
+		
 		///<summary>
 		/// Copies the calculated network outputs into the nth output in data.
 		///
@@ -82,6 +154,82 @@ class LinearLayerNetwork {
 		///<argument="double previousErrors[]"> Array storing the previous layer's errors</argument>
 		///</summary>
 		void PrevLayersErrors (double previousErrors[]);
+		
+		///<summary>
+		/// Returns the address of the outputs of the final layer of the network
+		///</summary>
+		virtual double * NetworkOutputs ();
+		
+		///<summary>
+		/// Finds the weights and changes in weights of a layer of the network, 0 being this one, as used by AdaptBatch
+		///
+		///<argument="int layer"> Layer, counted from this one</argument>
+		///<argument="double *&layerWeights"> Onto which the address of the layer's weights is stored</argument>
+		///<argument="double *&layerDeltaWeights"> Onto which the address of the layer's changes in weights is stored</argument>
+		///</summary>
+		virtual void LayerArrays (int layer, double *&layerWeights, double *&layerDeltaWeights);
+		
+		///<summary>
+		/// Calculates the weighted sums of many rows through a layer's weights, giving the same sums as WeightedSums.
+		/// Layers of at least GEMM_MIN_WEIGHTS weights are multiplied by Gemm, the rest a row at a time
+		///
+		///<argument="const double layerWeights[]"> Weights of the layer, a bias then numInputs weights for each neuron</argument>
+		///<argument="int layerInputs"> Amount of inputs of the layer</argument>
+		///<argument="int layerNeurons"> Amount of neurons of the layer</argument>
+		///<argument="const double inputs[]"> Array containing numRows rows of inputs</argument>
+		///<argument="int numRows"> Amount of rows</argument>
+		///<argument="double sums[]"> Array onto which numRows rows of weighted sums are stored</argument>
+		///</summary>
+		static void BatchSums (const double layerWeights[], int layerInputs, int layerNeurons, const double inputs[], int numRows, double sums[]);
+		
+		///<summary>
+		/// Calculates the errors of the layer before, for many rows, from the deltas of a layer through its weights,
+		/// giving the same errors as PrevLayersErrors. Large layers are multiplied by Gemm, as in BatchSums
+		///
+		///<argument="const double batchDeltas[]"> Array containing numRows rows of the layer's deltas</argument>
+		///<argument="double errors[]"> Array onto which numRows rows of layerInputs errors are stored</argument>
+		///</summary>
+		static void BatchErrors (const double layerWeights[], int layerInputs, int layerNeurons, const double batchDeltas[], int numRows, double errors[]);
+		
+		///<summary>
+		/// Calculates the sum over many rows of each delta times its input, the bias's input being 1: the gradient of
+		/// every weight, in the order of the weights. Large layers are multiplied by Gemm, as in BatchSums
+		///
+		///<argument="const double batchDeltas[]"> Array containing numRows rows of the layer's deltas</argument>
+		///<argument="const double inputs[]"> Array containing numRows rows of the layer's inputs</argument>
+		///<argument="double gradient[]"> Array onto which (layerInputs + 1) * layerNeurons sums are stored</argument>
+		///</summary>
+		static void BatchGradient (const double batchDeltas[], const double inputs[], int layerInputs, int layerNeurons, int numRows, double gradient[]);
+		
+		///<summary>
+		/// Returns true if a layer of the given size is split across the pool: the pool has more than one thread
+		/// and the layer at least POOL_MIN_WEIGHTS weights
+		///</summary>
+		bool Pooled (int layerInputs, int layerNeurons);
+		
+		///<summary>
+		/// As WeightedSums, PrevLayersErrors and ChangeAllWeights, for the arrays of a layer, with its neurons (or, for the
+		/// errors, its inputs) split across the pool. Each part adds up as the loops do, so the results are the same
+		///</summary>
+		void PoolSums (const double layerWeights[], int layerInputs, int layerNeurons, const double inputs[], double sums[]);
+		void PoolErrors (const double layerWeights[], int layerInputs, int layerNeurons, const double layerDeltas[], double errors[]);
+		void PoolChange (double layerWeights[], double layerDeltaWeights[], int layerInputs, int layerNeurons,
+						 const double inputs[], const double layerDeltas[], const double learningParameters[]);
+		
+		///<summary>
+		/// As BatchSums, with the neurons split across the pool; each part multiplies all the rows by its neurons' weights
+		///</summary>
+		void PoolBatchSums (const double layerWeights[], int layerInputs, int layerNeurons, const double inputs[], int numRows, double sums[]);
+		
+		///<summary>
+		/// Constructor for networks that lay out the arrays of all their layers in buffers of their own (see DeepNetwork):
+		/// the sizes of this, the first, layer are set, but no arrays are carved; the network points them into its buffers
+		///
+		///<argument="int numInputs"> Amount of inputs of the first layer</argument>
+		///<argument="int numOutputs"> Amount of neurons of the first layer</argument>
+		///<argument="Arena &buffers"> Arena, made with new, holding the network's buffers; it is freed with the layer</argument>
+		///</summary>
+		LinearLayerNetwork (int numInputs, int numOutputs, Arena &buffers);
 	
 	public:
 		
@@ -90,8 +238,18 @@ class LinearLayerNetwork {
 		///
 		///<argument="int numInputs"> Amount of inputs for the new layer</argument>
 		///<argument="int numOutputs"> Amount of outputs for the new layer</argument>
+		///<argument="Arena *arena"> If given, the layer's arrays are carved from it and it is not freed by the layer,
+		/// else the layer makes and owns an arena of its own</argument>
 		///</summary>
-		LinearLayerNetwork (int numInputs, int numOutputs);
+		LinearLayerNetwork (int numInputs, int numOutputs, Arena *arena = 0);
+		
+		///<summary>
+		/// Returns the space in an arena taken by the arrays of a layer of the given size
+		///
+		///<argument="int numInputs"> Amount of inputs of the layer</argument>
+		///<argument="int numOutputs"> Amount of outputs of the layer</argument>
+		///</summary>
+		static size_t LayerBytes (int numInputs, int numOutputs);
 		
 		///<summary>
 		///Destructor
@@ -102,8 +260,9 @@ class LinearLayerNetwork {
 		/// Passes the whole dataset to the network, calculates outputs and stores them in the dataset
 		///
 		///<argument="dataset &data"> Pointer to the dataset</argument>
+		///<argument="MetricsAccumulator *metrics"> If given, is reset then accumulates the SSE and % correct classifications of the pass</argument>
 		///</summary>
-		virtual void ComputeNetwork (dataset &data);
+		virtual void ComputeNetwork (dataset &data, MetricsAccumulator *metrics = 0);
 		
 		///<summary>
 		/// Passes the whole dataset to the network, calculates outputs, stores them in data 
@@ -111,8 +270,99 @@ class LinearLayerNetwork {
 		/// 
 		///<argument="dataset &data"> Pointer to the dataset</argument>
 		///<argument="const double learningParameters[]"> Array containing the parameters: {learning-rate, momentum}</argument>
+		///<argument="MetricsAccumulator *metrics"> If given, is reset then accumulates the SSE and % correct classifications of the pass</argument>
+		///</summary>
+		virtual void AdaptNetwork (dataset &data, const double learningParameters[], MetricsAccumulator *metrics = 0);
+		
+		///<summary>
+		/// As AdaptNetwork, but presents the rows of the dataset in the given order
+		/// 
+		///<argument="dataset &data"> Pointer to the dataset</argument>
+		///<argument="const double learningParameters[]"> Array containing the parameters: {learning-rate, momentum}</argument>
+		///<argument="const int order[]"> Array containing the index of every row, in the order they are presented (see SampleOrder)</argument>
+		///<argument="MetricsAccumulator *metrics"> If given, is reset then accumulates the SSE and % correct classifications of the pass</argument>
+		///</summary>
+		void AdaptNetwork (dataset &data, const double learningParameters[], const int order[], MetricsAccumulator *metrics = 0);
+		
+		///<summary>
+		/// Passes the selected rows of the dataset to the network and adjusts the weights using the delta rule.
+		/// Nothing is written back into the dataset, so many networks can train on one shared dataset at once
+		///
+		///<argument="dataset &data"> Pointer to the dataset</argument>
+		///<argument="const int rows[]"> Array containing the indices of the rows to learn from, in order</argument>
+		///<argument="int numRows"> Amount of rows in rows[]</argument>
+		///<argument="const double learningParameters[]"> Array containing the parameters: {learning-rate, momentum}</argument>
+		///</summary>
+		void AdaptRows (dataset &data, const int rows[], int numRows, const double learningParameters[]);
+		
+		///<summary>
+		/// Passes the selected rows of the dataset to the network and accumulates the errors without writing to the dataset
+		///
+		///<argument="dataset &data"> Pointer to the dataset</argument>
+		///<argument="const int rows[]"> Array containing the indices of the rows to test</argument>
+		///<argument="int numRows"> Amount of rows in rows[]</argument>
+		///<argument="double sse[]"> Array onto which the mean sum squared error of each output is stored</argument>
+		///<argument="double correct[]"> Array onto which the % correct classifications of each output is stored</argument>
+		///</summary>
+		void EvaluateRows (dataset &data, const int rows[], int numRows, double sse[], double correct[]);
+		
+		///<summary>
+		/// As AdaptRows, but changes the weights once for each batch of rows, by the mean of their gradients. Each layer
+		/// calculates its outputs, deltas and gradients of the whole batch at once, which large layers do as matrix
+		/// multiplies (see gemm.h). A batch of one row changes the weights exactly as AdaptRows does
+		///
+		///<argument="dataset &data"> Pointer to the dataset</argument>
+		///<argument="const int rows[]"> Array containing the indices of the rows to learn from, in order</argument>
+		///<argument="int numRows"> Amount of rows in rows[]</argument>
+		///<argument="int batchSize"> Rows of each batch; the last may have fewer</argument>
+		///<argument="const double learningParameters[]"> Array containing the parameters: {learning-rate, momentum}</argument>
+		///</summary>
+		void AdaptBatch (dataset &data, const int rows[], int numRows, int batchSize, const double learningParameters[]);
+		
+		///<summary>
+		/// As AdaptNetwork, for a sparse data set: the first layer reads and changes only the weights of the bias and
+		/// of the non-zero inputs of each row, so a row costs in proportion to its non-zeros rather than the width.
+		/// All weights are brought up to date at the end of the pass, so they are then as AdaptNetwork would leave them
+		///
+		///<argument="SparseDataset &data"> Sparse data set, whose outputs are stored</argument>
+		///<argument="const double learningParameters[]"> Array containing the parameters: {learning-rate, momentum}</argument>
+		///</summary>
+		void AdaptSparse (SparseDataset &data, const double learningParameters[]);
+		
+		///<summary>
+		/// As ComputeNetwork, for a sparse data set, calculating the first layer from the non-zero inputs only
+		///
+		///<argument="SparseDataset &data"> Sparse data set, whose outputs are stored</argument>
+		///</summary>
+		void ComputeSparse (SparseDataset &data);
+		
+		///<summary>
+		/// Calculates the network outputs of many rows of scaled inputs at once, giving the same values as CalcOutputs.
+		/// Only the weights are read, so many threads may call it on one network, each with its own workspace,
+		/// unless a pool is attached (see SetPool): then wide layers are split across it and one thread calls at a time
+		///
+		///<argument="const double inputs[]"> Array containing numRows rows of inputs, one after another</argument>
+		///<argument="int numRows"> Amount of rows</argument>
+		///<argument="double outputs[]"> Array onto which numRows rows of network outputs are stored</argument>
+		///<argument="double workspace[]"> Array of at least BatchWorkspace(numRows) doubles, for the outputs of hidden layers</argument>
+		///</summary>
+		virtual void ForwardBatch (const double inputs[], int numRows, double outputs[], double workspace[]);
+		
+		///<summary>
+		/// Returns the amount of doubles of workspace ForwardBatch needs for numRows rows
+		///</summary>
+		virtual int BatchWorkspace (int numRows);
+		
+		///<summary>
+		/// Calculates the outputs of one layer of the network for many rows, as ForwardBatch does for that layer,
+		/// so the layers can be run apart (see LayerPipeline). Only the weights are read
+		///
+		///<argument="int layer"> Layer, counted from this one</argument>
+		///<argument="const double inputs[]"> Array containing numRows rows of the layer's inputs</argument>
+		///<argument="int numRows"> Amount of rows</argument>
+		///<argument="double layerOutputs[]"> Array onto which numRows rows of the layer's outputs are stored</argument>
 		///</summary>
-		virtual void AdaptNetwork (dataset &data, const double learningParameters[]);
+		virtual void ForwardLayerBatch (int layer, const double inputs[], int numRows, double layerOutputs[]);
 		
 		///<summary>
 		/// Initialises the weights in the network using the values in initialWeights[]
@@ -132,6 +382,72 @@ class LinearLayerNetwork {
 		///<argument="double theWeights[]"> Array onto the network's weights are copied</argument>
 		///</summary>
 		virtual void ReturnTheWeights (double theWeights[]);
+		
+		///<summary>
+		/// Initialises the changes in weights (the momentum state) using the values in initialDeltaWeights[],
+		/// which are in the same order as the weights
+		///
+		///<argument="const double initialDeltaWeights[]"> Array containing the changes in weights</argument>
+		///</summary>
+		virtual void SetTheDeltaWeights (const double initialDeltaWeights[]);
+		
+		///<summary>
+		/// Copies the changes in weights of this layer into the argument array "theDeltaWeights[]"
+		///
+		///<argument="double theDeltaWeights[]"> Array onto which the network's changes in weights are copied</argument>
+		///</summary>
+		virtual void ReturnTheDeltaWeights (double theDeltaWeights[]);
+		
+		///<summary>
+		/// Returns the amount of inputs and of neurons in this layer
+		///</summary>
+		int HowManyInputs ();
+		int HowManyNeurons ();
+		
+		///<summary>
+		/// Returns the amount of outputs of the network, which are those of its last layer
+		///</summary>
+		virtual int HowManyOutputs ();
+		
+		///<summary>
+		/// Returns the type of the layer: 'L' for linear, 'S' for sigmoidal, 'M' for a sigmoidal layer with a next layer,
+		/// 'C' for a softmax output layer, or, for a hidden layer with another activation, the TYPE of its policy (see activation.h)
+		///</summary>
+		virtual char LayerType ();
+		
+		///<summary>
+		/// Returns the size of the kernels the layer runs, such as "4x10", or "generic" if it runs the loops of any size
+		///</summary>
+		const char * KernelName ();
+		
+		///<summary>
+		/// Splits the neurons of this layer and the layers after it, of POOL_MIN_WEIGHTS weights or more, across a pool,
+		/// a row (or, in ForwardBatch, a batch) at a time, cutting the time of one request on wide layers; each layer waits for the one before.
+		/// The pool must outlive its use by the network, and only one network may use it at a time
+		///
+		///<argument="SpinPool *pool"> Pool of threads, or 0 to run every layer on the calling thread again</argument>
+		///</summary>
+		void SetPool (SpinPool *pool);
+		
+		///<summary>
+		/// Returns the layer after this one, or 0 if this is the output layer
+		///</summary>
+		virtual LinearLayerNetwork * NextLayer ();
+		
+		///<summary>
+		/// Returns the amount of layers from this one to the output layer
+		///</summary>
+		virtual int HowManyLayers ();
+		
+		///<summary>
+		/// Finds the size and LayerType() of a layer of the network, 0 being this one
+		///
+		///<argument="int layer"> Layer, counted from this one</argument>
+		///<argument="int &layerInputs"> Onto which the amount of inputs of the layer is stored</argument>
+		///<argument="int &layerNeurons"> Onto which the amount of neurons of the layer is stored</argument>
+		///<argument="char &layerType"> Onto which the type of the layer is stored</argument>
+		///</summary>
+		virtual void DescribeLayer (int layer, int &layerInputs, int &layerNeurons, char &layerType);
 };
 
 ///<summary>
@@ -158,6 +474,14 @@ class SigmoidalLayerNetwork : public LinearLayerNetwork {
 		///</summary>
 		virtual void CalcOutputs (const double Inputs[]);	
 		
+		///<summary>
+		/// Applies Output = 1 / (1 + exp( - Sum ) ) to each weighted sum
+		///
+		///<argument="double values[]"> Array containing the weighted sums</argument>
+		///<argument="int count"> Amount of values</argument>
+		///</summary>
+		virtual void Activate (double values[], int count);
+		
 	public:
 	
 		///<summary>
@@ -165,14 +489,74 @@ class SigmoidalLayerNetwork : public LinearLayerNetwork {
 		///
 		///<argument="int numInputs"> Amount of inputs to the network</argument>
 		///<argument="int numOutputs"> Amount of outputs to the network</argument>
+		///<argument="Arena *arena"> If given, the arena the layer's arrays are carved from</argument>
 		///</summary>
-		SigmoidalLayerNetwork (int numInputs, int numOutputs); 
+		SigmoidalLayerNetwork (int numInputs, int numOutputs, Arena *arena = 0); 
 		
 		///<summary>
 		/// Destructor
 		///</summary>
 		virtual ~SigmoidalLayerNetwork ();			
 		
+		///<summary>
+		/// Returns 'S'
+		///</summary>
+		virtual char LayerType ();
+		
+};
+
+///<summary>
+/// Output layer with softmax-activation, for classes given as one target each (see dataset::MakeOneHot):
+/// the outputs are the probabilities of each class. Inherits most of its methods from the "LinearLayerNetwork" object
+///</summary>
+class SoftmaxLayerNetwork : public LinearLayerNetwork {
+	
+	protected:
+		
+		///<summary>
+		/// Calculates the deltas of the softmax and cross-entropy together. The cross-entropy's slope,
+		/// - Target / Output, times the softmax's, cancels down to "Target - Output", which are the errors,
+		/// so no exp or divide is needed and the deltas never vanish as a sigmoid's do when it saturates
+		///
+		///<argument="const double Errors[]"> Array containing the errors of the network (target - output)</argument>
+		///</summary>
+		virtual void FindDeltas (const double Errors[]);
+		
+		///<summary>
+		/// Calculates the outputs as the softmax of the weighted sums
+		///
+		///<argument="const double Inputs[]"> Array containing the inputs to the layer</argument>
+		///</summary>
+		virtual void CalcOutputs (const double Inputs[]);
+		
+		///<summary>
+		/// Applies the softmax to each row of numNeurons weighted sums in values[]
+		///
+		///<argument="double values[]"> Array containing whole rows of weighted sums</argument>
+		///<argument="int count"> Amount of values, a multiple of numNeurons</argument>
+		///</summary>
+		virtual void Activate (double values[], int count);
+		
+	public:
+	
+		///<summary>
+		/// Constructor
+		///
+		///<argument="int numInputs"> Amount of inputs to the layer</argument>
+		///<argument="int numOutputs"> Amount of outputs, one for each class</argument>
+		///<argument="Arena *arena"> If given, the arena the layer's arrays are carved from</argument>
+		///</summary>
+		SoftmaxLayerNetwork (int numInputs, int numOutputs, Arena *arena = 0); 
+		
+		///<summary>
+		/// Destructor
+		///</summary>
+		virtual ~SoftmaxLayerNetwork ();
+		
+		///<summary>
+		/// Returns 'C'
+		///</summary>
+		virtual char LayerType ();
 };
 
 ///<summary>
@@ -217,6 +601,11 @@ class MultiLayerNetwork : public SigmoidalLayerNetwork {
 		///<argument="const double learningParameters[]"> Array containing the parameters: {learning-rate, momentum}</argument>
 		///</summary>
 		virtual void ChangeAllWeights (const double Inputs[], const double learningParameters[]);
+		
+		///<summary>
+		/// Returns the address of the outputs of the next layer, which are the network's outputs
+		///</summary>
+		virtual double * NetworkOutputs ();
 
 	public:
 	
@@ -225,9 +614,11 @@ class MultiLayerNetwork : public SigmoidalLayerNetwork {
 	///
 	///<argument="int numInputs"> Amount of inputs to the layer</argument>
 	///<argument="int numOutputs"> Amount of outputs to the layer</argument>
-	///<argyment="LinearLayerNetwork *to_next_layer"> Pointer to the next layer</argument>
+	///<argyment="LinearLayerNetwork *to_next_layer"> Pointer to the next layer, which is then owned by this network</argument>
+	///<argument="Arena *arena"> If given, the arena this layer's arrays are carved from; it is then owned and freed by
+	/// this network, so the next layer's arrays may be carved from it too</argument>
 	///</summary>
-	MultiLayerNetwork (int numInputs, int numOutputs, LinearLayerNetwork *to_next_layer); 
+	MultiLayerNetwork (int numInputs, int numOutputs, LinearLayerNetwork *to_next_layer, Arena *arena = 0); 
 	
 	///<summary>
 	/// Destructor
@@ -253,6 +644,124 @@ class MultiLayerNetwork : public SigmoidalLayerNetwork {
 	///</summary>
 	virtual void ReturnTheWeights (double theWeights[]);
 	
+	///<summary>
+	/// Initialises the changes in weights of the main layer and next layers, in the same order as SetTheWeights
+	///
+	///<argument="const double initialDeltaWeights[]"> Array containing the changes in weights</argument>
+	///</summary>
+	virtual void SetTheDeltaWeights (const double initialDeltaWeights[]);
+	
+	///<summary>
+	/// Copies the changes in weights of all layers into the argument array "theDeltaWeights[]"
+	///
+	///<argument="double theDeltaWeights[]"> Array onto which the network's changes in weights are copied</argument>
+	///</summary>
+	virtual void ReturnTheDeltaWeights (double theDeltaWeights[]);
+	
+	///<summary>
+	/// Calculates the hidden outputs of many rows into the workspace, then passes them through the next layer
+	///
+	///<argument="const double inputs[]"> Array containing numRows rows of inputs, one after another</argument>
+	///<argument="int numRows"> Amount of rows</argument>
+	///<argument="double outputs[]"> Array onto which numRows rows of network outputs are stored</argument>
+	///<argument="double workspace[]"> Array of at least BatchWorkspace(numRows) doubles</argument>
+	///</summary>
+	virtual void ForwardBatch (const double inputs[], int numRows, double outputs[], double workspace[]);
+	
+	///<summary>
+	/// Returns the hidden outputs of numRows rows plus the workspace of the next layer
+	///</summary>
+	virtual int BatchWorkspace (int numRows);
+	
+	///<summary>
+	/// Returns the amount of outputs of the next layer
+	///</summary>
+	virtual int HowManyOutputs ();
+	
+	///<summary>
+	/// Returns 'M'
+	///</summary>
+	virtual char LayerType ();
+	
+	///<summary>
+	/// Returns the next layer
+	///</summary>
+	virtual LinearLayerNetwork * NextLayer ();
+	
+};
+
+///<summary>
+/// Multi-layered network whose hidden layer uses the activation policy Act (see activation.h) in place of the sigmoid,
+/// inheriting the rest from "MultiLayerNetwork". The policy is inlined into the loops of CalcOutputs and FindDeltas
+///</summary>
+template <class Act> class ActivationMultiLayerNetwork : public MultiLayerNetwork {
+
+	protected:
+
+		///<summary>
+		/// Calculates the outputs of this layer as Act::Apply ( Sum ), then those of the next layer
+		///
+		///<argument="const double Inputs[]"> An array containing inputs to the network</argument>
+		///</summary>
+		virtual void CalcOutputs (const double Inputs[]);
+
+		///<summary>
+		/// Applies Act::Apply to each weighted sum, as used by ForwardBatch
+		///
+		///<argument="double values[]"> Array containing the weighted sums</argument>
+		///<argument="int count"> Amount of values</argument>
+		///</summary>
+		virtual void Activate (double values[], int count);
+
+		///<summary>
+		/// Calculates the deltas in the next layer, then in this layer as "Errors * Act::Slope ( Output )"
+		///
+		///<argument="const double Errors[]"> Array containing the errors of the network (target - output)</argument>
+		///</summary>
+		virtual void FindDeltas (const double Errors[]);
+
+	public:
+
+		///<summary>
+		/// Constructor, as that of MultiLayerNetwork
+		///</summary>
+		ActivationMultiLayerNetwork (int numInputs, int numOutputs, LinearLayerNetwork *to_next_layer, Arena *arena = 0);
+
+		///<summary>
+		/// Returns Act::TYPE
+		///</summary>
+		virtual char LayerType ();
 };
 
+///<summary>
+/// Creates and returns a neural-layer
+///
+///<argument="char option"> Controls the mode of operation of the function:
+/// IF = 'L': Creates and returns linear activation layer
+/// IF = 'S': Creates and returns sigmoidal activation layer 
+/// IF = 'T', 'R', 'E' or 'H': Creates and returns multi-layer network with a tanh, ReLU, leaky ReLU or hard sigmoid
+/// hidden layer and a sigmoidal output layer
+/// IF = 'C': Creates and returns multi-layer network with a sigmoidal hidden layer and a softmax output layer,
+/// for data with one target per class
+/// ELSE: Creates and returns multi-layer sigmoidal activation network</argument>
+///<argument="int hiddenNodes">Number of nodes in the hidden layer</argument>
+///<argument="dataset &data">Location to the dataset containing data to be used</argument>
+///
+///<return="LinearLayerNetwork*">Layer of neurons</return>
+///</summary>
+LinearLayerNetwork * MakeNet (char option, int hiddenNodes, dataset &data);
+
+///<summary>
+/// Creates and returns a neural-layer of the given size, as MakeNet above
+///
+///<argument="char option"> 'L' linear layer, 'S' sigmoidal layer, 'T', 'R', 'E' or 'H' multi-layer network of that hidden
+/// activation, 'C' multi-layer network with a softmax output layer, else multi-layer sigmoidal network</argument>
+///<argument="int numInputs">Number of inputs to the network</argument>
+///<argument="int hiddenNodes">Number of nodes in the hidden layer</argument>
+///<argument="int numOutputs">Number of outputs of the network</argument>
+///
+///<return="LinearLayerNetwork*">Layer of neurons</return>
+///</summary>
+LinearLayerNetwork * MakeNet (char option, int numInputs, int hiddenNodes, int numOutputs);
+
 #endif
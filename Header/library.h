@@ -9,20 +9,111 @@
 	#include <iomanip>
 	#include <fstream>
 	#include <iostream>
+	#include <vector>
+	#include <thread>
+	#include <atomic>
+	#include <chrono>
+	#include <mutex>
+	#include <condition_variable>
+	#include <deque>
+	#include <string>
+	#include <charconv>
+	#include <algorithm>
+	#include <climits>
 	using namespace std;
 	
 	#include <math.h>
 	#include <stdlib.h>
 	#include <string.h>
 	#include <stdio.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <errno.h>
+	#include <poll.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#ifdef __linux__
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <pthread.h>
+	#include <sched.h>
+	#endif
 
 
+	#include "arena.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/arena.cpp"
+	
+	#include "writer.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/writer.cpp"
+	
 	#include "data.h"
+	#include "metrics.h"
 	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/data.cpp"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/metrics.cpp"
+	
+	#include "sparse.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/sparse.cpp"
+
+	#include "profile.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/profile.cpp"
+	
+	#include "counters.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/counters.cpp"
 	
+	#include "rng.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/rng.cpp"
+
+	#include "telemetry.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/telemetry.cpp"
+	
+	#include "activation.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/activation.cpp"
+
+	#include "gemm.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/gemm.cpp"
+
+	#include "kernels.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/kernels.cpp"
+
+	#include "pool.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/pool.cpp"
+
 	#include "layer.h"
 	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/layer.cpp"
 	
+	#include "deep.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/deep.cpp"
+	
+	#include "order.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/order.cpp"
+	
+	#include "checkpoint.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/checkpoint.cpp"
+	
+	#include "predict.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/predict.cpp"
+	
+	#include "prune.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/prune.cpp"
+	
+	#include "crossval.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/crossval.cpp"
+	
+	#include "server.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/server.cpp"
+	
+	#include "pipeline.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/pipeline.cpp"
+	
+	#include "score.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/score.cpp"
+	
+	#include "driver.h"
+	#include "/home/a/Documents/Projects/ArtificialNeuralNetworks/RJM Modified/Source/driver.cpp"
+	
 	
 	
 
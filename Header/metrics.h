@@ -0,0 +1,102 @@
+/*
+* 	Header-file for accumulating SSE and % correct classifications while outputs are calculated
+*/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "library.h"
+
+///<summary>
+/// Accumulates, row by row, the same SSE and % correct classifications that dataset::CalcSSE and
+/// dataset::CalcCorrectClassifications find by rescanning the whole set.
+/// The rescaling constants are found once from the dataset, and the kind of data is checked once per row
+/// rather than once per value, so the loops over the outputs have no branches
+///</summary>
+class MetricsAccumulator {
+
+	protected:
+
+		//Amount of outputs in each row
+		int numOutputs;
+
+		//0 for logic, 1 for numerical, 2 for classifier, 3 for one-hot classes : as dataset
+		int datatype;
+
+		//Amount of rows accumulated
+		int count;
+
+		//Per output: min of the targets, (max - min) of the targets, and 1 if rescaling applies else 0
+		double *minimum;
+		double *range;
+		double *isScaled;
+
+		//Per output: running sum of squared errors, then mean sum squared errors
+		double *sse;
+
+		//Per output: running count of correct classifications, then %
+		double *correct;
+
+		//Per output: mean SSE and % correct, as returned
+		double *meanSSE;
+		double *percentCorrect;
+
+		///<summary>
+		/// Rescales the values of a row of outputs or targets into unscaled units, without branches
+		///</summary>
+		void Rescale (const double values[], double scaled[]);
+
+	public:
+
+		///<summary>
+		/// Constructor, takes the rescaling constants of the targets from the dataset
+		///
+		///<argument="dataset &data"> Dataset whose outputs and targets are to be accumulated</argument>
+		///</summary>
+		MetricsAccumulator (dataset &data);
+
+		///<summary>
+		/// Destructor
+		///</summary>
+		~MetricsAccumulator ();
+
+		///<summary>
+		/// Clears all sums, ready for the next pass
+		///</summary>
+		void Reset ();
+
+		///<summary>
+		/// Adds the squared errors and correct classifications of one row
+		///
+		///<argument="const double outputs[]"> Array containing the outputs of the network for the row</argument>
+		///<argument="const double targets[]"> Array containing the targets of the row</argument>
+		///</summary>
+		void Accumulate (const double outputs[], const double targets[]);
+
+		///<summary>
+		/// Returns the amount of rows accumulated since Reset()
+		///</summary>
+		int Count ();
+
+		///<summary>
+		/// Returns the address of the array of mean sum squared errors of each output
+		///</summary>
+		double * CalcSSE ();
+
+		///<summary>
+		/// Returns the sum of the mean sum squared errors of all outputs
+		///</summary>
+		double TotalSSE ();
+
+		///<summary>
+		/// Returns the address of the array of % correct classifications of each output
+		///</summary>
+		double * CalcCorrectClassifications ();
+
+		///<summary>
+		/// Prints s then the array of SSEs (which = 'S') or % correct classifications (which = 'C'), as dataset::printarray
+		///</summary>
+		void printarray (const char *s, char which, int nl = 0);
+};
+
+#endif
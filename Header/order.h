@@ -0,0 +1,105 @@
+/*
+* 	Header-file for the order in which rows of a dataset are presented to a network each epoch
+*/
+
+#ifndef ORDER_H
+#define ORDER_H
+
+#include "library.h"
+
+///<summary>
+/// Ways in which the rows are ordered each epoch
+///</summary>
+enum OrderStrategy {
+
+	//Rows in file order, as AdaptNetwork has always done
+	ORDER_FILE = 0,
+
+	//Fisher-Yates shuffle of all rows
+	ORDER_SHUFFLE = 1,
+
+	//Shuffle of cache-sized blocks of rows, then of the rows within each block
+	ORDER_BLOCK_SHUFFLE = 2
+};
+
+///<summary>
+/// Produces the order of the rows for each epoch, using a fast seeded random-number generator
+///</summary>
+class SampleOrder {
+
+	protected:
+
+		//Amount of rows in the dataset
+		int numRows;
+
+		//Amount of rows in a block, for ORDER_BLOCK_SHUFFLE
+		int blockRows;
+
+		//Chosen strategy
+		OrderStrategy strategy;
+
+		//Indices of the rows in the order they are to be presented
+		int *order;
+
+		//Order of the blocks, for ORDER_BLOCK_SHUFFLE
+		int *blockOrder;
+
+		//Seed of the order, and the epochs ordered so far; each epoch is shuffled by its own stream of the seed
+		unsigned long long seed;
+		unsigned long long epoch;
+
+		//Generator of the current epoch
+		RandomStream random;
+
+		///<summary>
+		/// Returns a random integer in the range 0..n-1
+		///</summary>
+		int RandomBelow (int n);
+
+		///<summary>
+		/// Fisher-Yates shuffle of the num integers in values[]
+		///</summary>
+		void Shuffle (int values[], int num);
+
+	public:
+
+		///<summary>
+		/// Constructor
+		///
+		///<argument="int numRows"> Amount of rows in the dataset</argument>
+		///<argument="OrderStrategy strategy"> How the rows are ordered each epoch</argument>
+		///<argument="unsigned long long seed"> Seed of the run; the order uses its STREAM_ORDER</argument>
+		///<argument="int rowBytes"> Size of one row of the dataset in bytes, used to size the blocks</argument>
+		///<argument="int blockBytes"> Size of a block in bytes, defaults to a typical L1 data cache</argument>
+		///</summary>
+		SampleOrder (int numRows, OrderStrategy strategy, unsigned long long seed, int rowBytes = sizeof(double), int blockBytes = 32768);
+
+		///<summary>
+		/// Destructor
+		///</summary>
+		~SampleOrder ();
+
+		///<summary>
+		/// Reorders the rows for the next epoch and returns the address of the array of row indices
+		///</summary>
+		const int * NextEpoch ();
+
+		///<summary>
+		/// Returns the amount of rows in a block
+		///</summary>
+		int BlockRows ();
+
+		///<summary>
+		/// Returns the name of the strategy, for printing
+		///</summary>
+		const char * Name ();
+
+		///<summary>
+		/// Returns and sets the epochs ordered so far. As each epoch has its own stream, setting this with
+		/// the same seed resumes the run exactly where it was left
+		///</summary>
+		unsigned long long GetState ();
+		void SetState (unsigned long long newState);
+};
+
+#endif
@@ -0,0 +1,223 @@
+/*
+* 	Header-file for streaming rows through the layers of a network, each group of layers on a core of its own
+*
+* 	The layers are split into stages of about the same amount of weights. Rows are cut into micro-batches that
+* 	flow from stage to stage through lock-free queues of one producer and one consumer, so while a stage works on
+* 	one micro-batch the stage after it works on the one before. Each stage counts the time it is busy, starved
+* 	of micro-batches by the stage before, and blocked waiting for the stage after to free a buffer, so the
+* 	stages can be balanced. The stage threads are started and pinned once, and park when left without work,
+* 	so one call after another streams through without refilling the pipeline or starting threads again
+*/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "library.h"
+
+//Buffers of outputs of each stage: the most micro-batches a stage may be ahead of the one after it
+const int PIPELINE_BUFFERS = 4;
+
+///<summary>
+/// Queue of one producing and one consuming thread, neither ever waiting on a lock
+///</summary>
+template <class T> class SpscQueue {
+
+	protected:
+
+		//Ring of items, its size a power of 2
+		vector<T> items;
+		size_t mask;
+
+		//Count of items popped, written only by the consumer, and pushed, only by the producer, on lines of their own
+		alignas(64) atomic<size_t> head;
+		alignas(64) atomic<size_t> tail;
+
+	public:
+
+		///<summary>
+		/// Constructor, for at least capacity items
+		///</summary>
+		SpscQueue (int capacity);
+
+		///<summary>
+		/// Pushes an item, from the producer; returns false if the queue is full
+		///</summary>
+		bool TryPush (const T &item);
+
+		///<summary>
+		/// Pops the oldest item, from the consumer; returns false if the queue is empty
+		///</summary>
+		bool TryPop (T &item);
+};
+
+///<summary>
+/// Rows of a micro-batch: the caller's inputs and outputs, which buffer of the stage before holds its inputs,
+/// and when it was given to the pipeline. No rows ends the threads of the stages
+///</summary>
+struct PipelineBatch {
+
+	const double *inputs;
+	double *outputs;
+	int rows;
+	int buffer;
+	chrono::steady_clock::time_point submitted;
+};
+
+///<summary>
+/// Layers of one stage, its buffers, and its counters
+///</summary>
+struct PipelineStage {
+
+	//Layers of the stage, counted from the network's first, and their weights
+	int firstLayer;
+	int numLayers;
+	long long weights;
+
+	//Amount of inputs of its first layer and of outputs of its last, and neurons of its widest layer
+	int numInputs;
+	int numOutputs;
+	int widest;
+
+	//Core the stage runs on, and whether its thread could be pinned to it
+	int core;
+	bool pinned;
+
+	//PIPELINE_BUFFERS buffers of a micro-batch of outputs, unless the last stage, which writes the caller's outputs;
+	//and two halves of a micro-batch of the widest layer for the outputs of layers within the stage
+	vector<double> buffers;
+	vector<double> hidden;
+
+	//Micro-batches run, and seconds busy running them, waiting for inputs, and waiting for a free buffer
+	long long batches;
+	double busySeconds;
+	double starvedSeconds;
+	double blockedSeconds;
+};
+
+///<summary>
+/// Runs the rows given to it through a network a stage at a time, each stage on a thread pinned to a core.
+/// Gives the same outputs as ForwardBatch, as each layer is run by ForwardLayerBatch on whole micro-batches.
+/// Only the weights of the network are read, and it must not be changed while running
+///</summary>
+class LayerPipeline {
+
+	protected:
+
+		LinearLayerNetwork *net;
+		vector<PipelineStage> stages;
+
+		//Rows of a micro-batch
+		int microRows;
+
+		//Micro-batches into each stage, and the buffers of each stage but the last freed by the stage after it
+		vector<SpscQueue<PipelineBatch> *> inbound;
+		vector<SpscQueue<int> *> freed;
+
+		//Thread of each stage, and the micro-batches each has run and counted, which Wait waits on
+		vector<thread> workers;
+		atomic<long long> *settled;
+
+		//Micro-batches given to the pipeline so far
+		long long submittedBatches;
+
+		//Threads parked on wake, which are only locked and notified for when there are any
+		atomic<int> parked;
+		mutex parking;
+		condition_variable wake;
+
+		//Rows run, and seconds the pipeline had rows in it, since made or reset; and whether it has rows in it, since when
+		long long numRows;
+		double seconds;
+		bool busy;
+		chrono::steady_clock::time_point busySince;
+
+		///<summary>
+		/// Loop run by the thread of each stage: micro-batches until one of no rows
+		///</summary>
+		void StageLoop (int stage);
+
+		///<summary>
+		/// Spins until ready() returns true, then parks on wake once it has spun POOL_PARK_SPINS times
+		///</summary>
+		template <class Ready> void WaitFor (Ready ready);
+
+		///<summary>
+		/// Wakes every parked thread, if any, so each checks again what it waits for
+		///</summary>
+		void Notify ();
+
+		///<summary>
+		/// Pushes onto, or pops from, a queue, waiting while it is full or empty, then wakes whoever waits on the queue
+		///</summary>
+		template <class T> void Push (SpscQueue<T> &queue, const T &item);
+		template <class T> void Pop (SpscQueue<T> &queue, T &item);
+
+		///<summary>
+		/// Pins the calling thread to a core, returning false if it could not be
+		///</summary>
+		static bool PinToCore (int core);
+
+	public:
+
+		///<summary>
+		/// Constructor, splits the layers into stages of about the same amount of weights and starts their threads
+		///
+		///<argument="LinearLayerNetwork *net"> Trained network</argument>
+		///<argument="int numStages"> Amount of stages, at most the amount of layers</argument>
+		///<argument="int microRows"> Rows of each micro-batch</argument>
+		///<argument="int firstCore"> Core of the first stage; each stage after it takes the next core, round the cores there are</argument>
+		///</summary>
+		LayerPipeline (LinearLayerNetwork *net, int numStages, int microRows = 64, int firstCore = 0);
+
+		///<summary>
+		/// Destructor, ends the threads of the stages
+		///</summary>
+		~LayerPipeline ();
+
+		///<summary>
+		/// Gives rows of scaled inputs to the pipeline, returning once all are queued, which may be before they are run.
+		/// Rows given by one call after another run one after the other, with no wait between them.
+		/// Only one thread may give rows, and the inputs and outputs must be kept until Wait returns for them
+		///
+		///<argument="const double inputs[]"> Array containing numRows rows of inputs, one after another</argument>
+		///<argument="int numRows"> Amount of rows</argument>
+		///<argument="double outputs[]"> Array onto which numRows rows of network outputs are stored</argument>
+		///</summary>
+		long long Submit (const double inputs[], int numRows, double outputs[]);
+
+		///<summary>
+		/// Waits until the rows of a Submit, and every one before it, are run
+		///
+		///<argument="long long ticket"> As returned by Submit</argument>
+		///</summary>
+		void Wait (long long ticket);
+
+		///<summary>
+		/// Runs rows of scaled inputs through the network, returning once all are run: Submit then Wait
+		///</summary>
+		void Run (const double inputs[], int numRows, double outputs[]);
+
+		///<summary>
+		/// Returns the amount of stages, and one of them with its counters
+		///</summary>
+		int HowManyStages ();
+		const PipelineStage & Stage (int stage);
+
+		///<summary>
+		/// Returns the seconds taken by every Run, and the fraction of them a stage was busy
+		///</summary>
+		double RunSeconds ();
+		double Occupancy (int stage);
+
+		///<summary>
+		/// Sets the counters of every stage to 0, between runs
+		///</summary>
+		void ResetCounters ();
+
+		///<summary>
+		/// Prints the layers, core and occupancy of each stage, one line each
+		///</summary>
+		void Print ();
+};
+
+#endif
@@ -0,0 +1,110 @@
+/*
+* 	Header-file for splitting the work of one wide layer across a pool of spinning threads
+*
+* 	Waking a thread blocked on a condition variable takes some microseconds, as long as a whole wide layer
+* 	takes on one core, so the threads of a SpinPool are started once and spin between layers instead.
+* 	A thread left without a task for POOL_PARK_SPINS checks parks on a condition variable, so an idle pool
+* 	holds no core; only the first task after a pause pays for the wake.
+* 	A layer hands each thread a part of its neurons (or inputs), works on the first part itself, and
+* 	waits on a counter for the rest: the barrier before the next layer may start
+*/
+
+#ifndef POOL_H
+#define POOL_H
+
+#include "library.h"
+
+//Fewest weights of a layer whose neurons are split across a pool; smaller layers take less than the barrier
+const int POOL_MIN_WEIGHTS = 32768;
+
+//Checks of the counter between pauses of a spinning thread before it also yields its core to others,
+//so a pool of more threads than cores, or one left idle, still lets every thread run
+const int POOL_SPINS = 4096;
+
+//Checks of the counter after which a thread still without a task parks until the next one
+const int POOL_PARK_SPINS = 65536;
+
+///<summary>
+/// Tells the core the calling thread is spinning, which frees the core's resources for its other thread, if any
+///</summary>
+void SpinPause ();
+
+///<summary>
+/// Part of a task, given its context, which of the parts it is, and the amount of parts
+///</summary>
+typedef void (*PoolTask) (void *context, int part, int numParts);
+
+///<summary>
+/// Pool of threads that spin until given a task, for work on one row too short to wake threads for.
+/// Each task is split into as many parts as the pool has threads, the calling thread included;
+/// Run returns once every part is done. Only one thread may call Run at a time
+///</summary>
+class SpinPool {
+
+	protected:
+
+		//Threads other than the caller; the caller works on part 0
+		vector<thread> workers;
+		int numParts;
+
+		//Task being run and its context, set before generation is raised
+		PoolTask task;
+		void *context;
+
+		//Raised once for each task, which the workers spin on, and parts of the task not yet done
+		atomic<long long> generation;
+		atomic<int> remaining;
+
+		//Cleared to end the workers
+		atomic<bool> running;
+
+		//Workers parked on wake, which Run only locks and notifies for when there are any
+		atomic<int> parked;
+		mutex parking;
+		condition_variable wake;
+
+		///<summary>
+		/// Loop run by each worker: waits for the next generation, spinning then parked, runs its part, and counts it done
+		///</summary>
+		void WorkerLoop (int part);
+
+	public:
+
+		///<summary>
+		/// Constructor, starts the workers
+		///
+		///<argument="int numThreads"> Threads to split tasks across, the calling thread included, at least 1</argument>
+		///</summary>
+		SpinPool (int numThreads);
+
+		///<summary>
+		/// Destructor, ends the workers
+		///</summary>
+		~SpinPool ();
+
+		///<summary>
+		/// Runs every part of a task, part 0 on the calling thread, and returns once all are done
+		///
+		///<argument="PoolTask task"> Function run for each part</argument>
+		///<argument="void *context"> Passed to each part</argument>
+		///</summary>
+		void Run (PoolTask task, void *context);
+
+		///<summary>
+		/// Returns the amount of parts tasks are split into, the threads of the pool
+		///</summary>
+		int HowManyParts ();
+
+		///<summary>
+		/// Finds the part of count items one part of numParts works on, the same size to within one
+		///
+		///<argument="int count"> Amount of items, such as the neurons of a layer</argument>
+		///<argument="int part"> Part, 0 to numParts - 1</argument>
+		///<argument="int numParts"> Amount of parts</argument>
+		///<argument="int &begin"> First item of the part</argument>
+		///<argument="int &end"> One past the last item of the part</argument>
+		///</summary>
+		static void Split (int count, int part, int numParts, int &begin, int &end);
+};
+
+#endif
@@ -0,0 +1,90 @@
+/*
+* 	Header-file for predicting single rows of raw data with a trained network
+*/
+
+#ifndef PREDICT_H
+#define PREDICT_H
+
+#include "library.h"
+
+///<summary>
+/// Predicts the outputs of one row of raw inputs at a time, without a dataset.
+/// The min/max scaling of the inputs is folded into the weights of the first layer, and the rescaling
+/// of the outputs into the weights of the last layer when it is linear, or else into one multiply and add
+/// per output after its sigmoid. Everything is made at construction, so Predict() allocates nothing.
+/// The weights are copied, so later training of the network does not change the predictions.
+/// A Predictor has its own hidden-layer buffers, so each thread needs a Predictor of its own
+///</summary>
+class Predictor {
+
+	protected:
+
+		//Size and type of each layer, first to last
+		vector<CheckpointLayer> layers;
+
+		//Weights of every layer, in SetTheWeights order, with the scaling folded in
+		vector<double> weights;
+
+		//Index in weights[] of the first weight of each layer
+		vector<int> layerStart;
+
+		//Rescaling of each output left after the last layer's sigmoid: raw = outputScale * output + outputOffset
+		vector<double> outputScale;
+		vector<double> outputOffset;
+
+		//True if the rescaling is folded into the last layer's weights instead
+		bool foldedOutputs;
+
+		//Datatype of the training data: outputs of logic data are thresholded, of classifiers rounded,
+		//and of one-hot classes left as the probabilities of each class
+		int datatype;
+		bool hasScaling;
+
+		//Outputs of hidden layers, one buffer for each layer in turn
+		vector<double> hidden[2];
+
+		//Pool the neurons of wide layers are split across, or 0 to predict on the calling thread
+		SpinPool *pool;
+
+	public:
+
+		///<summary>
+		/// Constructor, copies the weights of the network and folds the scaling into them
+		///
+		///<argument="LinearLayerNetwork *net"> Trained network</argument>
+		///<argument="const DataScaling &scaling"> Min/max of the training data, as from dataset::GetScaling or a checkpoint</argument>
+		///</summary>
+		Predictor (LinearLayerNetwork *net, const DataScaling &scaling);
+
+		///<summary>
+		/// Predicts the outputs of one row
+		///
+		///<argument="const double rawInputs[]"> Inputs, in the units of the data set</argument>
+		///<argument="double rawOutputs[]"> Array onto which the outputs, in the units of the targets, are stored</argument>
+		///</summary>
+		void Predict (const double rawInputs[], double rawOutputs[]);
+
+		///<summary>
+		/// Splits the neurons of layers of POOL_MIN_WEIGHTS weights or more across a pool, cutting the latency of
+		/// one row on wide networks. The pool must outlive its use, and only one Predictor may use it at a time
+		///
+		///<argument="SpinPool *pool"> Pool of threads, or 0 to predict on the calling thread again</argument>
+		///</summary>
+		void SetPool (SpinPool *pool);
+
+		///<summary>
+		/// Returns the amount of inputs and outputs of the network
+		///</summary>
+		int HowManyInputs ();
+		int HowManyOutputs ();
+};
+
+///<summary>
+/// Returns the value below which the given fraction of the samples lie; the samples are reordered
+///
+///<argument="vector<double> &samples"> Samples, such as latencies</argument>
+///<argument="double fraction"> Fraction, such as 0.99 for the 99th percentile</argument>
+///</summary>
+double Percentile (vector<double> &samples, double fraction);
+
+#endif
@@ -0,0 +1,196 @@
+/*
+* 	Header-file for timing the phases of training and testing, layer by layer
+*
+* 	The timing is compiled in only when ANN_PROFILE is defined (g++ -DANN_PROFILE ...);
+* 	otherwise PROFILE_PHASE, PROFILE_PASS and PROFILE_KERNEL are empty and the layers run exactly as before
+*/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "library.h"
+
+//Layers of a network timed separately; any deeper are added to the last
+const int PROFILE_MAX_LAYERS = 16;
+
+///<summary>
+/// Phases of presenting one row to a network
+///</summary>
+enum ProfilePhase {
+
+	PHASE_FORWARD,		//CalcOutputs
+	PHASE_STORE,		//StoreOutputs
+	PHASE_ERRORS,		//GetNthErrors, or target - output
+	PHASE_DELTAS,		//FindDeltas and PrevLayersErrors
+	PHASE_WEIGHTS,		//ChangeAllWeights
+	PROFILE_PHASES
+};
+
+///<summary>
+/// Time spent in one phase of one layer
+///</summary>
+struct PhaseTotals {
+
+	//Amount of calls, seconds taken by them, and floating-point operations done
+	long long calls;
+	double seconds;
+	double flops;
+
+	//Calls run by kernels of the layer's size (see kernels.h) rather than by the loops of any size
+	long long specialized;
+};
+
+///<summary>
+/// Every phase of every layer, and the passes over data sets they were part of
+///</summary>
+struct ProfileCounters {
+
+	PhaseTotals phases[PROFILE_MAX_LAYERS][PROFILE_PHASES];
+
+	//Passes over data sets (ComputeNetwork, AdaptNetwork ...), the rows presented, and seconds taken in all
+	long long passes;
+	long long samples;
+	double passSeconds;
+};
+
+///<summary>
+/// Counters of one thread, so threads training networks at once never share a counter.
+/// They are added to the totals of finished threads when the thread ends
+///</summary>
+struct ProfileThread {
+
+	ProfileCounters counters;
+
+	ProfileThread ();
+	~ProfileThread ();
+};
+
+///<summary>
+/// Totals of every thread's counters, with samples/sec and GFLOP/s found from them
+///</summary>
+class PhaseProfile {
+
+	protected:
+
+		//Counters of running threads, and the sum of those of threads that have ended
+		static vector<ProfileThread *> running;
+		static ProfileCounters ended;
+
+		//Guards the above
+		static mutex lock;
+
+		///<summary>
+		/// Adds every counter of from to those of to
+		///</summary>
+		static void Add (ProfileCounters &to, const ProfileCounters &from);
+
+		friend struct ProfileThread;
+
+	public:
+
+		///<summary>
+		/// Returns the counters of the calling thread
+		///</summary>
+		static ProfileCounters & ThreadCounters ();
+
+		///<summary>
+		/// Returns true if the timing was compiled in (ANN_PROFILE defined)
+		///</summary>
+		static bool Enabled ();
+
+		///<summary>
+		/// Sets every counter of every thread to 0
+		///</summary>
+		static void Reset ();
+
+		///<summary>
+		/// Returns the sum of the counters of all threads.
+		/// Threads still training are read as they are, so call it once they have finished
+		///</summary>
+		static ProfileCounters Totals ();
+
+		///<summary>
+		/// Returns the rows presented per second of the passes counted
+		///</summary>
+		static double SamplesPerSecond (const ProfileCounters &counters);
+
+		///<summary>
+		/// Returns the floating-point operations per second of a phase, in billions
+		///</summary>
+		static double GigaFlops (const PhaseTotals &totals);
+
+		///<summary>
+		/// Prints the totals as a table: one line per phase of each layer
+		///</summary>
+		static void Print ();
+
+		///<summary>
+		/// Writes the totals as one JSON object
+		///
+		///<argument="FILE *out"> File the object is written to</argument>
+		///</summary>
+		static void WriteJson (FILE *out);
+};
+
+///<summary>
+/// Adds the time from its construction to its destruction to one phase of one layer
+///</summary>
+class ProfileScope {
+
+	protected:
+
+		PhaseTotals &totals;
+		chrono::steady_clock::time_point start;
+
+	public:
+
+		ProfileScope (int layer, ProfilePhase phase, double flops)
+			: totals (PhaseProfile::ThreadCounters().phases[min (layer, PROFILE_MAX_LAYERS - 1)][phase])
+		{
+			totals.calls++;
+			totals.flops += flops;
+			start = chrono::steady_clock::now();
+		}
+
+		~ProfileScope ()
+		{
+			totals.seconds += chrono::duration<double> (chrono::steady_clock::now() - start).count();
+		}
+};
+
+///<summary>
+/// Counts a pass over rows of a data set, and the time from its construction to its destruction
+///</summary>
+class ProfilePass {
+
+	protected:
+
+		ProfileCounters &counters;
+		chrono::steady_clock::time_point start;
+
+	public:
+
+		ProfilePass (int numRows) : counters (PhaseProfile::ThreadCounters())
+		{
+			counters.passes++;
+			counters.samples += numRows;
+			start = chrono::steady_clock::now();
+		}
+
+		~ProfilePass ()
+		{
+			counters.passSeconds += chrono::duration<double> (chrono::steady_clock::now() - start).count();
+		}
+};
+
+#ifdef ANN_PROFILE
+	#define PROFILE_PHASE(layer, phase, flops)	ProfileScope profile_phase (layer, phase, flops)
+	#define PROFILE_PASS(numRows)				ProfilePass profile_pass (numRows)
+	#define PROFILE_KERNEL(layer, phase)		PhaseProfile::ThreadCounters().phases[min (layer, PROFILE_MAX_LAYERS - 1)][phase].specialized++
+#else
+	#define PROFILE_PHASE(layer, phase, flops)
+	#define PROFILE_PASS(numRows)
+	#define PROFILE_KERNEL(layer, phase)
+#endif
+
+#endif
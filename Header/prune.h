@@ -0,0 +1,189 @@
+/*
+* 	Header-file for pruning the smallest weights of a trained network, and for running what is left as sparse layers
+*/
+
+#ifndef PRUNE_H
+#define PRUNE_H
+
+#include "library.h"
+
+//Layers with more than this fraction of their weights left are kept dense by SparseWeightNetwork,
+//as below it the column indices cost less than the multiplies by zero they skip
+const double SPARSE_LAYER_DENSITY = 0.5;
+
+///<summary>
+/// Whether weights are ranked against those of the whole network, or each layer against its own
+///</summary>
+enum PruneScope { PRUNE_GLOBAL = 0, PRUNE_PER_LAYER = 1 };
+
+///<summary>
+/// Prunes the weights of a network by magnitude, setting them and their changes in weights to 0, and remembers which
+/// were pruned so they can be kept at 0 while the rest are fine-tuned. Biases are never pruned.
+/// Pruning again only ever prunes more, so a network can be pruned in steps with fine-tuning between
+///</summary>
+class WeightPruner {
+
+	protected:
+
+		//Size and type of each layer, first to last, and the index of its first weight in SetTheWeights order
+		vector<CheckpointLayer> layers;
+		vector<int> layerStart;
+
+		//1 for each weight kept, 0 for each pruned, in SetTheWeights order
+		vector<char> keep;
+
+		//Weights and changes in weights of the network, as copied out to be pruned
+		vector<double> weights;
+		vector<double> deltaWeights;
+
+		///<summary>
+		/// Returns true if the weight at index is a bias, the first weight of each neuron
+		///</summary>
+		bool IsBias (int layer, int index);
+
+		///<summary>
+		/// Prunes the count smallest of the given weights, counting those already pruned, whose magnitudes are 0
+		///</summary>
+		void PruneSmallest (vector<int> &candidates, int count);
+
+	public:
+
+		///<summary>
+		/// Constructor, with every weight of the network kept
+		///
+		///<argument="LinearLayerNetwork *net"> Network to prune</argument>
+		///</summary>
+		WeightPruner (LinearLayerNetwork *net);
+
+		///<summary>
+		/// Prunes the smallest weights until the given fraction of them is pruned, of the whole network or of each layer
+		///
+		///<argument="LinearLayerNetwork *net"> Network given to the constructor</argument>
+		///<argument="double ratio"> Fraction of the weights, other than biases, to be pruned, 0..1</argument>
+		///<argument="PruneScope scope"> PRUNE_GLOBAL to rank all weights together, PRUNE_PER_LAYER to prune ratio of each layer</argument>
+		///
+		///<return="int"> Amount of weights pruned so far</return>
+		///</summary>
+		int PruneRatio (LinearLayerNetwork *net, double ratio, PruneScope scope);
+
+		///<summary>
+		/// Prunes every weight of magnitude below a threshold: with PRUNE_GLOBAL the threshold itself, with PRUNE_PER_LAYER
+		/// the threshold times the mean magnitude of the weights left in each layer, so layers of small weights are not emptied
+		///
+		///<argument="LinearLayerNetwork *net"> Network given to the constructor</argument>
+		///<argument="double threshold"> Magnitude, or fraction of each layer's mean magnitude, below which weights are pruned</argument>
+		///<argument="PruneScope scope"> PRUNE_GLOBAL or PRUNE_PER_LAYER</argument>
+		///
+		///<return="int"> Amount of weights pruned so far</return>
+		///</summary>
+		int PruneThreshold (LinearLayerNetwork *net, double threshold, PruneScope scope);
+
+		///<summary>
+		/// Sets the pruned weights of the network, and their changes in weights, back to 0
+		///</summary>
+		void Reapply (LinearLayerNetwork *net);
+
+		///<summary>
+		/// Trains the network for some epochs with AdaptRows, which leaves the data set as it is, putting the pruned
+		/// weights back to 0 after each row so the weights left learn, alone, to make up for them
+		///
+		///<argument="LinearLayerNetwork *net"> Network given to the constructor</argument>
+		///<argument="dataset &data"> Training set</argument>
+		///<argument="const double learningParameters[]"> Array containing the parameters: {learning-rate, momentum}</argument>
+		///<argument="int epochs"> Amount of epochs</argument>
+		///</summary>
+		void FineTune (LinearLayerNetwork *net, dataset &data, const double learningParameters[], int epochs);
+
+		///<summary>
+		/// Returns the amount of weights, other than biases, that may be pruned, and of those that are kept
+		///</summary>
+		int HowManyPrunable ();
+		int HowManyKept ();
+
+		///<summary>
+		/// Returns the fraction of the weights of a layer, other than biases, that are kept
+		///</summary>
+		double LayerDensity (int layer);
+};
+
+///<summary>
+/// Copy of a network for inference, with each layer that is mostly zero stored as compressed sparse rows:
+/// for each neuron its bias, then the column and value of each non-zero weight. Layers that are still mostly
+/// non-zero are kept dense. Gives the same outputs as the network, as only products with zero weights are skipped.
+/// The weights are copied, so later training of the network does not change it
+///</summary>
+class SparseWeightNetwork {
+
+	protected:
+
+		//Size and type of each layer, first to last
+		vector<CheckpointLayer> layers;
+
+		//For each layer, true if it is stored sparsely
+		vector<bool> sparse;
+
+		//Dense layers: every weight, in SetTheWeights order, and the index of each layer's first
+		vector<double> denseWeights;
+		vector<int> denseStart;
+
+		//Sparse layers, one neuron after another: bias of each neuron, index in columns[] and values[] of the first
+		//non-zero weight of each neuron and one past the last neuron's, and the column and value of each non-zero weight
+		vector<double> biases;
+		vector<int> rowStart;
+		vector<int> columns;
+		vector<double> values;
+
+		//Index in biases[] and rowStart[] of the first neuron of each sparse layer
+		vector<int> neuronStart;
+
+		//Outputs of hidden layers, one buffer for each layer in turn
+		vector<double> hidden[2];
+
+		///<summary>
+		/// Calculates the outputs of one dense or sparse layer, before any activation
+		///</summary>
+		void DenseSums (int layer, const double inputs[], double sums[]);
+		void SparseSums (int layer, const double inputs[], double sums[]);
+
+	public:
+
+		///<summary>
+		/// Constructor, copies the weights of the network, dropping zero weights of layers below SPARSE_LAYER_DENSITY
+		///
+		///<argument="LinearLayerNetwork *net"> Network, usually pruned by a WeightPruner</argument>
+		///</summary>
+		SparseWeightNetwork (LinearLayerNetwork *net);
+
+		///<summary>
+		/// Calculates the network outputs of one row of scaled inputs, as CalcOutputs would
+		///
+		///<argument="const double inputs[]"> Inputs of the row, scaled as those of a dataset</argument>
+		///<argument="double outputs[]"> Array onto which the outputs are stored</argument>
+		///</summary>
+		void Forward (const double inputs[], double outputs[]);
+
+		///<summary>
+		/// Passes the whole dataset to the network, calculates outputs and stores them in the dataset, as ComputeNetwork
+		///
+		///<argument="dataset &data"> Pointer to the dataset</argument>
+		///</summary>
+		void ComputeNetwork (dataset &data);
+
+		///<summary>
+		/// Returns the amount of weights stored, biases and kept zeros of dense layers included
+		///</summary>
+		long long HowManyStored ();
+
+		///<summary>
+		/// Returns the bytes taken by the weights as stored, and as they would be were every layer dense
+		///</summary>
+		long long StoredBytes ();
+		long long DenseBytes ();
+
+		///<summary>
+		/// Returns true if a layer is stored sparsely
+		///</summary>
+		bool IsSparse (int layer);
+};
+
+#endif
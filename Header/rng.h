@@ -0,0 +1,91 @@
+/*
+* 	Header-file for the random-number generators: fast, seeded per run and stream, and one per thread
+*/
+
+#ifndef RNG_H
+#define RNG_H
+
+#include "library.h"
+
+///<summary>
+/// Streams of one run seed, so that each use of random numbers is unrelated to the others
+/// and does not change when another draws more or fewer numbers
+///</summary>
+enum RandomStreamId {
+
+	//Initial weights of a network
+	STREAM_WEIGHTS = 0,
+
+	//Order of the rows each epoch (see SampleOrder): one stream per epoch within it
+	STREAM_ORDER = 1,
+
+	//Initial weights of each fold of a cross-validation: one stream per fold within it
+	STREAM_FOLDS = 2
+};
+
+///<summary>
+/// xoshiro256** generator. Holds no shared state, so any number of threads draw from their own at once,
+/// and a given seed and stream always give the same numbers
+///</summary>
+class RandomStream {
+
+	protected:
+
+		unsigned long long state[4];
+
+	public:
+
+		///<summary>
+		/// Constructor, seeds the generator
+		///
+		///<argument="unsigned long long seed"> Seed of the run</argument>
+		///<argument="unsigned long long stream"> Stream of the seed, such as a RandomStreamId, a fold or an epoch</argument>
+		///</summary>
+		RandomStream (unsigned long long seed = 0, unsigned long long stream = STREAM_WEIGHTS);
+
+		///<summary>
+		/// Restarts the generator from a seed and stream
+		///</summary>
+		void Seed (unsigned long long seed, unsigned long long stream = STREAM_WEIGHTS);
+
+		///<summary>
+		/// Returns the next 64 random bits
+		///</summary>
+		unsigned long long Next ();
+
+		///<summary>
+		/// Returns a random number in the range 0..1, excluding 1
+		///</summary>
+		double Uniform ();
+
+		///<summary>
+		/// Returns a random number in the range -1..1, as used for initial weights
+		///</summary>
+		double Symmetric ();
+
+		///<summary>
+		/// Returns a random integer in the range 0..n-1
+		///</summary>
+		int Below (int n);
+};
+
+///<summary>
+/// Returns a seed made from a seed and a stream, unrelated to that of any other pair;
+/// used to give a stream streams of its own, as RandomStream (DeriveSeed (seed, STREAM_FOLDS), fold)
+///</summary>
+unsigned long long DeriveSeed (unsigned long long seed, unsigned long long stream);
+
+///<summary>
+/// Returns the generator of the calling thread, from which myrand() draws. Until seeded it is seed 0, STREAM_WEIGHTS
+///</summary>
+RandomStream & ThreadRandom ();
+
+///<summary>
+/// Seeds the generator of the calling thread, as srand() was used, but affecting no other thread
+///
+///<argument="unsigned long long seed"> Seed of the run</argument>
+///<argument="unsigned long long stream"> Stream of the seed</argument>
+///</summary>
+void SeedThreadRandom (unsigned long long seed, unsigned long long stream = STREAM_WEIGHTS);
+
+#endif
@@ -0,0 +1,150 @@
+/*
+* 	Header-file for scoring files of any size with a trained network, streaming them through a fixed amount of memory
+*/
+
+#ifndef SCORE_H
+#define SCORE_H
+
+#include "library.h"
+
+///<summary>
+/// A block of rows passing through the scorer: read, then scored, then written
+///</summary>
+struct ScoreChunk {
+
+	//Inputs of the rows, scaled in place once read; and the outputs, rescaled once found
+	vector<double> inputs;
+	vector<double> outputs;
+
+	//Amount of rows filled
+	int rows;
+
+	//Place of the chunk in the file, counting from 0, so chunks are written in the order read
+	long long sequence;
+};
+
+///<summary>
+/// Scores every row of an input file with a network and writes the rescaled outputs, in order, to another file.
+/// A reader thread parses the input into chunks, several threads score chunks at once with ForwardBatch,
+/// and the calling thread hands them, in the order read, to a ResultWriter.
+/// A fixed pool of chunks is passed round, so memory is bounded whatever the size of the file.
+/// Input is either text in the Resource format (sizes and datatype, min/max if not logic, then rows of
+/// inputs and targets), or a binary file as written by ResultWriter, whose first columns are the inputs
+///</summary>
+class BatchScorer {
+
+	protected:
+
+		//Network scoring the rows, and the min/max the inputs and outputs are scaled with
+		LinearLayerNetwork *net;
+		DataScaling scaling;
+
+		int numInputs;
+		int numOutputs;
+
+		//Amount of scoring threads, and of rows in a chunk
+		int numThreads;
+		int chunkRows;
+
+		//Pipeline each chunk is run through by a single scoring thread, or 0 to run chunks with ForwardBatch
+		LayerPipeline *pipeline;
+
+		//Pool of chunks, those free to be read into and those read and waiting to be scored
+		vector<ScoreChunk> chunks;
+		deque<int> freeChunks;
+		deque<int> readChunks;
+
+		//Chunks scored and waiting to be written, at sequence % chunks.size(), else -1
+		vector<int> scoredChunks;
+
+		//Guards all of the above
+		mutex lock;
+		condition_variable changed;
+
+		//Set once the reader reaches the end of the input, with the amount of chunks read
+		bool endOfInput;
+		long long numRead;
+
+		//Message of an error found by the reader, or empty
+		string error;
+
+		//Block of text being parsed, and the part of it not yet parsed
+		vector<char> text;
+		size_t textStart;
+		size_t textEnd;
+
+		///<summary>
+		/// Loop run by the reader thread: fills free chunks from the file in turn
+		///</summary>
+		void ReadLoop (FILE *file, bool binary);
+
+		///<summary>
+		/// Reads a Resource-format text file, or a ResultWriter binary file, row by row into chunks
+		///</summary>
+		void ReadText (FILE *file);
+		void ReadBinary (FILE *file);
+
+		///<summary>
+		/// Parses the next number from a text file, reading more of it when needed.
+		/// Returns false at the end of the file, or if the next word is not a number (setting error)
+		///</summary>
+		bool NextValue (FILE *file, double &value);
+
+		///<summary>
+		/// Waits for a free chunk and returns its index
+		///</summary>
+		int TakeFreeChunk ();
+
+		///<summary>
+		/// Hands a filled chunk on to be scored
+		///</summary>
+		void ChunkRead (int chunk);
+
+		///<summary>
+		/// Loop run by each scoring thread: scales, runs and rescales chunks until none are left
+		///</summary>
+		void ScoreLoop ();
+
+		///<summary>
+		/// Rescales the outputs of a chunk that has been run, and hands it on to be written
+		///</summary>
+		void ChunkScored (int chunk);
+
+	public:
+
+		///<summary>
+		/// Constructor, makes the pool of chunks
+		///
+		///<argument="LinearLayerNetwork *net"> Trained network, which must not be changed while scoring</argument>
+		///<argument="const DataScaling &scaling"> Min/max of the training data, as loaded from a checkpoint</argument>
+		///<argument="int numThreads"> Amount of threads scoring at once</argument>
+		///<argument="int chunkRows"> Amount of rows in each chunk</argument>
+		///</summary>
+		BatchScorer (LinearLayerNetwork *net, const DataScaling &scaling, int numThreads, int chunkRows = 4096);
+
+		///<summary>
+		/// Scores every row of the input file
+		///
+		///<argument="const char *inputFile"> Path and filename of the rows to score</argument>
+		///<argument="const char *outputFile"> Path and filename the outputs are written to, one row per input row</argument>
+		///<argument="WriterFormat format"> Format of the output file</argument>
+		///
+		///<return="long long"> Amount of rows scored, or -1 if the files could not be used (see Error())</return>
+		///</summary>
+		long long Score (const char *inputFile, const char *outputFile, WriterFormat format = WRITER_TEXT);
+
+		///<summary>
+		/// Scores with one thread that streams each chunk through the stages of a pipeline of the same network,
+		/// each stage on a core of its own, instead of several threads each running whole chunks
+		///
+		///<argument="LayerPipeline *pipeline"> Pipeline, which must outlive its use, or 0 to score with threads again</argument>
+		///</summary>
+		void UsePipeline (LayerPipeline *pipeline);
+
+		///<summary>
+		/// Returns the reason the last Score() failed
+		///</summary>
+		const char * Error ();
+};
+
+#endif
@@ -0,0 +1,211 @@
+/*
+* 	Header-file for serving a trained network to other local processes over a Unix domain socket
+*/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "library.h"
+
+//Amount of latencies kept for the percentiles : the most recent are kept
+const int SERVER_LATENCY_SAMPLES = 65536;
+
+//Longest a reply may wait for room in a client's socket before the client is dropped, so one client
+//that stops reading cannot hold up the others
+const int SERVER_SEND_MILLISECONDS = 20;
+
+///<summary>
+/// Counters of a server, as returned by InferenceServer::GetStats
+///</summary>
+struct ServerStats {
+
+	//Requests answered and batches run so far
+	long long requests;
+	long long batches;
+
+	//Median and 99th percentile of the time from a request being read to its reply being sent, in microseconds
+	double p50;
+	double p99;
+
+	//Mean amount of requests in a batch
+	double meanBatch;
+
+	//Requests answered per second since the server started
+	double requestsPerSecond;
+};
+
+///<summary>
+/// A client connected to the server, and the request being read from it
+///</summary>
+struct ServerConnection {
+
+	//Socket of the client, or -1 once closed
+	int fd;
+
+	//Raw inputs of the request, and the bytes of it received so far
+	vector<double> request;
+	size_t received;
+
+	//True once the whole request is read and it waits in the batch
+	bool waiting;
+
+	//When the whole request was read
+	chrono::steady_clock::time_point arrived;
+};
+
+///<summary>
+/// Serves predictions of a network over a Unix domain socket.
+/// A request is the raw inputs of one row, as doubles in the units of the data set; the reply is the network's
+/// outputs rescaled into the units of the targets. Inputs and outputs are scaled with the min/max of the
+/// training data (see DataScaling), just as a data set read from file is scaled.
+/// Requests arriving together are gathered into one batch, until either the batch is full or the first
+/// request in it has waited for the latency budget, and the batch is run with a single ForwardBatch.
+/// One thread does all the work, waiting on every socket at once with ppoll
+///</summary>
+class InferenceServer {
+
+	protected:
+
+		//Network being served, and the min/max its data was scaled with
+		LinearLayerNetwork *net;
+		DataScaling scaling;
+
+		//Amount of inputs and outputs of one request
+		int numInputs;
+		int numOutputs;
+
+		//Path of the socket, and the socket accepting clients
+		string socketPath;
+		int listener;
+
+		//Largest batch, and longest a request waits for others to join its batch
+		int maxBatch;
+		chrono::microseconds budget;
+
+		//Buffers for a whole batch, made once
+		vector<double> batchInputs;
+		vector<double> batchOutputs;
+		vector<double> workspace;
+		vector<double> rawOutputs;
+
+		//Clients connected, and the indices of those whose requests are in the current batch
+		vector<ServerConnection> connections;
+		vector<int> pending;
+
+		//Latencies of the most recent requests, in microseconds, and how many have been recorded
+		vector<float> latencies;
+		long long numLatencies;
+		mutex statsLock;
+
+		//Requests answered and batches run
+		atomic<long long> requests;
+		atomic<long long> batches;
+		chrono::steady_clock::time_point started;
+
+		//Set while the serving thread should carry on
+		atomic<bool> running;
+		thread worker;
+
+		///<summary>
+		/// Loop run by the serving thread: accepts clients, reads requests and runs batches until stopped
+		///</summary>
+		void ServeLoop ();
+
+		///<summary>
+		/// Reads what has arrived from one client, adding its request to the batch once whole.
+		/// Returns false if the client has gone
+		///</summary>
+		bool ReadRequest (ServerConnection &connection);
+
+		///<summary>
+		/// Scales the pending requests, runs them through the network as one batch and sends each reply
+		///</summary>
+		void RunBatch ();
+
+	public:
+
+		///<summary>
+		/// Constructor, makes the buffers for the largest batch
+		///
+		///<argument="LinearLayerNetwork *net"> Trained network, which must not be changed while served</argument>
+		///<argument="const DataScaling &scaling"> Min/max of the training data, as loaded from a checkpoint</argument>
+		///<argument="const char *socketPath"> Path of the Unix domain socket</argument>
+		///<argument="int maxBatch"> Largest amount of requests in a batch</argument>
+		///<argument="int budgetMicroseconds"> Longest a request waits for others before its batch is run</argument>
+		///</summary>
+		InferenceServer (LinearLayerNetwork *net, const DataScaling &scaling, const char *socketPath, int maxBatch = 32, int budgetMicroseconds = 200);
+
+		///<summary>
+		/// Destructor, stops the server if running
+		///</summary>
+		~InferenceServer ();
+
+		///<summary>
+		/// Creates the socket and starts serving on a thread of its own
+		///
+		///<return="bool"> True if the socket could be created</return>
+		///</summary>
+		bool Start ();
+
+		///<summary>
+		/// Stops serving, closes every connection and removes the socket
+		///</summary>
+		void Stop ();
+
+		///<summary>
+		/// Returns the counters and latency percentiles so far; safe to call while serving
+		///</summary>
+		ServerStats GetStats ();
+
+		///<summary>
+		/// Prints the counters and latency percentiles so far
+		///</summary>
+		void PrintStats ();
+};
+
+///<summary>
+/// Connects to an InferenceServer and asks it for predictions, one at a time
+///</summary>
+class InferenceClient {
+
+	protected:
+
+		//Socket connected to the server, or -1
+		int fd;
+
+		int numInputs;
+		int numOutputs;
+
+	public:
+
+		///<summary>
+		/// Constructor, connects to the server
+		///
+		///<argument="const char *socketPath"> Path of the server's socket</argument>
+		///<argument="int numInputs"> Amount of inputs of the served network</argument>
+		///<argument="int numOutputs"> Amount of outputs of the served network</argument>
+		///</summary>
+		InferenceClient (const char *socketPath, int numInputs, int numOutputs);
+
+		///<summary>
+		/// Destructor, closes the connection
+		///</summary>
+		~InferenceClient ();
+
+		///<summary>
+		/// Returns true if connected
+		///</summary>
+		bool IsOpen ();
+
+		///<summary>
+		/// Sends one row of raw inputs and waits for the outputs
+		///
+		///<argument="const double rawInputs[]"> Inputs, in the units of the data set</argument>
+		///<argument="double rawOutputs[]"> Array onto which the outputs, in the units of the targets, are stored</argument>
+		///
+		///<return="bool"> True if a reply was received</return>
+		///</summary>
+		bool Predict (const double rawInputs[], double rawOutputs[]);
+};
+
+#endif
@@ -0,0 +1,102 @@
+/*
+* 	Header-file for data sets of wide, mostly zero inputs, stored as compressed sparse rows
+*/
+
+#ifndef SPARSE_H
+#define SPARSE_H
+
+#include "library.h"
+
+///<summary>
+/// Data set whose inputs are stored as compressed sparse rows (CSR): for each row only the columns and values
+/// of its non-zero inputs, in order of column. Targets and outputs are dense, as in dataset.
+/// Inputs are used as given, not scaled into 0.1..0.9, as scaling would make every zero non-zero
+///</summary>
+class SparseDataset {
+
+	protected:
+
+		int numInputs;
+		int numOutputs;
+		int numRows;
+
+		//Index in columns[] and values[] of the first non-zero of each row, and one past the last row
+		vector<int> rowStart;
+
+		//Column and value of each non-zero input, row after row
+		vector<int> columns;
+		vector<double> values;
+
+		//numOutputs targets, then numOutputs outputs, of each row
+		vector<double> targets;
+		vector<double> outputs;
+
+		//Name, as printed
+		string name;
+
+		///<summary>
+		/// Adds a row from its dense inputs and its targets, keeping only the non-zero inputs
+		///</summary>
+		void AddRow (const double inputs[], const double rowTargets[]);
+
+	public:
+
+		///<summary>
+		/// Constructor, reads a sparse text file: a line of "inputs outputs rows", then one line per row of its
+		/// targets followed by "column:value" for each non-zero input, columns counted from 0 and strictly increasing.
+		/// If the file cannot be read, or a row's columns are out of order or repeated, the set is empty, with numIns() 0
+		///
+		///<argument="const char *filename"> Name of the file</argument>
+		///<argument="const char *name"> Name of the set</argument>
+		///</summary>
+		SparseDataset (const char *filename, const char *name);
+
+		///<summary>
+		/// Constructor, from dense rows of inputs then targets, as the array constructor of dataset; zeros are dropped
+		///
+		///<argument="int numIns"> Amount of inputs</argument>
+		///<argument="int numOuts"> Amount of targets</argument>
+		///<argument="int numRows"> Amount of rows</argument>
+		///<argument="const double data[]"> Array containing numRows rows of numIns inputs then numOuts targets</argument>
+		///<argument="const char *name"> Name of the set</argument>
+		///</summary>
+		SparseDataset (int numIns, int numOuts, int numRows, const double data[], const char *name);
+
+		///<summary>
+		/// Returns the amount of non-zero inputs of row n, and the addresses of their columns and values
+		///</summary>
+		int RowNonZeros (int n);
+		const int * GetNthColumns (int n);
+		const double * GetNthValues (int n);
+
+		///<summary>
+		/// Returns the addresses of the targets and outputs of row n
+		///</summary>
+		double * GetNthTargets (int n);
+		double * GetNthOutputs (int n);
+
+		///<summary>
+		/// Copies the outputs of the network into row n
+		///</summary>
+		void SetNthOutputs (int n, const double rowOutputs[]);
+
+		///<summary>
+		/// Returns the sum over the outputs of the mean squared error, as dataset::TotalSSE
+		///</summary>
+		double TotalSSE ();
+
+		///<summary>
+		/// Returns the amount of non-zero inputs of all rows
+		///</summary>
+		long long NonZeros ();
+
+		///<summary>
+		/// Returns the amount of inputs, outputs and rows, and the name
+		///</summary>
+		int numIns ();
+		int numOuts ();
+		int numData ();
+		const char * Name ();
+};
+
+#endif
@@ -0,0 +1,197 @@
+/*
+* 	Header-file for reporting epochs of training from a background thread, so the trainer never waits on output
+*/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "library.h"
+
+//Values (one per output) a record holds, unless the telemetry is made for more; any more are left out and counted
+const int TELEMETRY_MAX_VALUES = 8;
+
+//Records the ring holds; a power of two
+const int TELEMETRY_RING_SIZE = 4096;
+
+///<summary>
+/// What the values of a record are
+///</summary>
+enum TelemetryKind {
+
+	TELEMETRY_TIMING,		//None: an epoch whose metrics were not found
+	TELEMETRY_SSE,			//Mean sum squared error of each output
+	TELEMETRY_CORRECT,		//% correct classifications of each output
+	TELEMETRY_VALIDATION	//{current, previous} average SSE of the validation set
+};
+
+///<summary>
+/// Where records are written
+///</summary>
+enum TelemetrySink {
+
+	SINK_CONSOLE,		//The lines classtest, numtest and testnet have always printed
+	SINK_CSV,			//<name>.epochs.csv : one line per record
+	SINK_JSON,			//<name>.epochs.jsonl : one JSON object per record
+	SINK_TRACE			//<name>.trace.json : Chrome trace, epochs as spans and values as counters
+};
+
+///<summary>
+/// One epoch as the trainer saw it. A plain block of fixed size, so pushing one is a copy; its values are copied
+/// to the ring's store beside it
+///</summary>
+struct TelemetryRecord {
+
+	TelemetryKind kind;
+	int epoch;
+
+	//Values, of which numValues are used : the ring's copy while in the ring, the writer's once popped
+	int numValues;
+	double *values;
+
+	//Seconds from the start of the telemetry to the start of the epoch, and taken by it
+	double start;
+	double seconds;
+
+	//Name of the data set, printed before the values on the console; 0 for none
+	const char *name;
+
+	//Hardware events of the epoch, as HardwareCounters::Summarise; all -1 if not counted
+	double events[COUNTER_SUMMARY];
+};
+
+///<summary>
+/// Ring of records passed from one thread to one other without locks: the trainer writes at head,
+/// the consumer reads at tail, and each only ever moves its own index
+///</summary>
+class TelemetryRing {
+
+	protected:
+
+		TelemetryRecord records[TELEMETRY_RING_SIZE];
+
+		//Values of each record, valuesPerRecord to a slot, so records stay of fixed size however many outputs there are
+		vector<double> store;
+		int valuesPerRecord;
+
+		//Records pushed and popped so far; each on a cache line of its own
+		alignas(64) atomic<size_t> head;
+		alignas(64) atomic<size_t> tail;
+
+	public:
+
+		///<summary>
+		/// Constructor, makes room for the given amount of values in every record
+		///</summary>
+		TelemetryRing (int valuesPerRecord);
+
+		///<summary>
+		/// Copies a record and values, of which it has numValues (at most valuesPerRecord), into the ring,
+		/// returning false, without waiting, if it is full
+		///</summary>
+		bool Push (const TelemetryRecord &record, const double values[]);
+
+		///<summary>
+		/// Copies the oldest record out of the ring, and its values to the given array of valuesPerRecord,
+		/// returning false if it is empty
+		///</summary>
+		bool Pop (TelemetryRecord &record, double values[]);
+};
+
+///<summary>
+/// Takes records of epochs from a trainer and formats and writes them on a thread of its own.
+/// Record() only copies into the ring; if the writer falls so far behind that the ring is full,
+/// the record is dropped and counted rather than holding up training
+///</summary>
+class Telemetry {
+
+	protected:
+
+		TelemetryRing ring;
+
+		TelemetrySink sink;
+		FILE *file;
+
+		//Writer thread, and the flag that tells it to finish once the ring is empty
+		thread writer;
+		atomic<bool> closing;
+
+		//Records dropped because the ring was full
+		atomic<long long> dropped;
+
+		//Most values a record holds, records that had more than that, and the writer's copy of the values being written
+		int maxValues;
+		atomic<long long> truncated;
+		vector<double> popped;
+
+		//Records written, so the trace knows whether a comma is due
+		long long written;
+
+		//Time the telemetry started, which record times are measured from
+		chrono::steady_clock::time_point started;
+
+		///<summary>
+		/// Loop run by the writer thread
+		///</summary>
+		void WriteLoop ();
+
+		///<summary>
+		/// Formats one record to the sink
+		///</summary>
+		void Write (TelemetryRecord &record);
+
+	public:
+
+		///<summary>
+		/// Constructor, opens the file of the sink and starts the writer
+		///
+		///<argument="TelemetrySink sink"> Where records are written</argument>
+		///<argument="const char *name"> Name the file is made from, as given for each sink; unused by the console</argument>
+		///<argument="int maxValues"> Most values a record holds, as the outputs of the network</argument>
+		///</summary>
+		Telemetry (TelemetrySink sink = SINK_CONSOLE, const char *name = "telemetry", int maxValues = TELEMETRY_MAX_VALUES);
+
+		///<summary>
+		/// Destructor, closes if not already closed
+		///</summary>
+		~Telemetry ();
+
+		///<summary>
+		/// Returns seconds since the telemetry started
+		///</summary>
+		double Now ();
+
+		///<summary>
+		/// Passes a record of an epoch to the writer
+		///
+		///<argument="TelemetryKind kind"> What the values are</argument>
+		///<argument="int epoch"> Epoch number</argument>
+		///<argument="const double values[]"> Array containing the values, or 0</argument>
+		///<argument="int numValues"> Amount of values</argument>
+		///<argument="double start"> Now() at the start of the epoch</argument>
+		///<argument="double seconds"> Seconds taken by the epoch</argument>
+		///<argument="const char *name"> Name of the data set, which must last until Close(); or 0</argument>
+		///<argument="HardwareCounters *events"> If given, the counters, stopped at the end of the epoch</argument>
+		///<argument="long long samples"> Rows presented in the epoch, which the misses are divided by</argument>
+		///
+		///<return="bool"> False if the ring was full and the record dropped; values past maxValues are left out and counted</return>
+		///</summary>
+		bool Record (TelemetryKind kind, int epoch, const double values[], int numValues, double start, double seconds,
+					 const char *name = 0, HardwareCounters *events = 0, long long samples = 0);
+
+		///<summary>
+		/// Waits for every record to be written, then closes the file. Called before printing anything else
+		///</summary>
+		void Close ();
+
+		///<summary>
+		/// Returns the amount of records dropped
+		///</summary>
+		long long Dropped ();
+
+		///<summary>
+		/// Returns the amount of records that had more values than they could hold
+		///</summary>
+		long long Truncated ();
+};
+
+#endif
@@ -0,0 +1,142 @@
+/*
+* 	Header-file for writing rows of results to file on a background thread
+*/
+
+#ifndef WRITER_H
+#define WRITER_H
+
+#include "library.h"
+
+///<summary>
+/// Formats a results file can be written in
+///</summary>
+enum WriterFormat {
+
+	//Tab-separated text, one row per line, as dataset::savedata has always written
+	WRITER_TEXT = 0,
+
+	//Header then rows of raw doubles
+	WRITER_BINARY = 1,
+
+	//Header then, for each chunk, its row count followed by each column's values in turn
+	WRITER_COLUMNAR = 2
+};
+
+///<summary>
+/// A block of rows to be written: the producer fills values row by row, then submits it
+///</summary>
+struct WriterChunk {
+
+	//Values of the rows, numColumns per row
+	double *values;
+
+	//Amount of rows filled
+	int rows;
+
+	//Maximum amount of rows
+	int capacity;
+};
+
+///<summary>
+/// Writes rows of doubles to a file. Chunks are filled by the caller and handed over;
+/// a background thread formats them into a large buffer and writes it, in the order submitted,
+/// while the caller goes on computing the next chunk.
+/// A fixed pool of chunks is used, so memory stays bounded however many rows are written
+///</summary>
+class ResultWriter {
+
+	protected:
+
+		//File being written
+		FILE *file;
+
+		//Amount of values in a row
+		int numColumns;
+
+		//Chosen format
+		WriterFormat format;
+
+		//Pool of chunks, and the indices of those free and those waiting to be written
+		vector<WriterChunk> chunks;
+		deque<int> freeChunks;
+		deque<int> fullChunks;
+
+		//Guards the two queues
+		mutex queueLock;
+		condition_variable chunkFreed;
+		condition_variable chunkFilled;
+
+		//Set when no more chunks will be submitted
+		bool closing;
+
+		//Buffer into which text is formatted before being written
+		char *text;
+		size_t textBytes;
+
+		//Amount of rows written so far
+		atomic<long long> rowsWritten;
+
+		//Background thread doing the formatting and writing
+		thread worker;
+
+		///<summary>
+		/// Loop run by the background thread: writes chunks until closed and none are left
+		///</summary>
+		void WriteLoop ();
+
+		///<summary>
+		/// Formats and writes one chunk in the chosen format
+		///</summary>
+		void WriteChunk (WriterChunk &chunk);
+
+	public:
+
+		///<summary>
+		/// Constructor, opens the file and starts the background thread
+		///
+		///<argument="const char *filename"> Path and filename to write to</argument>
+		///<argument="int numColumns"> Amount of values in each row</argument>
+		///<argument="WriterFormat format"> Format of the file</argument>
+		///<argument="int chunkRows"> Amount of rows in each chunk</argument>
+		///<argument="int numChunks"> Amount of chunks in the pool</argument>
+		///</summary>
+		ResultWriter (const char *filename, int numColumns, WriterFormat format = WRITER_TEXT, int chunkRows = 4096, int numChunks = 4);
+
+		///<summary>
+		/// Destructor, closes the file if not already done
+		///</summary>
+		~ResultWriter ();
+
+		///<summary>
+		/// Returns true if the file could be opened
+		///</summary>
+		bool IsOpen ();
+
+		///<summary>
+		/// Writes a line of text, such as the sizes of a data set, before any chunk.
+		/// Binary and columnar files instead start with their own fixed header
+		///</summary>
+		void WriteHeader (const char *line);
+
+		///<summary>
+		/// Returns an empty chunk, waiting only if every chunk is still being written
+		///</summary>
+		WriterChunk * GetChunk ();
+
+		///<summary>
+		/// Hands a filled chunk to the background thread
+		///</summary>
+		void Submit (WriterChunk *chunk);
+
+		///<summary>
+		/// Waits for all submitted chunks to be written, then closes the file
+		///</summary>
+		void Close ();
+
+		///<summary>
+		/// Returns the amount of rows written so far
+		///</summary>
+		long long RowsWritten ();
+};
+
+#endif
@@ -0,0 +1,103 @@
+/*
+*	Library Module Implementing the look-up of activations by layer type
+*/
+
+#ifndef ACTIVATION_CPP
+#define ACTIVATION_CPP
+
+#include "Header/library.h"
+
+
+void Softmax (double values[], int count)
+{
+	double largest = values[0];
+	for (int ct=1; ct < count; ct++) largest = max (largest, values[ct]);
+
+	double sum = 0;
+	for (int ct=0; ct < count; ct++)
+	{
+		values[ct] = exp (values[ct] - largest);
+		sum += values[ct];
+	}
+
+	//The largest gave exp(0) = 1, so sum is at least 1
+	double scale = 1 / sum;
+	for (int ct=0; ct < count; ct++) values[ct] *= scale;
+}
+
+
+bool IsHiddenActivation (char option)
+{
+	return option == TanhActivation::TYPE || option == ReluActivation::TYPE
+		|| option == LeakyReluActivation::TYPE || option == HardSigmoidActivation::TYPE;
+}
+
+
+///<summary>
+/// 'L' is linear, 'S' and 'M' sigmoidal, 'C' left for Softmax(), as in LayerType()
+///</summary>
+double ActivateSum (char layerType, double sum)
+{
+	switch (layerType)
+	{
+		case 'L':
+		case 'C': return sum;
+		case TanhActivation::TYPE: return TanhActivation::Apply (sum);
+		case ReluActivation::TYPE: return ReluActivation::Apply (sum);
+		case LeakyReluActivation::TYPE: return LeakyReluActivation::Apply (sum);
+		case HardSigmoidActivation::TYPE: return HardSigmoidActivation::Apply (sum);
+		default: return SigmoidActivation::Apply (sum);
+	}
+}
+
+
+void ActivateLayerValues (char layerType, double values[], int count, int rowLength)
+{
+	switch (layerType)
+	{
+		case 'L': break;
+		case 'C':
+			for (int row_start=0; row_start < count; row_start += rowLength)
+				Softmax (&values[row_start], rowLength);
+			break;
+		case TanhActivation::TYPE: ActivateValues<TanhActivation> (values, count); break;
+		case ReluActivation::TYPE: ActivateValues<ReluActivation> (values, count); break;
+		case LeakyReluActivation::TYPE: ActivateValues<LeakyReluActivation> (values, count); break;
+		case HardSigmoidActivation::TYPE: ActivateValues<HardSigmoidActivation> (values, count); break;
+		default: ActivateValues<SigmoidActivation> (values, count);
+	}
+}
+
+
+void LayerValueDeltas (char layerType, const double outputs[], const double errors[], double deltas[], int count)
+{
+	switch (layerType)
+	{
+		case 'L':
+		case 'C':
+			if (errors != deltas) dcopy (count, errors, deltas);
+			break;
+		case TanhActivation::TYPE: ActivationDeltas<TanhActivation> (outputs, errors, deltas, count); break;
+		case ReluActivation::TYPE: ActivationDeltas<ReluActivation> (outputs, errors, deltas, count); break;
+		case LeakyReluActivation::TYPE: ActivationDeltas<LeakyReluActivation> (outputs, errors, deltas, count); break;
+		case HardSigmoidActivation::TYPE: ActivationDeltas<HardSigmoidActivation> (outputs, errors, deltas, count); break;
+		default: ActivationDeltas<SigmoidActivation> (outputs, errors, deltas, count);
+	}
+}
+
+
+const char * ActivationName (char layerType)
+{
+	switch (layerType)
+	{
+		case 'L': return "linear";
+		case 'C': return "softmax";
+		case TanhActivation::TYPE: return TanhActivation::Name();
+		case ReluActivation::TYPE: return ReluActivation::Name();
+		case LeakyReluActivation::TYPE: return LeakyReluActivation::Name();
+		case HardSigmoidActivation::TYPE: return HardSigmoidActivation::Name();
+		default: return SigmoidActivation::Name();
+	}
+}
+
+#endif
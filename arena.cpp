@@ -0,0 +1,123 @@
+/*
+*	Library Module Implementing arenas of aligned memory
+*/
+
+#ifndef ARENA_CPP
+#define ARENA_CPP
+
+#include "Header/library.h"
+
+
+bool Arena::hugePagesByDefault = false;
+
+
+///<summary>
+/// Constructor. Large blocks asking for huge pages are first mapped from the huge page pool;
+/// if that is empty they fall back to the heap, aligned to a huge page and marked for transparent huge pages
+///</summary>
+Arena::Arena (size_t bytes, bool hugePages)
+{
+	capacity = Bytes (bytes > 0 ? bytes : 1, 1);
+	used = 0;
+	mapped = false;
+	block = 0;
+
+	bool huge = hugePages && (capacity >= ARENA_HUGE_PAGE);
+
+	if (huge)
+	{
+		//Whole huge pages only
+		capacity = (capacity + ARENA_HUGE_PAGE - 1) / ARENA_HUGE_PAGE * ARENA_HUGE_PAGE;
+
+		void *pages = mmap (0, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+		if (pages != MAP_FAILED)
+		{
+			block = (char *) pages;
+			mapped = true;
+		}
+	}
+
+	if (block == 0)
+	{
+		void *heap = 0;
+
+		if (posix_memalign (&heap, huge ? ARENA_HUGE_PAGE : ARENA_ALIGN, capacity) != 0) heap = 0;
+		block = (char *) heap;
+
+		if (huge && block != 0) madvise (block, capacity, MADV_HUGEPAGE);
+	}
+
+	//Mapped pages are already zero
+	if (block != 0 && !mapped) memset (block, 0, capacity);
+	if (block == 0) capacity = 0;
+}
+
+
+Arena::~Arena ()
+{
+	if (mapped) munmap (block, capacity);
+	else free (block);
+}
+
+
+///<summary>
+/// Sizes too large to be held in a size_t end the program, rather than wrapping round to a small arena
+///</summary>
+size_t Arena::Bytes (size_t count, size_t itemSize)
+{
+	if (itemSize > 0 && count > ((size_t) -1 - ARENA_ALIGN) / itemSize)
+	{
+		cerr << "Arena [!] Size of " << count << " items of " << itemSize << " bytes is too large" << endl;
+		abort ();
+	}
+
+	return (count * itemSize + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+}
+
+
+void Arena::SetHugePages (bool useHugePages)
+{
+	hugePagesByDefault = useHugePages;
+}
+
+
+double * Arena::Doubles (size_t count)
+{
+	return (double *) Chars (Bytes (count));
+}
+
+
+///<summary>
+/// Hands out the next aligned count chars. An arena too small, as the sizes were added up wrongly, or whose
+/// block could not be allocated, ends the program : no caller could go on without the array
+///</summary>
+char * Arena::Chars (size_t count)
+{
+	size_t bytes = Bytes (count, 1);
+
+	if (bytes > capacity - used)
+	{
+		cerr << "Arena [!] " << bytes << " bytes asked for, but " << capacity - used << " of " << capacity << " are left" << endl;
+		abort ();
+	}
+
+	char *start = block + used;
+	used += bytes;
+
+	return start;
+}
+
+
+size_t Arena::Capacity ()
+{
+	return capacity;
+}
+
+
+size_t Arena::Used ()
+{
+	return used;
+}
+
+#endif
@@ -0,0 +1,1322 @@
+/*
+* 	BENCHMARKS of the layers, data sets and training
+*
+* 	Times the per-layer functions, the unrolled kernels of tiny layers against the loops of any size,
+* 	whole passes of networks from XOR-sized to 1024 wide and up to five layers deep,
+* 	the blocked matrix multiply against the peak of a core and against plain loops, mini-batch training, each hidden activation,
+* 	sparse against dense inputs, pruned networks as sparse weights, loading and writing of each file format, metrics,
+* 	and the threaded paths over a range of threads: rows of data sets split between threads, wide layers split across a pool,
+* 	and the layers of a deep network pipelined across cores.
+* 	Every batched or threaded path is also checked against the outputs of ComputeNetwork, the scalar reference.
+* 	Results are written as one JSON object.
+*
+* 	Built on its own, as main.cpp is:  g++ -std=c++17 -O2 -pthread benchmark.cpp -o benchmark
+* 	Run as:  benchmark [--quick] [--output file]
+*/
+
+#include "Header/library.h"
+
+
+//Largest difference from the reference outputs accepted as agreeing
+const double BENCHMARK_TOLERANCE = 1e-9;
+
+
+///<summary>
+/// Writes the results as a JSON object holding an array of results, one object per measurement
+///</summary>
+class BenchmarkResults {
+
+	protected:
+
+		FILE *out;
+
+		//Amount of results written
+		int numResults;
+
+		//Amount of agreement checks that failed
+		int numFailed;
+
+	public:
+
+		BenchmarkResults (FILE *file) : out(file), numResults(0), numFailed(0)
+		{
+			fprintf (out, "{\"benchmark\":\"ann\",\"cores\":%u,\"tolerance\":", thread::hardware_concurrency());
+			WriteJsonNumber (out, BENCHMARK_TOLERANCE);
+			fprintf (out, ",\"results\":[\n");
+		}
+
+		///<summary>
+		/// Starts a result of the given group and name
+		///</summary>
+		void Begin (const char *group, const char *name)
+		{
+			fprintf (out, "%s{\"group\":\"%s\",\"name\":\"%s\"", (numResults++ > 0) ? ",\n" : "", group, name);
+		}
+
+		void Field (const char *name, double value)
+		{
+			fprintf (out, ",\"%s\":", name);
+			WriteJsonNumber (out, value);
+		}
+
+		void Field (const char *name, const string &value)
+		{
+			fprintf (out, ",\"%s\":", name);
+			WriteJsonString (out, value);
+		}
+
+		///<summary>
+		/// Adds the largest difference from the reference, and whether it is within the tolerance
+		///</summary>
+		void Agreement (double maxDifference)
+		{
+			bool agrees = maxDifference <= BENCHMARK_TOLERANCE;
+			if (!agrees) numFailed++;
+
+			Field ("max_difference", maxDifference);
+			fprintf (out, ",\"agrees\":%s", agrees ? "true" : "false");
+		}
+
+		void End ()
+		{
+			fprintf (out, "}");
+			fflush (out);
+		}
+
+		///<summary>
+		/// Closes the array and object, returning the amount of failed agreement checks
+		///</summary>
+		int Finish (double seconds)
+		{
+			fprintf (out, "\n],\"failed\":%d,\"seconds\":", numFailed);
+			WriteJsonNumber (out, seconds);
+			fprintf (out, "}\n");
+			fflush (out);
+
+			return numFailed;
+		}
+};
+
+
+///<summary>
+/// Calls f repeatedly until at least minSeconds have passed, doubling the calls timed each time,
+/// and returns the seconds per call of the last timing
+///</summary>
+template <class Function> double SecondsPerCall (Function f, double minSeconds)
+{
+	for (long long calls = 1; ; calls *= 2)
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+		for (long long call=0; call < calls; call++) f();
+
+		double seconds = chrono::duration<double> (chrono::steady_clock::now() - start).count();
+
+		if (seconds >= minSeconds) return seconds / calls;
+	}
+}
+
+
+///<summary>
+/// Fills a data set of random rows: inputs in 0.1..0.9 as scaled data are, and targets of 0.1 or 0.9
+///</summary>
+dataset * MakeData (int numIns, int numOuts, int numRows)
+{
+	vector<double> rows ((size_t) numRows * (numIns + numOuts));
+
+	for (size_t ct=0; ct < rows.size(); ct++)
+	{
+		bool isTarget = (ct % (numIns + numOuts)) >= (size_t) numIns;
+		rows[ct] = isTarget ? (ThreadRandom().Below (2) ? 0.9 : 0.1) : 0.5 + 0.4 * myrand();
+	}
+
+	return new dataset (numIns, numOuts, numRows, &rows[0], "Benchmark_set");
+}
+
+
+///<summary>
+/// Returns the largest difference between the outputs stored in a data set and those given, row by row
+///</summary>
+double MaxDifference (dataset &data, const double outputs[])
+{
+	double largest = 0;
+
+	for (int row=0; row < data.numData(); row++)
+		for (int ct=0; ct < data.numOuts(); ct++)
+			largest = max (largest, fabs (data.GetNthOutputs(row)[ct] - outputs[(size_t) row * data.numOuts() + ct]));
+
+	return largest;
+}
+
+
+///<summary>
+/// Times the protected per-layer functions, to which it is granted access by LinearLayerNetwork
+///</summary>
+class LayerBenchmark {
+
+	public:
+
+		static void Run (BenchmarkResults &results, double minSeconds)
+		{
+			const int sizes[][2] = { {2, 2}, {4, 10}, {16, 16}, {64, 64}, {256, 256}, {1024, 1024} };
+			const double learningParameters[] = { 1e-6, 0.5 };
+
+			for (int s=0; s < 6; s++)
+			{
+				int numIns = sizes[s][0], numOuts = sizes[s][1];
+
+				//Called through the base class, whose protected members are open to this one
+				SigmoidalLayerNetwork sigmoidal (numIns, numOuts);
+				LinearLayerNetwork &layer = sigmoidal;
+
+				vector<double> inputs (numIns), errors (numOuts), previousErrors (numIns);
+				for (int ct=0; ct < numIns; ct++) inputs[ct] = 0.5 + 0.4 * myrand();
+				for (int ct=0; ct < numOuts; ct++) errors[ct] = 0.1 * myrand();
+
+				layer.CalcOutputs (&inputs[0]);
+				layer.FindDeltas (&errors[0]);
+
+				//Each is a multiply and an add per weight
+				double flops = 2.0 * (numIns + 1) * numOuts;
+
+				double seconds[3];
+				seconds[0] = SecondsPerCall ([&] () { layer.CalcOutputs (&inputs[0]); }, minSeconds);
+				seconds[1] = SecondsPerCall ([&] () { layer.ChangeAllWeights (&inputs[0], learningParameters); }, minSeconds);
+				seconds[2] = SecondsPerCall ([&] () { layer.PrevLayersErrors (&previousErrors[0]); }, minSeconds);
+
+				const char *names[] = { "CalcOutputs", "ChangeAllWeights", "PrevLayersErrors" };
+
+				for (int f=0; f < 3; f++)
+				{
+					results.Begin ("layer", names[f]);
+					results.Field ("inputs", numIns);
+					results.Field ("neurons", numOuts);
+					results.Field ("kernel", string(layer.KernelName()));
+					results.Field ("ns_per_call", seconds[f] * 1e9);
+					results.Field ("gflops", flops / seconds[f] / 1e9);
+					results.End();
+				}
+			}
+		}
+
+		///<summary>
+		/// Times the kernels of tiny layers (kernels.h) against the loops of any size, on two layers of the same
+		/// weights, one with its kernels taken away, and checks each pair gives the same outputs, errors and weights
+		///</summary>
+		static void RunKernels (BenchmarkResults &results, double minSeconds)
+		{
+			const int sizes[][2] = { {2, 2}, {2, 4}, {4, 10}, {10, 1} };
+			const double learningParameters[] = { 1e-6, 0.5 };
+
+			for (int s=0; s < 4; s++)
+			{
+				int numIns = sizes[s][0], numOuts = sizes[s][1];
+
+				SigmoidalLayerNetwork specialized (numIns, numOuts), generic (numIns, numOuts);
+				LinearLayerNetwork *layers[] = { &specialized, &generic };
+
+				vector<double> initialWeights (specialized.HowManyWeights());
+				specialized.ReturnTheWeights (&initialWeights[0]);
+				generic.SetTheWeights (&initialWeights[0]);
+				layers[1]->kernels = 0;
+
+				vector<double> inputs (numIns), errors (numOuts);
+				for (int ct=0; ct < numIns; ct++) inputs[ct] = 0.5 + 0.4 * myrand();
+				for (int ct=0; ct < numOuts; ct++) errors[ct] = 0.1 * myrand();
+
+				//One step of each, whose results are compared before the timing changes the weights further
+				vector<double> previousErrors[2], newWeights[2];
+
+				for (int k=0; k < 2; k++)
+				{
+					previousErrors[k].resize (numIns);
+					newWeights[k].resize (initialWeights.size());
+
+					layers[k]->CalcOutputs (&inputs[0]);
+					layers[k]->FindDeltas (&errors[0]);
+					layers[k]->PrevLayersErrors (&previousErrors[k][0]);
+					layers[k]->ChangeAllWeights (&inputs[0], learningParameters);
+					layers[k]->ReturnTheWeights (&newWeights[k][0]);
+				}
+
+				double difference = 0;
+				for (int ct=0; ct < numOuts; ct++) difference = max (difference, fabs (specialized.outputs[ct] - generic.outputs[ct]));
+				for (int ct=0; ct < numIns; ct++) difference = max (difference, fabs (previousErrors[0][ct] - previousErrors[1][ct]));
+				for (size_t ct=0; ct < initialWeights.size(); ct++) difference = max (difference, fabs (newWeights[0][ct] - newWeights[1][ct]));
+
+				const char *names[] = { "CalcOutputs", "ChangeAllWeights", "PrevLayersErrors" };
+
+				for (int k=0; k < 2; k++)
+				{
+					LinearLayerNetwork &layer = *layers[k];
+					double seconds[3];
+
+					seconds[0] = SecondsPerCall ([&] () { layer.CalcOutputs (&inputs[0]); }, minSeconds);
+					seconds[1] = SecondsPerCall ([&] () { layer.ChangeAllWeights (&inputs[0], learningParameters); }, minSeconds);
+					seconds[2] = SecondsPerCall ([&] () { layer.PrevLayersErrors (&previousErrors[k][0]); }, minSeconds);
+
+					for (int f=0; f < 3; f++)
+					{
+						results.Begin ("kernels", names[f]);
+						results.Field ("inputs", numIns);
+						results.Field ("neurons", numOuts);
+						results.Field ("kernel", string(layer.KernelName()));
+						results.Field ("ns_per_call", seconds[f] * 1e9);
+						if (k == 0) results.Agreement (difference);
+						results.End();
+					}
+				}
+			}
+		}
+
+		///<summary>
+		/// Times the batched sums, errors and gradients of a 1024 x 1024 layer, which multiply by Gemm, against the
+		/// per-row functions they replace, checking each against them
+		///</summary>
+		static void RunBatched (BenchmarkResults &results, double minSeconds, double peak, bool quick)
+		{
+			const int numIns = 1024, numOuts = 1024, numRows = quick ? 64 : 256;
+
+			LinearLayerNetwork layer (numIns, numOuts);
+
+			vector<double> inputs ((size_t) numRows * numIns), batchDeltas ((size_t) numRows * numOuts);
+			for (size_t ct=0; ct < inputs.size(); ct++) inputs[ct] = 0.5 + 0.4 * myrand();
+			for (size_t ct=0; ct < batchDeltas.size(); ct++) batchDeltas[ct] = 0.1 * myrand();
+
+			vector<double> sums ((size_t) numRows * numOuts), errors ((size_t) numRows * numIns);
+			vector<double> gradient ((size_t) (numIns + 1) * numOuts), reference ((size_t) (numIns + 1) * numOuts);
+
+			//Per-row references: the sums of CalcOutputs, the errors of PrevLayersErrors, and a plain sum of the gradients
+			vector<double> rowErrors (numIns);
+			double sumsDifference = 0, errorsDifference = 0, gradientDifference = 0;
+
+			LinearLayerNetwork::BatchSums (layer.weights, numIns, numOuts, &inputs[0], numRows, &sums[0]);
+			LinearLayerNetwork::BatchErrors (layer.weights, numIns, numOuts, &batchDeltas[0], numRows, &errors[0]);
+			LinearLayerNetwork::BatchGradient (&batchDeltas[0], &inputs[0], numIns, numOuts, numRows, &gradient[0]);
+
+			for (int row=0; row < numRows; row++)
+			{
+				layer.CalcOutputs (&inputs[(size_t) row * numIns]);
+				for (int ct=0; ct < numOuts; ct++) sumsDifference = max (sumsDifference, fabs (layer.outputs[ct] - sums[(size_t) row * numOuts + ct]));
+
+				layer.FindDeltas (&batchDeltas[(size_t) row * numOuts]);
+				layer.PrevLayersErrors (&rowErrors[0]);
+				for (int ct=0; ct < numIns; ct++) errorsDifference = max (errorsDifference, fabs (rowErrors[ct] - errors[(size_t) row * numIns + ct]));
+
+				for (int neuron=0; neuron < numOuts; neuron++)
+				{
+					double delta = batchDeltas[(size_t) row * numOuts + neuron];
+
+					reference[(size_t) neuron * (numIns + 1)] += delta;
+					for (int ct=0; ct < numIns; ct++) reference[(size_t) neuron * (numIns + 1) + ct + 1] += delta * inputs[(size_t) row * numIns + ct];
+				}
+			}
+
+			for (size_t ct=0; ct < gradient.size(); ct++) gradientDifference = max (gradientDifference, fabs (gradient[ct] - reference[ct]));
+
+			const double learningParameters[] = { 1e-6, 0.5 };
+
+			double seconds[6];
+			seconds[0] = SecondsPerCall ([&] () { LinearLayerNetwork::BatchSums (layer.weights, numIns, numOuts, &inputs[0], numRows, &sums[0]); }, minSeconds);
+			seconds[1] = SecondsPerCall ([&] () { for (int row=0; row < numRows; row++) layer.CalcOutputs (&inputs[(size_t) row * numIns]); }, minSeconds);
+			seconds[2] = SecondsPerCall ([&] () { LinearLayerNetwork::BatchErrors (layer.weights, numIns, numOuts, &batchDeltas[0], numRows, &errors[0]); }, minSeconds);
+			seconds[3] = SecondsPerCall ([&] () { for (int row=0; row < numRows; row++) layer.PrevLayersErrors (&rowErrors[0]); }, minSeconds);
+			seconds[4] = SecondsPerCall ([&] () { LinearLayerNetwork::BatchGradient (&batchDeltas[0], &inputs[0], numIns, numOuts, numRows, &gradient[0]); }, minSeconds);
+			seconds[5] = SecondsPerCall ([&] () { for (int row=0; row < numRows; row++) layer.ChangeAllWeights (&inputs[(size_t) row * numIns], learningParameters); }, minSeconds);
+
+			const char *names[] = { "BatchSums", "CalcOutputs", "BatchErrors", "PrevLayersErrors", "BatchGradient", "ChangeAllWeights" };
+			double differences[] = { sumsDifference, errorsDifference, gradientDifference };
+
+			for (int f=0; f < 6; f++)
+			{
+				double gflops = 2.0 * numIns * numOuts * numRows / seconds[f] / 1e9;
+
+				results.Begin ("gemm", names[f]);
+				results.Field ("inputs", numIns);
+				results.Field ("neurons", numOuts);
+				results.Field ("rows", numRows);
+				results.Field ("gflops", gflops);
+				results.Field ("fraction_of_peak", gflops / peak);
+				if (f % 2 == 0) results.Agreement (differences[f / 2]);
+				results.End();
+			}
+		}
+};
+
+
+///<summary>
+/// Times ComputeNetwork and AdaptNetwork of multi-layer networks over a range of sizes and rows,
+/// and checks ForwardBatch against ComputeNetwork
+///</summary>
+void BenchmarkNetworks (BenchmarkResults &results, double minSeconds, bool quick)
+{
+	//{inputs, hidden, outputs}
+	const int topologies[][3] = { {2, 2, 1}, {4, 10, 1}, {16, 64, 4}, {64, 256, 8}, {256, 1024, 16}, {1024, 1024, 16} };
+	const int rowCounts[] = { 256, 4096, 65536 };
+	const double learningParameters[] = { 0.01, 0.5 };
+
+	for (int t=0; t < 6; t++)
+	{
+		int numIns = topologies[t][0], hidden = topologies[t][1], numOuts = topologies[t][2];
+		double weights = (double) (numIns + 1) * hidden + (double) (hidden + 1) * numOuts;
+
+		for (int r=0; r < 3; r++)
+		{
+			//Passes over more than about 3e8 weights are skipped, as are larger data sets when quick
+			if (weights * rowCounts[r] > 3e8 || (quick && r > 1)) continue;
+
+			dataset *data = MakeData (numIns, numOuts, rowCounts[r]);
+			LinearLayerNetwork *net = MakeNet ('N', numIns, hidden, numOuts);
+
+			double compute = SecondsPerCall ([&] () { net->ComputeNetwork (*data); }, minSeconds);
+			double adapt = SecondsPerCall ([&] () { net->AdaptNetwork (*data, learningParameters); }, minSeconds);
+
+			//Reference outputs, then the batched pass over the same rows
+			net->ComputeNetwork (*data);
+
+			vector<double> inputs ((size_t) data->numData() * numIns), outputs ((size_t) data->numData() * numOuts);
+			vector<double> workspace (net->BatchWorkspace (data->numData()) + 1);
+
+			for (int row=0; row < data->numData(); row++) dcopy (numIns, data->GetNthInputs(row), &inputs[(size_t) row * numIns]);
+
+			double batch = SecondsPerCall ([&] () { net->ForwardBatch (&inputs[0], data->numData(), &outputs[0], &workspace[0]); }, minSeconds);
+
+			char name[32];
+			sprintf (name, "%d-%d-%d", numIns, hidden, numOuts);
+
+			const char *passes[] = { "ComputeNetwork", "AdaptNetwork", "ForwardBatch" };
+			double seconds[] = { compute, adapt, batch };
+
+			for (int p=0; p < 3; p++)
+			{
+				results.Begin ("network", passes[p]);
+				results.Field ("topology", string(name));
+				results.Field ("rows", data->numData());
+				results.Field ("samples_per_second", data->numData() / seconds[p]);
+				results.Field ("gflops", (p == 1 ? 6 : 2) * weights * data->numData() / seconds[p] / 1e9);
+				if (p == 2) results.Agreement (MaxDifference (*data, &outputs[0]));
+				results.End();
+			}
+
+			delete net;
+			delete data;
+		}
+	}
+}
+
+
+///<summary>
+/// Times DeepNetwork against MultiLayerNetwork of the same two layers, checking the weights after a pass of learning
+/// from the same start, then times deeper networks, checking ForwardBatch against ComputeNetwork
+///</summary>
+void BenchmarkDeep (BenchmarkResults &results, double minSeconds, bool quick)
+{
+	const char *shapes[] = { "256M,8S", "256M,256M,8S", "256M,256M,256M,256M,8S", "256R,256R,256R,256R,8S" };
+	const int numIns = 64, numRows = quick ? 1024 : 4096;
+	const double learningParameters[] = { 0.01, 0.5 };
+
+	dataset *data = MakeData (numIns, 8, numRows);
+
+	vector<double> inputs ((size_t) numRows * numIns), outputs ((size_t) numRows * 8);
+	for (int row=0; row < numRows; row++) dcopy (numIns, data->GetNthInputs(row), &inputs[(size_t) row * numIns]);
+
+	for (int s=0; s < 4; s++)
+	{
+		vector<LayerSpec> specs;
+		ParseLayers (shapes[s], specs);
+
+		LinearLayerNetwork *net = MakeDeepNet (numIns, specs);
+		double weights = net->HowManyWeights();
+
+		//The same two layers as a MultiLayerNetwork, from the same weights
+		if (s == 0)
+		{
+			LinearLayerNetwork *multi = MakeNet ('N', numIns, 256, 8);
+
+			vector<double> start (net->HowManyWeights()), multiWeights (net->HowManyWeights()), deepWeights (net->HowManyWeights());
+			net->ReturnTheWeights (&start[0]);
+			multi->SetTheWeights (&start[0]);
+
+			multi->AdaptNetwork (*data, learningParameters);
+			net->AdaptNetwork (*data, learningParameters);
+
+			multi->ReturnTheWeights (&multiWeights[0]);
+			net->ReturnTheWeights (&deepWeights[0]);
+
+			double difference = 0;
+			for (size_t ct=0; ct < start.size(); ct++) difference = max (difference, fabs (multiWeights[ct] - deepWeights[ct]));
+
+			double adapt = SecondsPerCall ([&] () { multi->AdaptNetwork (*data, learningParameters); }, minSeconds);
+
+			results.Begin ("deep", "MultiLayerNetwork");
+			results.Field ("topology", string("64-256-8"));
+			results.Field ("rows", numRows);
+			results.Field ("samples_per_second", numRows / adapt);
+			results.Field ("gflops", 6 * weights * numRows / adapt / 1e9);
+			results.Agreement (difference);
+			results.End();
+
+			delete multi;
+		}
+
+		double compute = SecondsPerCall ([&] () { net->ComputeNetwork (*data); }, minSeconds);
+		double adapt = SecondsPerCall ([&] () { net->AdaptNetwork (*data, learningParameters); }, minSeconds);
+
+		net->ComputeNetwork (*data);
+
+		vector<double> workspace (net->BatchWorkspace (numRows) + 1);
+		double batch = SecondsPerCall ([&] () { net->ForwardBatch (&inputs[0], numRows, &outputs[0], &workspace[0]); }, minSeconds);
+
+		string topology = "64";
+		for (size_t l=0; l < specs.size(); l++) topology += "-" + to_string (specs[l].numNeurons);
+
+		const char *passes[] = { "ComputeNetwork", "AdaptNetwork", "ForwardBatch" };
+		double seconds[] = { compute, adapt, batch };
+
+		for (int p=0; p < 3; p++)
+		{
+			results.Begin ("deep", passes[p]);
+			results.Field ("topology", topology);
+			results.Field ("activation", string(ActivationName (net->LayerType())));
+			results.Field ("rows", numRows);
+			results.Field ("samples_per_second", numRows / seconds[p]);
+			results.Field ("gflops", (p == 1 ? 6 : 2) * weights * numRows / seconds[p] / 1e9);
+			if (p == 2) results.Agreement (MaxDifference (*data, &outputs[0]));
+			results.End();
+		}
+
+		delete net;
+	}
+
+	delete data;
+}
+
+
+///<summary>
+/// Returns the GFLOP/s of independent multiply-adds of pairs of doubles held in registers, the instructions
+/// of Gemm's micro-kernel, as the peak a multiply of this build could reach on one core. The best of a few
+/// timings is taken, as anything else running only ever makes a timing slower
+///</summary>
+double MeasurePeakGflops (double minSeconds)
+{
+	const int chains = 12, steps = 1000;
+
+	GemmPair sums[chains], scale = { 0.999999, 0.999999 }, step = { 1e-6, 1e-6 };
+	for (int c=0; c < chains; c++) sums[c] = step * (double) c;
+
+	double best = 0;
+
+	for (int timing=0; timing < 5; timing++)
+	{
+		double seconds = SecondsPerCall ([&] () {
+
+			//Copied in and out, so the chains are kept in registers
+			GemmPair chain[chains];
+			for (int c=0; c < chains; c++) chain[c] = sums[c];
+
+			for (int s=0; s < steps; s++)
+			{
+				#pragma GCC unroll 16
+				for (int c=0; c < chains; c++) chain[c] = chain[c] * scale + step;
+			}
+
+			for (int c=0; c < chains; c++) sums[c] = chain[c];
+
+		}, minSeconds);
+
+		best = max (best, 4.0 * chains * steps / seconds / 1e9);
+	}
+
+	//Keeps the sums from being optimised away
+	volatile double sink = 0;
+	for (int c=0; c < chains; c++) sink = sink + sums[c][0] + sums[c][1];
+
+	return best;
+}
+
+
+///<summary>
+/// Reports the peak, then times Gemm against a plain triple loop for square matrices of each transpose the layers use,
+/// the batched functions of a wide layer against the per-row ones, and AdaptBatch against AdaptRows
+///</summary>
+void BenchmarkGemm (BenchmarkResults &results, double minSeconds, bool quick)
+{
+	double peak = MeasurePeakGflops (minSeconds);
+
+	results.Begin ("gemm", "peak");
+	results.Field ("gflops", peak);
+	results.End();
+
+	const int sizes[] = { 128, 256, 512, 1024 };
+
+	for (int s=0; s < (quick ? 3 : 4); s++)
+	{
+		int n = sizes[s];
+
+		vector<double> A ((size_t) n * n), B ((size_t) n * n), C ((size_t) n * n), plain ((size_t) n * n);
+		for (size_t ct=0; ct < A.size(); ct++) { A[ct] = myrand(); B[ct] = myrand(); }
+
+		//Forward sums (B transposed), errors (neither) and gradients (A transposed)
+		const bool transposes[][2] = { {false, true}, {false, false}, {true, false} };
+		const char *names[] = { "NT", "NN", "TN" };
+
+		for (int t=0; t < 3; t++)
+		{
+			bool transA = transposes[t][0], transB = transposes[t][1];
+
+			auto multiply = [&] () {
+
+				fill (C.begin(), C.end(), 0.0);
+				Gemm (transA, transB, n, n, n, &A[0], n, &B[0], n, &C[0], n);
+			};
+
+			auto loop = [&] () {
+
+				for (int i=0; i < n; i++)
+					for (int j=0; j < n; j++)
+					{
+						double sum = 0;
+
+						for (int p=0; p < n; p++)
+							sum += (transA ? A[(size_t) p * n + i] : A[(size_t) i * n + p]) * (transB ? B[(size_t) j * n + p] : B[(size_t) p * n + j]);
+
+						plain[(size_t) i * n + j] = sum;
+					}
+			};
+
+			multiply();
+			loop();
+
+			double difference = 0;
+			for (size_t ct=0; ct < C.size(); ct++) difference = max (difference, fabs (C[ct] - plain[ct]));
+
+			double seconds[] = { SecondsPerCall (multiply, minSeconds), SecondsPerCall (loop, minSeconds) };
+
+			for (int f=0; f < 2; f++)
+			{
+				double gflops = 2.0 * n * n * n / seconds[f] / 1e9;
+
+				results.Begin ("gemm", f == 0 ? "Gemm" : "loop");
+				results.Field ("size", n);
+				results.Field ("transpose", string(names[t]));
+				results.Field ("gflops", gflops);
+				results.Field ("fraction_of_peak", gflops / peak);
+				if (f == 0) results.Agreement (difference);
+				results.End();
+			}
+		}
+	}
+
+	LayerBenchmark::RunBatched (results, minSeconds, peak, quick);
+
+	//Training a network of wide layers, a row at a time and in batches, each from the same weights
+	vector<LayerSpec> specs;
+	ParseLayers ("512R,512R,16S", specs);
+
+	const int numIns = 256, numRows = quick ? 256 : 1024;
+	const double learningParameters[] = { 0.01, 0.5 };
+
+	dataset *data = MakeData (numIns, 16, numRows);
+	vector<int> rows (numRows);
+	for (int row=0; row < numRows; row++) rows[row] = row;
+
+	LinearLayerNetwork *net = MakeDeepNet (numIns, specs);
+	LinearLayerNetwork *batched = MakeDeepNet (numIns, specs);
+	double weights = net->HowManyWeights();
+
+	vector<double> start (net->HowManyWeights()), first (net->HowManyWeights()), second (net->HowManyWeights());
+	net->ReturnTheWeights (&start[0]);
+	batched->SetTheWeights (&start[0]);
+
+	//A batch of one changes the weights as AdaptRows does
+	net->AdaptRows (*data, &rows[0], numRows, learningParameters);
+	batched->AdaptBatch (*data, &rows[0], numRows, 1, learningParameters);
+
+	net->ReturnTheWeights (&first[0]);
+	batched->ReturnTheWeights (&second[0]);
+
+	double difference = 0;
+	for (size_t ct=0; ct < start.size(); ct++) difference = max (difference, fabs (first[ct] - second[ct]));
+
+	const int batchSizes[] = { 0, 1, 16, 64, 256 };
+
+	for (int b=0; b < 5; b++)
+	{
+		double seconds = (batchSizes[b] == 0)
+			? SecondsPerCall ([&] () { net->AdaptRows (*data, &rows[0], numRows, learningParameters); }, minSeconds)
+			: SecondsPerCall ([&] () { batched->AdaptBatch (*data, &rows[0], numRows, batchSizes[b], learningParameters); }, minSeconds);
+
+		results.Begin ("gemm", batchSizes[b] == 0 ? "AdaptRows" : "AdaptBatch");
+		results.Field ("topology", string("256-512-512-16"));
+		results.Field ("rows", numRows);
+		results.Field ("batch", max (1, batchSizes[b]));
+		results.Field ("samples_per_second", numRows / seconds);
+		results.Field ("gflops", 6 * weights * numRows / seconds / 1e9);
+		if (batchSizes[b] == 1) results.Agreement (difference);
+		results.End();
+	}
+
+	delete batched;
+	delete net;
+	delete data;
+}
+
+
+///<summary>
+/// For each hidden activation, times an epoch of AdaptNetwork and counts the epochs taken to reach a target SSE
+/// on the iris training set, from the same seed; 0 epochs if not reached. Skipped if the set is not found
+///</summary>
+void BenchmarkActivations (BenchmarkResults &results, double minSeconds, bool quick)
+{
+	const char options[] = { 'N', TanhActivation::TYPE, ReluActivation::TYPE, LeakyReluActivation::TYPE, HardSigmoidActivation::TYPE };
+	const double learningParameters[] = { 0.2, 0.5 };
+	const double targetSSE = 0.005;
+	const int hidden = 10, maxEpochs = quick ? 2000 : 20000;
+
+	dataset train ("Resource/iristrain.txt", "Training_set");
+	if (train.numIns() == 0) return;
+
+	for (int a=0; a < 5; a++)
+	{
+		//Per-epoch cost, from a network of its own so that training below starts afresh
+		SeedThreadRandom (1);
+		LinearLayerNetwork *net = MakeNet (options[a], hidden, train);
+
+		double epoch = SecondsPerCall ([&] () { net->AdaptNetwork (train, learningParameters); }, minSeconds);
+		delete net;
+
+		SeedThreadRandom (1);
+		net = MakeNet (options[a], hidden, train);
+
+		int epochs = 0;
+		for (int ct=1; ct <= maxEpochs && epochs == 0; ct++)
+		{
+			net->AdaptNetwork (train, learningParameters);
+
+			//Total SSE, as ordertest stops on
+			if (train.TotalSSE() < targetSSE) epochs = ct;
+		}
+
+		results.Begin ("activation", ActivationName (net->LayerType()));
+		results.Field ("topology", to_string (train.numIns()) + "-" + to_string (hidden) + "-" + to_string (train.numOuts()));
+		results.Field ("us_per_epoch", epoch * 1e6);
+		results.Field ("target_sse", targetSSE);
+		results.Field ("epochs_to_target", epochs);
+		results.Field ("seconds_to_target", epochs * epoch);
+		results.End();
+
+		delete net;
+	}
+}
+
+
+///<summary>
+/// Times a pass of ComputeNetwork and AdaptNetwork over wide rows that are mostly zero, against ComputeSparse and
+/// AdaptSparse over the same rows stored sparsely, for a range of non-zeros per row. The sparse outputs are checked
+/// against ComputeNetwork, and the weights after a sparse pass of learning against those after a dense one
+///</summary>
+void BenchmarkSparse (BenchmarkResults &results, double minSeconds, bool quick)
+{
+	const int numIns = 4096, hidden = 32, numOuts = 4;
+	const int numRows = quick ? 500 : 2000;
+	const int nonZeroCounts[] = { 8, 64, 512 };
+	const double learningParameters[] = { 0.01, 0.5 };
+
+	for (int z=0; z < 3; z++)
+	{
+		//Rows of random non-zero inputs, placed at random, and targets of 0.1 or 0.9
+		vector<double> rows ((size_t) numRows * (numIns + numOuts), 0.0);
+
+		for (int row=0; row < numRows; row++)
+		{
+			double *rowValues = &rows[(size_t) row * (numIns + numOuts)];
+
+			for (int ct=0; ct < nonZeroCounts[z]; ct++) rowValues[ThreadRandom().Below (numIns)] = 0.5 + 0.4 * myrand();
+			for (int ct=0; ct < numOuts; ct++) rowValues[numIns + ct] = ThreadRandom().Below (2) ? 0.9 : 0.1;
+		}
+
+		dataset dense (numIns, numOuts, numRows, &rows[0], "Dense_set");
+		SparseDataset sparse (numIns, numOuts, numRows, &rows[0], "Sparse_set");
+
+		//Same weights in both networks
+		SeedThreadRandom (2);
+		LinearLayerNetwork *denseNet = MakeNet ('N', numIns, hidden, numOuts);
+		SeedThreadRandom (2);
+		LinearLayerNetwork *sparseNet = MakeNet ('N', numIns, hidden, numOuts);
+
+		//Outputs, then weights after one pass of learning from the same start
+		denseNet->ComputeNetwork (dense);
+		sparseNet->ComputeSparse (sparse);
+
+		double outputDifference = 0;
+		for (int row=0; row < numRows; row++)
+			for (int ct=0; ct < numOuts; ct++)
+				outputDifference = max (outputDifference, fabs (dense.GetNthOutputs(row)[ct] - sparse.GetNthOutputs(row)[ct]));
+
+		denseNet->AdaptNetwork (dense, learningParameters);
+		sparseNet->AdaptSparse (sparse, learningParameters);
+
+		vector<double> denseWeights (denseNet->HowManyWeights()), sparseWeights (sparseNet->HowManyWeights());
+		denseNet->ReturnTheWeights (&denseWeights[0]);
+		sparseNet->ReturnTheWeights (&sparseWeights[0]);
+
+		double weightDifference = 0;
+		for (size_t ct=0; ct < denseWeights.size(); ct++) weightDifference = max (weightDifference, fabs (denseWeights[ct] - sparseWeights[ct]));
+
+		double seconds[4];
+		seconds[0] = SecondsPerCall ([&] () { denseNet->ComputeNetwork (dense); }, minSeconds);
+		seconds[1] = SecondsPerCall ([&] () { sparseNet->ComputeSparse (sparse); }, minSeconds);
+		seconds[2] = SecondsPerCall ([&] () { denseNet->AdaptNetwork (dense, learningParameters); }, minSeconds);
+		seconds[3] = SecondsPerCall ([&] () { sparseNet->AdaptSparse (sparse, learningParameters); }, minSeconds);
+
+		const char *names[] = { "ComputeNetwork", "ComputeSparse", "AdaptNetwork", "AdaptSparse" };
+
+		for (int p=0; p < 4; p++)
+		{
+			results.Begin ("sparse", names[p]);
+			results.Field ("topology", string("4096-32-4"));
+			results.Field ("nonzeros_per_row", (double) sparse.NonZeros() / numRows);
+			results.Field ("rows", numRows);
+			results.Field ("samples_per_second", numRows / seconds[p]);
+			if (p == 1) results.Agreement (outputDifference);
+			if (p == 3) results.Agreement (weightDifference);
+			results.End();
+		}
+
+		delete denseNet;
+		delete sparseNet;
+	}
+}
+
+
+///<summary>
+/// Prunes a softmax network trained on the iris set to a range of ratios, reporting the test SSE and % correct before and
+/// after fine-tuning against the bytes of its weights; then prunes a wide network of random weights to the same ratios,
+/// timing SparseWeightNetwork against ComputeNetwork of the pruned network, whose outputs it is checked against
+///</summary>
+void BenchmarkPruning (BenchmarkResults &results, double minSeconds, bool quick)
+{
+	const double ratios[] = { 0, 0.5, 0.8, 0.9, 0.95, 0.99 };
+	const double learningParameters[] = { 0.05, 0.5 };
+	const int hidden = 40, trainEpochs = 300, tuneEpochs = quick ? 20 : 50;
+
+	dataset train ("Resource/iristrain.txt", "Training_set");
+	dataset test ("Resource/irisunseen.txt", "Test_set");
+
+	if (train.MakeOneHot() && test.MakeOneHot() && test.numIns() == train.numIns())
+	{
+		SeedThreadRandom (1);
+		LinearLayerNetwork *trained = MakeNet ('C', hidden, train);
+		for (int epoch=0; epoch < trainEpochs; epoch++) trained->AdaptNetwork (train, learningParameters);
+
+		vector<double> trainedWeights (trained->HowManyWeights());
+		trained->ReturnTheWeights (&trainedWeights[0]);
+
+		for (int r=0; r < 6; r++)
+		{
+			LinearLayerNetwork *net = MakeNet ('C', hidden, train);
+			net->SetTheWeights (&trainedWeights[0]);
+
+			WeightPruner pruner (net);
+			pruner.PruneRatio (net, ratios[r], PRUNE_GLOBAL);
+
+			for (int tuned=0; tuned < 2; tuned++)
+			{
+				if (tuned) pruner.FineTune (net, train, learningParameters, tuneEpochs);
+
+				SparseWeightNetwork sparse (net);
+				sparse.ComputeNetwork (test);
+
+				results.Begin ("pruning", tuned ? "fine_tuned" : "pruned");
+				results.Field ("topology", to_string (train.numIns()) + "-" + to_string (hidden) + "-" + to_string (train.numOuts()));
+				results.Field ("ratio", ratios[r]);
+				results.Field ("tune_epochs", tuned ? tuneEpochs : 0);
+				results.Field ("kept", pruner.HowManyKept());
+				results.Field ("bytes", (double) sparse.StoredBytes());
+				results.Field ("dense_bytes", (double) sparse.DenseBytes());
+				results.Field ("test_sse", test.TotalSSE());
+				results.Field ("test_correct", test.CalcCorrectClassifications()[0]);
+				results.End();
+			}
+
+			delete net;
+		}
+
+		delete trained;
+	}
+
+	//Speed, from random weights
+	const int numIns = 256, wide = 1024, numOuts = 16, numRows = quick ? 256 : 1024;
+
+	dataset *data = MakeData (numIns, numOuts, numRows);
+
+	SeedThreadRandom (3);
+	LinearLayerNetwork *net = MakeNet ('N', numIns, wide, numOuts);
+	WeightPruner pruner (net);
+
+	vector<double> outputs ((size_t) numRows * numOuts);
+
+	for (int r=0; r < 6; r++)
+	{
+		//Pruning only ever prunes more, so each ratio builds on the last
+		pruner.PruneRatio (net, ratios[r], PRUNE_GLOBAL);
+
+		SparseWeightNetwork sparse (net);
+		net->ComputeNetwork (*data);
+
+		double dense = SecondsPerCall ([&] () { net->ComputeNetwork (*data); }, minSeconds);
+		double compressed = SecondsPerCall ([&] () {
+			for (int row=0; row < numRows; row++) sparse.Forward (data->GetNthInputs(row), &outputs[(size_t) row * numOuts]);
+		}, minSeconds);
+
+		for (int p=0; p < 2; p++)
+		{
+			results.Begin ("pruning", p ? "SparseWeightNetwork" : "ComputeNetwork");
+			results.Field ("topology", string("256-1024-16"));
+			results.Field ("ratio", ratios[r]);
+			results.Field ("sparse_layers", (sparse.IsSparse(0) ? 1 : 0) + (sparse.IsSparse(1) ? 1 : 0));
+			results.Field ("bytes", (double) (p ? sparse.StoredBytes() : sparse.DenseBytes()));
+			results.Field ("samples_per_second", numRows / (p ? compressed : dense));
+			if (p) results.Agreement (MaxDifference (*data, &outputs[0]));
+			results.End();
+		}
+	}
+
+	delete net;
+	delete data;
+}
+
+
+///<summary>
+/// Times MetricsAccumulator and the dataset's own SSE and % classifications over data sets of each size
+///</summary>
+void BenchmarkMetrics (BenchmarkResults &results, double minSeconds)
+{
+	const int rowCounts[] = { 1000, 100000 };
+
+	for (int r=0; r < 2; r++)
+	{
+		dataset *data = MakeData (4, 3, rowCounts[r]);
+		LinearLayerNetwork *net = MakeNet ('N', 4, 10, 3);
+		net->ComputeNetwork (*data);
+
+		MetricsAccumulator metrics (*data);
+
+		double accumulate = SecondsPerCall ([&] () {
+			metrics.Reset();
+			for (int row=0; row < data->numData(); row++) metrics.Accumulate (data->GetNthOutputs(row), data->GetNthTargets(row));
+		}, minSeconds);
+
+		double sse = SecondsPerCall ([&] () { data->TotalSSE(); }, minSeconds);
+		double correct = SecondsPerCall ([&] () { data->CalcCorrectClassifications(); }, minSeconds);
+
+		const char *names[] = { "MetricsAccumulator", "TotalSSE", "CalcCorrectClassifications" };
+		double seconds[] = { accumulate, sse, correct };
+
+		for (int m=0; m < 3; m++)
+		{
+			results.Begin ("metrics", names[m]);
+			results.Field ("rows", data->numData());
+			results.Field ("ns_per_row", seconds[m] / data->numData() * 1e9);
+			results.End();
+		}
+
+		delete net;
+		delete data;
+	}
+}
+
+
+///<summary>
+/// Times loading a Resource-format text file into a dataset, writing rows in each ResultWriter format,
+/// and streaming scoring of text and binary input over a range of threads, checked against ComputeNetwork
+///</summary>
+void BenchmarkFiles (BenchmarkResults &results, int maxThreads, bool quick)
+{
+	const int numIns = 16, hidden = 32, numOuts = 4;
+	const int numRows = quick ? 20000 : 200000;
+
+	string base = string(P_tmpdir) + "/ann_benchmark_" + to_string(getpid());
+	string textFile = base + ".txt", binaryFile = base + ".bin", outputFile = base + ".out", checkpointFile = base + ".ckpt";
+
+	dataset *data = MakeData (numIns, numOuts, numRows);
+
+	//Text in the Resource format, datatype 1 with min/max of 0.1..0.9, so scaling leaves the data as it is
+	{
+		FILE *file = fopen (textFile.c_str(), "w");
+		fprintf (file, "%d %d %d 1\n", numIns, numOuts, numRows);
+		for (int ct=0; ct < numIns + numOuts; ct++) fprintf (file, "0.1 ");
+		fprintf (file, "\n");
+		for (int ct=0; ct < numIns + numOuts; ct++) fprintf (file, "0.9 ");
+		fprintf (file, "\n");
+
+		for (int row=0; row < numRows; row++)
+		{
+			for (int ct=0; ct < numIns + numOuts; ct++)
+				fprintf (file, "%.17g%c", data->GetNthInputs(row)[ct], (ct < numIns + numOuts - 1) ? '\t' : '\n');
+		}
+		fclose (file);
+	}
+
+	struct stat info;
+	stat (textFile.c_str(), &info);
+	double textBytes = info.st_size;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	dataset *loaded = new dataset (textFile.c_str(), "Loaded_set");
+	double loadSeconds = chrono::duration<double> (chrono::steady_clock::now() - start).count();
+
+	results.Begin ("files", "dataset load");
+	results.Field ("format", string("text"));
+	results.Field ("rows", loaded->numData());
+	results.Field ("mb_per_second", textBytes / loadSeconds / 1e6);
+	results.End();
+
+	delete loaded;
+
+	//Writing every column of every row in each format
+	const WriterFormat formats[] = { WRITER_TEXT, WRITER_BINARY, WRITER_COLUMNAR };
+	const char *formatNames[] = { "text", "binary", "columnar" };
+
+	for (int f=0; f < 3; f++)
+	{
+		string filename = (formats[f] == WRITER_BINARY) ? binaryFile : outputFile;
+
+		start = chrono::steady_clock::now();
+		{
+			ResultWriter writer (filename.c_str(), data->numInRow(), formats[f]);
+
+			for (int row=0; row < numRows; )
+			{
+				WriterChunk *chunk = writer.GetChunk();
+				for (chunk->rows = 0; chunk->rows < chunk->capacity && row < numRows; chunk->rows++, row++)
+					dcopy (data->numInRow(), data->GetNthInputs(row), &chunk->values[(size_t) data->numInRow() * chunk->rows]);
+				writer.Submit (chunk);
+			}
+			writer.Close();
+		}
+		double seconds = chrono::duration<double> (chrono::steady_clock::now() - start).count();
+
+		stat (filename.c_str(), &info);
+
+		results.Begin ("files", "ResultWriter");
+		results.Field ("format", string(formatNames[f]));
+		results.Field ("rows", numRows);
+		results.Field ("mb_per_second", info.st_size / seconds / 1e6);
+		results.End();
+	}
+
+	//Streaming scoring, from the text and the binary file just written, checked against ComputeNetwork
+	LinearLayerNetwork *net = MakeNet ('N', numIns, hidden, numOuts);
+	net->ComputeNetwork (*data);
+
+	TrainingState state = { 0, { 0.2, 0.0 }, 0, ORDER_FILE };
+	Checkpoint::Save (checkpointFile.c_str(), net, state);
+
+	DataScaling scaling;
+	LinearLayerNetwork *loadedNet = Checkpoint::Load (checkpointFile.c_str(), state, &scaling);
+
+	vector<double> scored ((size_t) numRows * numOuts);
+
+	for (int input=0; input < 2; input++)
+	{
+		string inputFile = (input == 0) ? textFile : binaryFile;
+		stat (inputFile.c_str(), &info);
+
+		for (int threads = 1; threads <= maxThreads; threads *= 2)
+		{
+			BatchScorer scorer (loadedNet, scaling, threads);
+
+			start = chrono::steady_clock::now();
+			long long rows = scorer.Score (inputFile.c_str(), outputFile.c_str(), WRITER_BINARY);
+			double seconds = chrono::duration<double> (chrono::steady_clock::now() - start).count();
+
+			//Outputs follow the 24-byte header of a binary results file
+			FILE *file = fopen (outputFile.c_str(), "rb");
+			fseek (file, 24, SEEK_SET);
+			size_t got = fread (&scored[0], sizeof(double), scored.size(), file);
+			fclose (file);
+
+			results.Begin ("files", "BatchScorer");
+			results.Field ("format", string(input == 0 ? "text" : "binary"));
+			results.Field ("threads", threads);
+			results.Field ("rows", (double) rows);
+			results.Field ("rows_per_second", rows / seconds);
+			results.Field ("mb_per_second", info.st_size / seconds / 1e6);
+			results.Agreement ((rows == numRows && got == scored.size()) ? MaxDifference (*data, &scored[0]) : INFINITY);
+			results.End();
+		}
+	}
+
+	unlink (textFile.c_str());
+	unlink (binaryFile.c_str());
+	unlink (outputFile.c_str());
+	unlink (checkpointFile.c_str());
+
+	delete loadedNet;
+	delete net;
+	delete data;
+}
+
+
+///<summary>
+/// Splits a ForwardBatch over the rows of data sets of each size between a range of threads, checked against ComputeNetwork
+///</summary>
+void BenchmarkThreads (BenchmarkResults &results, int maxThreads, double minSeconds, bool quick)
+{
+	const int numIns = 64, hidden = 256, numOuts = 8;
+	const int rowCounts[] = { 1024, 16384, 131072 };
+
+	LinearLayerNetwork *net = MakeNet ('N', numIns, hidden, numOuts);
+
+	for (int r=0; r < 3; r++)
+	{
+		if (quick && r > 1) continue;
+
+		int numRows = rowCounts[r];
+		dataset *data = MakeData (numIns, numOuts, numRows);
+		net->ComputeNetwork (*data);
+
+		vector<double> inputs ((size_t) numRows * numIns), outputs ((size_t) numRows * numOuts);
+		for (int row=0; row < numRows; row++) dcopy (numIns, data->GetNthInputs(row), &inputs[(size_t) row * numIns]);
+
+		for (int threads = 1; threads <= maxThreads; threads *= 2)
+		{
+			int share = (numRows + threads - 1) / threads;
+			vector<vector<double> > workspaces (threads, vector<double> (net->BatchWorkspace (share) + 1));
+
+			double seconds = SecondsPerCall ([&] () {
+				vector<thread> workers;
+				for (int t=0; t < threads; t++)
+				{
+					workers.push_back (thread ([&, t] () {
+						int first = t * share, rows = min (share, numRows - first);
+						if (rows > 0) net->ForwardBatch (&inputs[(size_t) first * numIns], rows, &outputs[(size_t) first * numOuts], &workspaces[t][0]);
+					}));
+				}
+				for (int t=0; t < threads; t++) workers[t].join();
+			}, minSeconds);
+
+			results.Begin ("threads", "ForwardBatch");
+			results.Field ("topology", string("64-256-8"));
+			results.Field ("threads", threads);
+			results.Field ("rows", numRows);
+			results.Field ("samples_per_second", numRows / seconds);
+			results.Agreement (MaxDifference (*data, &outputs[0]));
+			results.End();
+		}
+
+		delete data;
+	}
+
+	delete net;
+}
+
+
+///<summary>
+/// Times one row at a time through a network of one wide hidden layer, its neurons split across a SpinPool of
+/// each amount of threads, forward and in training, then the batch and Predictor paths that serve requests.
+/// Each is checked against the network run on the calling thread alone
+///</summary>
+void BenchmarkLayerThreads (BenchmarkResults &results, int maxThreads, double minSeconds, bool quick)
+{
+	const int numIns = 256, hidden = quick ? 1024 : 4096, numOuts = 8, numRows = 16;
+	const double learningParameters[] = { 1e-4, 0.5 };
+
+	string topology = to_string (numIns) + "-" + to_string (hidden) + "-" + to_string (numOuts);
+
+	dataset *data = MakeData (numIns, numOuts, numRows);
+	vector<int> rows (numRows);
+	for (int row=0; row < numRows; row++) rows[row] = row;
+
+	//Reference: outputs, then weights after one pass of training, on the calling thread alone
+	SeedThreadRandom (7);
+	LinearLayerNetwork *reference = MakeNet ('N', numIns, hidden, numOuts);
+
+	reference->ComputeNetwork (*data);
+	vector<double> expected ((size_t) numRows * numOuts);
+	for (int row=0; row < numRows; row++) dcopy (numOuts, data->GetNthOutputs(row), &expected[(size_t) row * numOuts]);
+
+	//Scaled inputs of every row, which a Predictor without min/max takes as they are
+	vector<double> inputs ((size_t) numRows * numIns), outputs ((size_t) numRows * numOuts);
+	for (int row=0; row < numRows; row++) dcopy (numIns, data->GetNthInputs(row), &inputs[(size_t) row * numIns]);
+
+	DataScaling unscaled;
+	unscaled.numinputs = numIns;
+	unscaled.numoutputs = numOuts;
+	unscaled.datatype = 1;
+
+	reference->AdaptRows (*data, &rows[0], numRows, learningParameters);
+	vector<double> trained (reference->HowManyWeights());
+	reference->ReturnTheWeights (&trained[0]);
+
+	for (int threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		SpinPool pool (threads);
+
+		SeedThreadRandom (7);
+		LinearLayerNetwork *net = MakeNet ('N', numIns, hidden, numOuts);
+		net->SetPool (&pool);
+
+		//Agreement first, from the same weights as the reference
+		net->ComputeNetwork (*data);
+		double forwardDifference = MaxDifference (*data, &expected[0]);
+
+		vector<double> workspace (net->BatchWorkspace (numRows));
+		net->ForwardBatch (&inputs[0], numRows, &outputs[0], &workspace[0]);
+		double batchDifference = MaxDifference (*data, &outputs[0]);
+
+		Predictor predictor (net, unscaled);
+		predictor.SetPool (&pool);
+		for (int row=0; row < numRows; row++) predictor.Predict (&inputs[(size_t) row * numIns], &outputs[(size_t) row * numOuts]);
+		double predictDifference = MaxDifference (*data, &outputs[0]);
+
+		net->AdaptRows (*data, &rows[0], numRows, learningParameters);
+		vector<double> weights (net->HowManyWeights());
+		net->ReturnTheWeights (&weights[0]);
+
+		double trainDifference = 0;
+		for (size_t ct=0; ct < weights.size(); ct++) trainDifference = max (trainDifference, fabs (weights[ct] - trained[ct]));
+
+		double seconds[] = {
+			SecondsPerCall ([&] () { net->ComputeNetwork (*data); }, minSeconds),
+			SecondsPerCall ([&] () { net->AdaptRows (*data, &rows[0], numRows, learningParameters); }, minSeconds),
+			SecondsPerCall ([&] () { net->ForwardBatch (&inputs[0], numRows, &outputs[0], &workspace[0]); }, minSeconds),
+			SecondsPerCall ([&] () { for (int row=0; row < numRows; row++) predictor.Predict (&inputs[(size_t) row * numIns], &outputs[(size_t) row * numOuts]); }, minSeconds) };
+
+		const char *functions[] = { "ComputeNetwork", "AdaptRows", "ForwardBatch", "Predictor" };
+		double differences[] = { forwardDifference, trainDifference, batchDifference, predictDifference };
+
+		for (int f=0; f < 4; f++)
+		{
+			results.Begin ("layer_threads", functions[f]);
+			results.Field ("topology", topology);
+			results.Field ("threads", threads);
+			results.Field ("us_per_row", seconds[f] / numRows * 1e6);
+			results.Agreement (differences[f]);
+			results.End();
+		}
+
+		net->SetPool (0);
+		delete net;
+	}
+
+	delete reference;
+	delete data;
+}
+
+
+///<summary>
+/// Streams rows through a deep network pipelined into each amount of stages up to the cores there are,
+/// checked against ComputeNetwork, with the share of the time each stage was busy, starved and blocked
+///</summary>
+void BenchmarkPipeline (BenchmarkResults &results, int maxThreads, double minSeconds, bool quick)
+{
+	const int numIns = 256, numOuts = 16, numRows = quick ? 1024 : 8192, microRows = 64;
+	const char *topology = "512R,512R,256R,256R,16S";
+
+	vector<LayerSpec> specs;
+	ParseLayers (topology, specs);
+
+	LinearLayerNetwork *net = MakeDeepNet (numIns, specs);
+	dataset *data = MakeData (numIns, numOuts, numRows);
+	net->ComputeNetwork (*data);
+
+	vector<double> inputs ((size_t) numRows * numIns), outputs ((size_t) numRows * numOuts);
+	for (int row=0; row < numRows; row++) dcopy (numIns, data->GetNthInputs(row), &inputs[(size_t) row * numIns]);
+
+	for (int numStages = 1; numStages <= min ((int) specs.size(), maxThreads); numStages++)
+	{
+		LayerPipeline pipeline (net, numStages, microRows);
+
+		pipeline.Run (&inputs[0], numRows, &outputs[0]);
+		double difference = MaxDifference (*data, &outputs[0]);
+
+		pipeline.ResetCounters();
+		double seconds = SecondsPerCall ([&] () { pipeline.Run (&inputs[0], numRows, &outputs[0]); }, minSeconds);
+
+		results.Begin ("pipeline", "Run");
+		results.Field ("topology", string(topology));
+		results.Field ("stages", numStages);
+		results.Field ("micro_rows", microRows);
+		results.Field ("samples_per_second", numRows / seconds);
+		results.Agreement (difference);
+		results.End();
+
+		for (int s=0; s < pipeline.HowManyStages(); s++)
+		{
+			const PipelineStage &stage = pipeline.Stage (s);
+
+			results.Begin ("pipeline", "stage");
+			results.Field ("stages", numStages);
+			results.Field ("stage", s);
+			results.Field ("first_layer", stage.firstLayer);
+			results.Field ("layers", stage.numLayers);
+			results.Field ("weights", (double) stage.weights);
+			results.Field ("occupancy", pipeline.Occupancy (s));
+			results.Field ("starved", stage.starvedSeconds / pipeline.RunSeconds());
+			results.Field ("blocked", stage.blockedSeconds / pipeline.RunSeconds());
+			results.End();
+		}
+	}
+
+	delete data;
+	delete net;
+}
+
+
+///<summary>
+/// Runs every benchmark, writing the JSON to the console or a file; returns 1 if any agreement check failed
+///</summary>
+int main (int argc, char *argv[])
+{
+	bool quick = false;
+	const char *outputFile = 0;
+
+	for (int arg=1; arg < argc; arg++)
+	{
+		if (strcmp (argv[arg], "--quick") == 0) quick = true;
+		else if (strcmp (argv[arg], "--output") == 0 && arg + 1 < argc) outputFile = argv[++arg];
+		else
+		{
+			cerr << "Usage: " << argv[0] << " [--quick] [--output file]" << endl;
+			return 1;
+		}
+	}
+
+	FILE *out = (outputFile != 0) ? fopen (outputFile, "w") : stdout;
+	if (out == 0)
+	{
+		cerr << outputFile << " [!] Unable to create" << endl;
+		return 1;
+	}
+
+	double minSeconds = quick ? 0.02 : 0.2;
+	int maxThreads = thread::hardware_concurrency() > 0 ? thread::hardware_concurrency() : 1;
+
+	SeedThreadRandom (1);
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	BenchmarkResults results (out);
+
+	LayerBenchmark::Run (results, minSeconds);
+	LayerBenchmark::RunKernels (results, minSeconds);
+	BenchmarkNetworks (results, minSeconds, quick);
+	BenchmarkDeep (results, minSeconds, quick);
+	BenchmarkGemm (results, minSeconds, quick);
+	BenchmarkActivations (results, minSeconds, quick);
+	BenchmarkSparse (results, minSeconds, quick);
+	BenchmarkPruning (results, minSeconds, quick);
+	BenchmarkMetrics (results, minSeconds);
+	BenchmarkFiles (results, maxThreads, quick);
+	BenchmarkThreads (results, maxThreads, minSeconds, quick);
+	BenchmarkLayerThreads (results, maxThreads, minSeconds, quick);
+	BenchmarkPipeline (results, maxThreads, minSeconds, quick);
+
+	int failed = results.Finish (chrono::duration<double> (chrono::steady_clock::now() - start).count());
+
+	if (out != stdout) fclose (out);
+
+	return (failed > 0) ? 1 : 0;
+}
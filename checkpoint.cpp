@@ -0,0 +1,380 @@
+/*
+*	Library Module Implementing binary checkpoints of networks
+*/
+
+#ifndef CHECKPOINT_CPP
+#define CHECKPOINT_CPP
+
+#include "Header/library.h"
+
+
+const char CHECKPOINT_MAGIC[8] = { 'A', 'N', 'N', 'C', 'K', 'P', 'T', 0 };
+
+
+///<summary>
+/// Walks the layers from first to last, storing the size and type of each
+///</summary>
+void Checkpoint::Describe (LinearLayerNetwork *net, vector<CheckpointLayer> &layers)
+{
+	layers.clear();
+
+	for (int l=0; l < net->HowManyLayers(); l++)
+	{
+		CheckpointLayer description;
+		char layerType;
+
+		net->DescribeLayer (l, description.numInputs, description.numNeurons, layerType);
+		description.layerType = layerType;
+		description.reserved = 0;
+
+		layers.push_back (description);
+	}
+}
+
+
+///<summary>
+/// Lays out header, layers, min/max, weights and changes in weights, each at a cache-line-aligned offset,
+/// writes them to filename.tmp, optionally syncs, and renames the file into place
+///</summary>
+bool Checkpoint::WriteFile (const char *filename, vector<CheckpointLayer> &layers, const double weights[], const double deltaWeights[],
+							const TrainingState &state, const DataScaling *scaling, bool sync)
+{
+	CheckpointHeader header;
+	memset (&header, 0, sizeof(header));
+
+	long long numWeights = 0;
+	for (size_t l=0; l < layers.size(); l++)
+		numWeights += (long long) (layers[l].numInputs + 1) * layers[l].numNeurons;
+
+	int numScaled = (scaling != 0) ? scaling->numinputs + scaling->numoutputs : 0;
+
+	memcpy (header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+	header.version = CHECKPOINT_VERSION;
+	header.numLayers = (int) layers.size();
+	header.networkType = layers.empty() ? 0 : layers[0].layerType;
+	header.hasScaling = (scaling != 0);
+	header.state = state;
+	header.datatype = (scaling != 0) ? scaling->datatype : 0;
+	header.numInputs = layers.empty() ? 0 : layers[0].numInputs;
+	header.numOutputs = layers.empty() ? 0 : layers.back().numNeurons;
+	header.numWeights = numWeights;
+
+	header.layersOffset = Arena::Bytes (sizeof(header), 1);
+	header.scalingOffset = header.layersOffset + Arena::Bytes (layers.size(), sizeof(CheckpointLayer));
+	header.weightsOffset = header.scalingOffset + Arena::Bytes (2 * numScaled);
+	header.deltaWeightsOffset = header.weightsOffset + Arena::Bytes (numWeights);
+	header.totalBytes = header.deltaWeightsOffset + Arena::Bytes (numWeights);
+
+	//Whole file built in one buffer, so it is written with a single call
+	vector<char> buffer (header.totalBytes, 0);
+
+	memcpy (&buffer[0], &header, sizeof(header));
+	if (!layers.empty()) memcpy (&buffer[header.layersOffset], &layers[0], layers.size() * sizeof(CheckpointLayer));
+	if (numScaled > 0)
+	{
+		memcpy (&buffer[header.scalingOffset], &scaling->mindata[0], numScaled * sizeof(double));
+		memcpy (&buffer[header.scalingOffset + numScaled * sizeof(double)], &scaling->maxdata[0], numScaled * sizeof(double));
+	}
+	memcpy (&buffer[header.weightsOffset], weights, numWeights * sizeof(double));
+	memcpy (&buffer[header.deltaWeightsOffset], deltaWeights, numWeights * sizeof(double));
+
+	string temporary = string(filename) + ".tmp";
+
+	int fd = open (temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) return false;
+
+	bool ok = write (fd, &buffer[0], buffer.size()) == (ssize_t) buffer.size();
+	if (ok && sync) ok = fsync (fd) == 0;
+	close (fd);
+
+	if (ok) ok = rename (temporary.c_str(), filename) == 0;
+	if (!ok) unlink (temporary.c_str());
+
+	return ok;
+}
+
+
+///<summary>
+/// Copies the weights and changes in weights out of the network, then writes them
+///</summary>
+bool Checkpoint::Save (const char *filename, LinearLayerNetwork *net, const TrainingState &state, dataset *data)
+{
+	vector<CheckpointLayer> layers;
+	Describe (net, layers);
+
+	vector<double> weights (net->HowManyWeights());
+	vector<double> deltaWeights (net->HowManyWeights());
+
+	net->ReturnTheWeights (&weights[0]);
+	net->ReturnTheDeltaWeights (&deltaWeights[0]);
+
+	DataScaling scaling;
+	if (data != 0) data->GetScaling (scaling);
+
+	return WriteFile (filename, layers, &weights[0], &deltaWeights[0], state, (data != 0) ? &scaling : 0);
+}
+
+
+///<summary>
+/// Maps the file, checks the header and layers, makes the network and copies the weights in place from the mapping
+///</summary>
+LinearLayerNetwork * Checkpoint::Load (const char *filename, TrainingState &state, DataScaling *scaling)
+{
+	int fd = open (filename, O_RDONLY);
+	if (fd < 0) return 0;
+
+	struct stat info;
+	if (fstat (fd, &info) != 0 || info.st_size < (off_t) sizeof(CheckpointHeader))
+	{
+		close (fd);
+		return 0;
+	}
+
+	void *mapping = mmap (0, info.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+	close (fd);
+	if (mapping == MAP_FAILED) return 0;
+
+	const char *file = (const char *) mapping;
+	const CheckpointHeader *header = (const CheckpointHeader *) file;
+	const CheckpointLayer *layers = (const CheckpointLayer *) (file + header->layersOffset);
+
+	//Scaling, when saved, holds a min and a max for every input and output
+	long long numScaled = header->hasScaling ? (long long) header->numInputs + header->numOutputs : 0;
+
+	//Checks that this is a whole checkpoint, with every section inside the file and after the header,
+	//before reading the sections
+	bool valid = (memcmp (header->magic, CHECKPOINT_MAGIC, sizeof(header->magic)) == 0)
+			  && (header->version == CHECKPOINT_VERSION)
+			  && (header->totalBytes == info.st_size)
+			  && (header->numLayers >= 1 && header->numLayers <= DEEP_MAX_LAYERS)
+			  && (header->numInputs > 0 && header->numOutputs > 0)
+			  && (header->layersOffset >= (long long) sizeof(CheckpointHeader) && header->layersOffset <= header->totalBytes)
+			  && (header->scalingOffset <= header->totalBytes && header->weightsOffset <= header->totalBytes)
+			  && (header->deltaWeightsOffset <= header->totalBytes)
+			  && (header->numWeights >= 0 && header->numWeights <= header->totalBytes)
+			  && (header->layersOffset + header->numLayers * (long long) sizeof(CheckpointLayer) <= header->scalingOffset)
+			  && (header->scalingOffset + 2 * numScaled * (long long) sizeof(double) <= header->weightsOffset)
+			  && (header->weightsOffset + header->numWeights * (long long) sizeof(double) <= header->deltaWeightsOffset)
+			  && (header->deltaWeightsOffset + header->numWeights * (long long) sizeof(double) <= header->totalBytes);
+
+	//Checks that it is a network that can be made: each layer takes the outputs of the one before,
+	//and their types are those of a DeepNetwork
+	vector<LayerSpec> specs;
+
+	for (int l=0; valid && l < header->numLayers; l++)
+	{
+		LayerSpec spec = { layers[l].numNeurons, (char) layers[l].layerType };
+		specs.push_back (spec);
+
+		if (l > 0) valid = (layers[l].numInputs == layers[l - 1].numNeurons);
+	}
+
+	//The sizes in the header, which the scaling is read by, are those of the network
+	valid = valid && layers[0].numInputs > 0 && IsValidNetwork (specs)
+				  && (layers[0].numInputs == header->numInputs)
+				  && (layers[header->numLayers - 1].numNeurons == header->numOutputs);
+
+	if (valid)
+	{
+		long long numWeights = 0;
+		for (int l=0; l < header->numLayers; l++)
+			numWeights += (long long) (layers[l].numInputs + 1) * layers[l].numNeurons;
+
+		valid = (numWeights == header->numWeights);
+	}
+
+	LinearLayerNetwork *net = 0;
+
+	if (valid)
+	{
+		//Networks MakeNet can make are made by it, as they were saved; any others as a DeepNetwork
+		bool single = (header->numLayers == 1) && (layers[0].layerType != 'C');
+		bool pair = (header->numLayers == 2)
+				 && (layers[1].layerType == 'S' || (layers[1].layerType == 'C' && layers[0].layerType == 'M'));
+
+		if (single)
+			net = MakeNet ((char) layers[0].layerType, layers[0].numInputs, 0, layers[0].numNeurons);
+		else if (pair)
+			net = MakeNet ((layers[1].layerType == 'C') ? 'C' : (char) layers[0].layerType, layers[0].numInputs, layers[0].numNeurons, layers[1].numNeurons);
+		else
+			net = MakeDeepNet (layers[0].numInputs, specs);
+
+		net->SetTheWeights ((const double *) (file + header->weightsOffset));
+		net->SetTheDeltaWeights ((const double *) (file + header->deltaWeightsOffset));
+
+		state = header->state;
+
+		if (scaling != 0)
+		{
+			const double *minmax = (const double *) (file + header->scalingOffset);
+
+			scaling->numinputs = header->hasScaling ? header->numInputs : 0;
+			scaling->numoutputs = header->hasScaling ? header->numOutputs : 0;
+			scaling->datatype = header->datatype;
+			scaling->mindata.assign (minmax, minmax + numScaled);
+			scaling->maxdata.assign (minmax + numScaled, minmax + 2 * numScaled);
+		}
+	}
+
+	munmap (mapping, info.st_size);
+
+	return net;
+}
+
+
+///<summary>
+/// Constructor: finds the layout once and makes buffers large enough for every copy
+///</summary>
+CheckpointScheduler::CheckpointScheduler (const char *base, LinearLayerNetwork *net, int epochs, double seconds, int numKept, dataset *data)
+{
+	baseName = base;
+	keep = (numKept > 0) ? numKept : 1;
+	everyEpochs = epochs;
+	everySeconds = seconds;
+
+	Checkpoint::Describe (net, layers);
+
+	hasScaling = (data != 0);
+	if (hasScaling) data->GetScaling (scaling);
+
+	weights.resize (net->HowManyWeights());
+	deltaWeights.resize (net->HowManyWeights());
+
+	lastEpoch = 0;
+	lastTime = chrono::steady_clock::now();
+	nextSlot = 0;
+	written = 0;
+	deferred = 0;
+	busy = false;
+	stopping = false;
+
+	worker = thread (&CheckpointScheduler::WriteLoop, this);
+}
+
+
+CheckpointScheduler::~CheckpointScheduler ()
+{
+	{
+		lock_guard<mutex> guard (lock);
+		stopping = true;
+	}
+	wake.notify_one();
+	worker.join();
+}
+
+
+///<summary>
+/// Only the due test and a copy of the weights happen on the training thread; the lock is never
+/// held while writing, so checking whether the writer is busy cannot stall
+///</summary>
+bool CheckpointScheduler::Poll (LinearLayerNetwork *net, const TrainingState &current)
+{
+	bool due = (everyEpochs > 0 && current.epoch - lastEpoch >= everyEpochs)
+			|| (everySeconds > 0 && chrono::duration<double> (chrono::steady_clock::now() - lastTime).count() >= everySeconds);
+
+	if (!due) return false;
+
+	{
+		lock_guard<mutex> guard (lock);
+
+		if (busy)
+		{
+			deferred++;
+			return false;
+		}
+
+		net->ReturnTheWeights (&weights[0]);
+		net->ReturnTheDeltaWeights (&deltaWeights[0]);
+		state = current;
+		busy = true;
+	}
+	wake.notify_one();
+
+	lastEpoch = current.epoch;
+	lastTime = chrono::steady_clock::now();
+
+	return true;
+}
+
+
+///<summary>
+/// Writes each copy to the next slot in the rotation, synced, then marks the buffers free
+///</summary>
+void CheckpointScheduler::WriteLoop ()
+{
+	for (;;)
+	{
+		{
+			unique_lock<mutex> guard (lock);
+
+			wake.wait (guard, [this] () { return busy || stopping; });
+
+			if (!busy) return;		// stopping, and nothing left to write
+		}
+
+		string filename = baseName + "." + to_string(nextSlot) + ".ckpt";
+
+		if (Checkpoint::WriteFile (filename.c_str(), layers, &weights[0], &deltaWeights[0], state, hasScaling ? &scaling : 0, true))
+			written++;
+
+		nextSlot = (nextSlot + 1) % keep;
+
+		{
+			lock_guard<mutex> guard (lock);
+			busy = false;
+		}
+		idle.notify_all();
+	}
+}
+
+
+void CheckpointScheduler::Flush ()
+{
+	unique_lock<mutex> guard (lock);
+
+	idle.wait (guard, [this] () { return !busy; });
+}
+
+
+int CheckpointScheduler::Written ()
+{
+	return written;
+}
+
+
+int CheckpointScheduler::Deferred ()
+{
+	return deferred;
+}
+
+
+///<summary>
+/// Tries every slot, keeping the network with the most epochs
+///</summary>
+LinearLayerNetwork * CheckpointScheduler::LoadLatest (const char *base, int numKept, TrainingState &state, DataScaling *scaling)
+{
+	LinearLayerNetwork *latest = 0;
+
+	for (int slot=0; slot < numKept; slot++)
+	{
+		string filename = string(base) + "." + to_string(slot) + ".ckpt";
+
+		TrainingState slotState;
+		DataScaling slotScaling;
+
+		LinearLayerNetwork *net = Checkpoint::Load (filename.c_str(), slotState, &slotScaling);
+
+		if (net != 0 && (latest == 0 || slotState.epoch > state.epoch))
+		{
+			delete latest;
+			latest = net;
+			state = slotState;
+			if (scaling != 0) *scaling = slotScaling;
+		}
+		else delete net;
+	}
+
+	return latest;
+}
+
+#endif
@@ -0,0 +1,182 @@
+/*
+*	Library Module Implementing hardware event counters with perf_event_open
+*/
+
+#ifndef COUNTERS_CPP
+#define COUNTERS_CPP
+
+#include "Header/library.h"
+
+
+#ifdef __linux__
+
+//perf_event_attr type and config of each event, in the order of HardwareEvent
+const unsigned int COUNTER_TYPES[HARDWARE_EVENTS] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+const unsigned long long COUNTER_CONFIGS[HARDWARE_EVENTS] = {
+	PERF_COUNT_HW_CPU_CYCLES,
+	PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+	PERF_COUNT_HW_CACHE_MISSES,
+	PERF_COUNT_HW_BRANCH_MISSES
+};
+
+#endif
+
+//Names of the events, as printed
+const char *COUNTER_NAMES[HARDWARE_EVENTS] = { "cycles", "instructions", "L1D misses", "LLC misses", "branch misses" };
+
+
+///<summary>
+/// Opens each event for the calling thread on any CPU, counting user space only, so perf_event_paranoid of up to 2 allows it
+///</summary>
+HardwareCounters::HardwareCounters ()
+{
+	for (int event=0; event < HARDWARE_EVENTS; event++)
+	{
+		files[event] = -1;
+		counts[event] = -1;
+
+#ifdef __linux__
+		struct perf_event_attr attr;
+		memset (&attr, 0, sizeof(attr));
+
+		attr.size = sizeof(attr);
+		attr.type = COUNTER_TYPES[event];
+		attr.config = COUNTER_CONFIGS[event];
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		files[event] = (int) syscall (__NR_perf_event_open, &attr, 0, -1, -1, 0);
+
+		if (files[event] < 0 && error.empty()) error = string(COUNTER_NAMES[event]) + ": " + strerror (errno);
+#else
+		if (error.empty()) error = "Hardware counters need Linux";
+#endif
+	}
+}
+
+
+HardwareCounters::~HardwareCounters ()
+{
+	for (int event=0; event < HARDWARE_EVENTS; event++)
+		if (files[event] >= 0) close (files[event]);
+}
+
+
+bool HardwareCounters::Available ()
+{
+	for (int event=0; event < HARDWARE_EVENTS; event++)
+		if (files[event] >= 0) return true;
+
+	return false;
+}
+
+
+bool HardwareCounters::Counted (HardwareEvent event)
+{
+	return files[event] >= 0;
+}
+
+
+const char * HardwareCounters::Error ()
+{
+	return error.c_str();
+}
+
+
+void HardwareCounters::Start ()
+{
+#ifdef __linux__
+	for (int event=0; event < HARDWARE_EVENTS; event++)
+	{
+		if (files[event] < 0) continue;
+
+		ioctl (files[event], PERF_EVENT_IOC_RESET, 0);
+		ioctl (files[event], PERF_EVENT_IOC_ENABLE, 0);
+	}
+#endif
+}
+
+
+///<summary>
+/// Reads {count, time enabled, time running} of each event, scaling the count if it was only counting part of the time
+///</summary>
+void HardwareCounters::Stop ()
+{
+#ifdef __linux__
+	for (int event=0; event < HARDWARE_EVENTS; event++)
+		if (files[event] >= 0) ioctl (files[event], PERF_EVENT_IOC_DISABLE, 0);
+
+	for (int event=0; event < HARDWARE_EVENTS; event++)
+	{
+		counts[event] = -1;
+		if (files[event] < 0) continue;
+
+		unsigned long long values[3];
+		if (read (files[event], values, sizeof(values)) != (ssize_t) sizeof(values)) continue;
+
+		if (values[2] == 0) counts[event] = 0;
+		else if (values[2] < values[1]) counts[event] = (long long) ((double) values[0] * values[1] / values[2]);
+		else counts[event] = (long long) values[0];
+	}
+#endif
+}
+
+
+long long HardwareCounters::Count (HardwareEvent event)
+{
+	return Counted (event) ? counts[event] : -1;
+}
+
+
+double HardwareCounters::InstructionsPerCycle ()
+{
+	if (Count (EVENT_CYCLES) <= 0 || Count (EVENT_INSTRUCTIONS) < 0) return 0;
+
+	return (double) Count (EVENT_INSTRUCTIONS) / Count (EVENT_CYCLES);
+}
+
+
+double HardwareCounters::PerSample (HardwareEvent event, long long samples)
+{
+	if (Count (event) < 0 || samples <= 0) return 0;
+
+	return (double) Count (event) / samples;
+}
+
+
+void HardwareCounters::Summarise (long long samples, double summary[])
+{
+	summary[0] = (Counted (EVENT_CYCLES) && Counted (EVENT_INSTRUCTIONS)) ? InstructionsPerCycle() : -1;
+
+	for (int event = EVENT_L1D_MISSES; event < HARDWARE_EVENTS; event++)
+		summary[event - EVENT_INSTRUCTIONS] = Counted ((HardwareEvent) event) ? PerSample ((HardwareEvent) event, samples) : -1;
+}
+
+
+void HardwareCounters::Print (long long samples)
+{
+	double summary[COUNTER_SUMMARY];
+
+	Summarise (samples, summary);
+	PrintSummary (summary);
+}
+
+
+///<summary>
+/// Events that are not counted are left out, so the line is as long as what can be measured
+///</summary>
+void HardwareCounters::PrintSummary (const double summary[])
+{
+	if (summary[0] >= 0) printf ("\tIPC [%.2f]", summary[0]);
+
+	for (int event = EVENT_L1D_MISSES; event < HARDWARE_EVENTS; event++)
+		if (summary[event - EVENT_INSTRUCTIONS] >= 0) printf (" %s/row [%.2f]", COUNTER_NAMES[event], summary[event - EVENT_INSTRUCTIONS]);
+
+	printf ("\n");
+	fflush (stdout);
+}
+
+#endif
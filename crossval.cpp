@@ -0,0 +1,183 @@
+/*
+*	Library Module Implementing k-fold cross-validation of networks
+*/
+
+#ifndef CROSSVAL_CPP
+#define CROSSVAL_CPP
+
+#include "Header/library.h"
+
+
+///<summary>
+/// Constructor, copies the setup and allocates space for the results
+///</summary>
+CrossValidator::CrossValidator (dataset &theData, int folds, int threads, char option, int hidden, int epochs, const double lp[])
+	: data(theData)
+{
+	//At least two folds, and no more folds than rows
+	numFolds = folds;
+	if (numFolds > data.numData()) numFolds = data.numData();
+	if (numFolds < 2) numFolds = 2;
+
+	numThreads = threads;
+	if (numThreads < 1) numThreads = 1;
+
+	networkOption = option;
+	hiddenNodes = hidden;
+	maxEpoch = epochs;
+	dcopy (2, lp, learningParameters);
+
+	results = new FoldResult [numFolds];
+}
+
+
+///<summary>
+/// Destructor, frees memory
+///</summary>
+CrossValidator::~CrossValidator ()
+{
+	delete [] results;
+}
+
+
+void CrossValidator::UseLayers (const vector<LayerSpec> &specs)
+{
+	layers = specs;
+}
+
+
+///<summary>
+/// Selects the rows learnt from or held out in a fold: row i is held out in fold (i % numFolds)
+///</summary>
+int CrossValidator::SelectRows (int fold, bool isTest, int rows[])
+{
+	int numRows = 0;
+
+	for (int i=0; i < data.numData(); i++)
+	{
+		if ( ((i % numFolds) == fold) == isTest ) rows[numRows++] = i;
+	}
+
+	return numRows;
+}
+
+
+///<summary>
+/// Trains the network for maxEpoch epochs on the rows not in the fold, then tests it on the fold
+///</summary>
+void CrossValidator::RunFold (int fold, LinearLayerNetwork *net)
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	vector<int> trainRows (data.numData());
+	vector<int> testRows (data.numData());
+
+	int numTrain = SelectRows (fold, false, &trainRows[0]);
+	int numTest = SelectRows (fold, true, &testRows[0]);
+
+	for (int epoch=0; epoch < maxEpoch; epoch++)
+	{
+		net -> AdaptRows (data, &trainRows[0], numTrain, learningParameters);
+	}
+
+	//SSE and % correct of each output on the held-out rows
+	vector<double> sse (data.numOuts());
+	vector<double> correct (data.numOuts());
+
+	net -> EvaluateRows (data, &testRows[0], numTest, &sse[0], &correct[0]);
+
+	FoldResult &result = results[fold];
+	result.sse = 0;
+	result.correct = 0;
+	for (int ct=0; ct < data.numOuts(); ct++)
+	{
+		result.sse += sse[ct];
+		result.correct += correct[ct] / data.numOuts();
+	}
+	result.trainRows = numTrain;
+	result.testRows = numTest;
+	result.seconds = chrono::duration<double> (chrono::steady_clock::now() - start).count();
+}
+
+
+///<summary>
+/// Makes all networks, then lets up to numThreads workers take folds until none are left
+///</summary>
+void CrossValidator::Run (int weight_option)
+{
+	//Each fold's weights come from a stream of its own, so they do not depend on the other folds
+	unsigned long long foldSeed = DeriveSeed (weight_option, STREAM_FOLDS);
+
+	vector<LinearLayerNetwork *> nets (numFolds);
+	for (int fold=0; fold < numFolds; fold++)
+	{
+		SeedThreadRandom (foldSeed, fold);
+		nets[fold] = layers.empty() ? MakeNet (networkOption, hiddenNodes, data) : MakeDeepNet (data.numIns(), layers);
+	}
+
+	//Index of the next fold to be taken by a worker
+	atomic<int> nextFold (0);
+
+	vector<thread> workers;
+	int numWorkers = (numThreads < numFolds) ? numThreads : numFolds;
+
+	for (int w=0; w < numWorkers; w++)
+	{
+		workers.push_back (thread ([this, &nets, &nextFold] () {
+			for (int fold = nextFold++; fold < numFolds; fold = nextFold++)
+				RunFold (fold, nets[fold]);
+		}));
+	}
+
+	for (int w=0; w < numWorkers; w++) workers[w].join();
+
+	for (int fold=0; fold < numFolds; fold++) delete nets[fold];
+}
+
+
+FoldResult & CrossValidator::GetFold (int n)
+{
+	return results[n];
+}
+
+
+int CrossValidator::HowManyFolds ()
+{
+	return numFolds;
+}
+
+
+///<summary>
+/// Prints one line per fold, then mean and (sample) variance over the folds
+///</summary>
+void CrossValidator::PrintReport ()
+{
+	double meanSSE = 0, meanCorrect = 0;
+	double varSSE = 0, varCorrect = 0;
+
+	cout << numFolds << "-fold cross-validation, " << numThreads << " thread(s)" << endl;
+
+	for (int fold=0; fold < numFolds; fold++)
+	{
+		cout << "\tFold " << setw(3) << fold
+			 << "  train " << setw(6) << results[fold].trainRows
+			 << "  test " << setw(6) << results[fold].testRows
+			 << "  SSE " << setw(12) << results[fold].sse
+			 << "  % Correct " << setw(8) << results[fold].correct
+			 << "  Time " << setw(10) << results[fold].seconds << "s" << endl;
+
+		meanSSE += results[fold].sse / numFolds;
+		meanCorrect += results[fold].correct / numFolds;
+	}
+
+	for (int fold=0; fold < numFolds; fold++)
+	{
+		varSSE += (results[fold].sse - meanSSE) * (results[fold].sse - meanSSE) / (numFolds - 1);
+		varCorrect += (results[fold].correct - meanCorrect) * (results[fold].correct - meanCorrect) / (numFolds - 1);
+	}
+
+	cout << "SSE:       mean " << meanSSE << "  variance " << varSSE << endl
+		 << "% Correct: mean " << meanCorrect << "  variance " << varCorrect << endl;
+}
+
+#endif
@@ -21,7 +21,7 @@ void dcopy (int num, const double fromarray[], double toarray[])
 }
 
 
-void arrout (char *s, int num, double data[], int nl) 
+void arrout (const char *s, int num, double data[], int nl) 
 {
 	// routine to output the num values in array data
 	// s is a string which precedes the array
@@ -41,7 +41,7 @@ dataset::dataset()
 	GetMemory("");   // initialise all relevant memory to 0
 }
 
-dataset::dataset (char *filename, char *name) {
+dataset::dataset (const char *filename, const char *name) {
 	// constructor where argument is name of file which contains data
 	// this opens files, initialises the number of inputs, etc
 	// creates space for the data
@@ -80,7 +80,7 @@ dataset::dataset (char *filename, char *name) {
 	else GetMemory("");
 }
 
-dataset::dataset (int nin, int nout, int nset, double data[], char *name) {
+dataset::dataset (int nin, int nout, int nset, double data[], const char *name) {
 	// constructor to create dataset where raw data in array 
 	// arguments passed numbers of inputs, nin, outputs, nout, and in set, nset
 	// data is a large enough array
@@ -102,28 +102,30 @@ dataset::dataset (int nin, int nout, int nset, double data[], char *name) {
 }
 
 dataset::~dataset () {
-				// return memory to heap
-	 if (alldata != 0) delete [] alldata;
-	 if (errors != 0) delete [] errors;
-	 if (scaleddata != 0) delete [] scaleddata;
-	 if (dataname != 0) delete [] dataname; 
+				// return memory to heap : every array is in the one arena
+	 if (memory != 0) delete memory;
 }
 
-void dataset::GetMemory(char *name) {
+void dataset::GetMemory(const char *name) {
 		// create dynamic arrays for inputs, outputs, targets and SSEs
+		// all are carved from one arena, so there is a single allocation and nothing can leak
 	if (strlen(name)>0) {    // if valid data name, initialise memory
 		numinrow = numinputs + 2 * numoutputs;			// ie inputs, targets, outputs
-		alldata = new double [numinrow * numdataset];	// get memory for all data
-		errors = new double [numoutputs];					// and for SSEs
-		classifications = new double [numoutputs];		// and for % classifications
-		scaleddata = new double [numinrow];				// and for re-Scaled data
-		mindata = new double [numinrow];	// for min of all ins/targets/outputs
-		maxdata = new double [numinrow];	// for max of all ins/targets/outputs
+		memory = new Arena (Arena::Bytes((size_t) numinrow * numdataset)	// all data
+						  + 2 * Arena::Bytes(numoutputs)				// SSEs and % classifications
+						  + 3 * Arena::Bytes(numinrow)					// re-Scaled data, min and max
+						  + Arena::Bytes(strlen(name)+1, 1));			// name
+		alldata = memory->Doubles((size_t) numinrow * numdataset);	// get memory for all data
+		errors = memory->Doubles(numoutputs);				// and for SSEs
+		classifications = memory->Doubles(numoutputs);		// and for % classifications
+		scaleddata = memory->Doubles(numinrow);				// and for re-Scaled data
+		mindata = memory->Doubles(numinrow);	// for min of all ins/targets/outputs
+		maxdata = memory->Doubles(numinrow);	// for max of all ins/targets/outputs
 		for (int ct=0; ct<numinputs + numoutputs; ct++)	{	// set min/max to 0 so no scaling
 			mindata[ct] = 0;
 			maxdata[ct] = 0;
 		}
-		dataname = new char [strlen(name)+1];
+		dataname = memory->Chars(strlen(name)+1);
 		strcpy(dataname, name);		// give name of data 
     }
 	else {     // Just initialise all to null
@@ -135,8 +137,10 @@ void dataset::GetMemory(char *name) {
 		numinrow = numinputs + 2 * numoutputs;
 		alldata = 0;
 		errors = 0;
+		classifications = 0;
 		scaleddata = 0;
 		dataname = 0;
+		memory = 0;
 	}
 }
 
@@ -212,23 +216,13 @@ double * dataset::CalcSSE (void){
 }
 
 double * dataset:: CalcCorrectClassifications(void) {
-		// calculate and return sum of square of errors (targets-outouts)
-		// for each output
-  double *cops;	// pointer to outputs
-  double *ctars;	// and to targets
-  int ct, nct; 
+		// calculate and return address of array of % of correct classifications
+		// rescaling is done by the accumulator, once per row rather than per value
+	MetricsAccumulator metrics(*this);
 
-    for (ct=0; ct<numoutputs; ct++) 
-		classifications [ct] = 0;							// correct classifications = 0
-	for (nct=0; nct<numdataset; nct++) {
-		dcopy(numoutputs, CalcScaledData(nct, 'O'), &errors[0]);	// put scaled outputs in errors array
-		cops = &errors[0];											// point to it
-		ctars = CalcScaledData(nct, 'T');						// point to scaled targets
-		for (ct=0; ct<numoutputs; ct++) 
-			if (abs (*cops++ - *ctars++) < 0.001) classifications[ct] += 1;	// if scaled Target ~ Scaled Output
-	}
-    for (ct=0; ct<numoutputs; ct++) 
-		classifications[ct] = 100 * classifications[ct] / numdataset;			// divide by num in set
+	for (int nct=0; nct<numdataset; nct++)
+		metrics.Accumulate(GetNthOutputs(nct), GetNthTargets(nct));
+	dcopy(numoutputs, metrics.CalcCorrectClassifications(), classifications);
 	return &classifications[0];
 }
 
@@ -241,21 +235,106 @@ int minnum, maxnum;
 	   case 'O' :  minnum = numinputs+numoutputs; maxnum = minnum + numoutputs; break;
 	   case 'A' :  minnum = 0; maxnum = numinrow; break;
 	} 
-	for (int ct=minnum; ct<maxnum; ct++) {
-		scaleddata[ct-minnum] = dataline[ct];
-		if (datatype == 0) {
-			if (ct>=numinputs) {
-			   if (scaleddata[ct-minnum]<= 0.5) scaleddata[ct-minnum] = 0; else scaleddata[ct-minnum] = 1;
-			}
+	for (int ct=minnum; ct<maxnum; ct++) 
+		scaleddata[ct-minnum] = RescaleValue(ct, dataline[ct]);
+	return &scaleddata[0];
+}
+
+void dataset::GetScaling(DataScaling &scaling) {
+		// copy what is needed to scale raw inputs and rescale outputs as this set does
+	scaling.numinputs = numinputs;
+	scaling.numoutputs = numoutputs;
+	scaling.datatype = datatype;
+	scaling.mindata.assign(numinputs + numoutputs, 0.0);
+	scaling.maxdata.assign(numinputs + numoutputs, 0.0);
+	for (int ct=0; (ct<numinputs + numoutputs) && (mindata != 0); ct++) {
+		scaling.mindata[ct] = mindata[ct];
+		scaling.maxdata[ct] = maxdata[ct];
+	}
+}
+
+void DataScaling::ScaleInputs(const double raw[], double scaled[]) const {
+		// scale as ScaleInsTargets does for the inputs of each item
+	for (int ct=0; ct<numinputs; ct++) {
+		if (!mindata.empty() && (maxdata[ct] > mindata[ct]))
+			scaled[ct] = 0.1 + 0.8 * (raw[ct] - mindata[ct]) / (maxdata[ct] - mindata[ct]);
+		else scaled[ct] = raw[ct];
+	}
+}
+
+void DataScaling::RescaleOutputs(const double scaled[], double raw[]) const {
+		// rescale as RescaleValue does for the outputs, column numinputs + ct of a row
+	for (int ct=0; ct<numoutputs; ct++) {
+		double value = scaled[ct];
+		int column = numinputs + ct;
+		if (mindata.empty()) {}
+		else if (datatype == 0) {
+			if (value <= 0.5) value = 0; else value = 1;
 		}
 		else {
-			if (maxdata[ct] > mindata[ct]) 
-			   scaleddata[ct-minnum] = mindata[ct] + (scaleddata[ct-minnum]-0.1) * (maxdata[ct]-mindata[ct]) / 0.8;
-			if ( (datatype == 2) && (ct>=numinputs) )
-				scaleddata[ct-minnum] = floor(0.5+scaleddata[ct-minnum]);
+			if (maxdata[column] > mindata[column]) 
+			   value = mindata[column] + (value-0.1) * (maxdata[column]-mindata[column]) / 0.8;
+			if (datatype == 2)
+				value = floor(0.5+value);
 		}
+		raw[ct] = value;
 	}
-	return &scaleddata[0];
+}
+
+double dataset::RescaleValue(int column, double value) {
+		// rescale value as if it were the column-th entry of a row
+		// only reads the min/max of the set, so is safe to call from many threads
+	if (datatype == 0) {
+		if (column>=numinputs) {
+		   if (value <= 0.5) value = 0; else value = 1;
+		}
+	}
+	else {
+		if (maxdata[column] > mindata[column]) 
+		   value = mindata[column] + (value-0.1) * (maxdata[column]-mindata[column]) / 0.8;
+		if ( (datatype == 2) && (column>=numinputs) )
+			value = floor(0.5+value);
+	}
+	return value;
+}
+
+bool dataset::MakeOneHot (void) {
+		// the classes are the whole numbers from the min to the max of the target
+		// the inputs are already scaled, so are copied; targets and outputs are not scaled
+	if ( (datatype != 2) || (numoutputs != 1) || (mindata == 0) ) return false;
+	int firstclass = (int) floor(0.5 + mindata[numinputs]);
+	int numclasses = (int) floor(0.5 + maxdata[numinputs]) - firstclass + 1;
+	if (numclasses < 2) return false;
+
+	Arena *oldmemory = memory;		// keep the old arrays until all is copied
+	double *olddata = alldata;
+	double *oldmin = mindata, *oldmax = maxdata;
+	int oldinrow = numinrow;
+
+	numoutputs = numclasses;
+	GetMemory(dataname);			// the name is copied from the old arena
+	for (int ct=0; ct<numinrow; ct++) {
+		mindata[ct] = (ct < numinputs) ? oldmin[ct] : 0;
+		maxdata[ct] = (ct < numinputs) ? oldmax[ct] : 0;
+	}
+
+	for (int nd=0; nd<numdataset; nd++) {
+		double *oldrow = &olddata[nd * oldinrow];
+		double target = oldmin[numinputs] + (oldrow[numinputs]-0.1) * (oldmax[numinputs]-oldmin[numinputs]) / 0.8;
+		int theclass = (int) floor(0.5 + target) - firstclass;
+		if (theclass < 0) theclass = 0;
+		if (theclass >= numclasses) theclass = numclasses - 1;
+
+		dcopy(numinputs, oldrow, GetNthInputs(nd));
+		for (int ct=0; ct<numoutputs; ct++) {
+			GetNthTargets(nd)[ct] = (ct == theclass) ? 1 : 0;
+			GetNthOutputs(nd)[ct] = 0;
+		}
+	}
+
+	datatype = 3;
+	delete oldmemory;
+	return true;
 }
 
 double dataset::TotalSSE (void) {
@@ -281,7 +360,17 @@ int dataset::numData(void) {
 	return numdataset;
 }
 
-void dataset::printarray (char *s, char which, int n, int nl) {
+int dataset::numInRow(void) {
+		// return number of values in each row
+	return numinrow;
+}
+
+int dataset::dataType(void) {
+		// return datatype
+	return datatype;
+}
+
+void dataset::printarray (const char *s, char which, int n, int nl) {
 		// print s then specifc array and \n if nl
 		// if which is 'I' print inputs; if 'O' print outputs; 
 		//          if 'T print targets, if 'S' print SSEs
@@ -296,13 +385,13 @@ void dataset::printarray (char *s, char which, int n, int nl) {
 	case 's' :
 	case 'S' : arrout(s, numoutputs, CalcSSE(), nl); break;
 	case 'c' :
-	case 'C' : arrout(s, numoutputs, CalcCorrectClassifications(), nl); break;
+	case 'C' : arrout(s, (datatype == 3) ? 1 : numoutputs, CalcCorrectClassifications(), nl); break;		// one-hot: every output has the % of the whole class
 	case 'r' :
 	case 'R' : arrout(s, numoutputs, CalcScaledData(n, 'O'), nl); break;
 	}
 }
 
-void dataset::printdata (int showopt) {
+void dataset::printdata (int showopt, MetricsAccumulator *metrics) {
 	// pass a training set in data to network, show results
 	if (showopt > 0) {
 		cout << setw(1 + 8*numinputs) << "Inputs" 
@@ -318,34 +407,43 @@ void dataset::printdata (int showopt) {
 	  }
 	}
 	else  cout << dataname << " : ";
-	if (showopt >= 0 ) {
+	if ( (showopt >= 0) && (metrics != 0) ) {		// metrics found while outputs were calculated
+	  if (datatype < 2) metrics->printarray ("Mean Sum Square Errors are ", 'S', 1);
+	  if ( (datatype >= 2) || ( (datatype == 0) && (showopt > 0) ) ) metrics->printarray("% Correct Classifications ", 'C', 1);
+	}
+	else if (showopt >= 0 ) {
 	  if (datatype < 2) printarray ("Mean Sum Square Errors are ", 'S', 0, 1);
-	  if ( (datatype == 2) || ( (datatype == 0) && (showopt > 0) ) ) printarray("% Correct Classifications ", 'C', 0, 1);
+	  if ( (datatype >= 2) || ( (datatype == 0) && (showopt > 0) ) ) printarray("% Correct Classifications ", 'C', 0, 1);
 	}
 
 }
 
-void dataset::savedata (int goplot) {
+void dataset::savedata (int goplot, WriterFormat format) {
 		// save data set (ins, targets and outs)
-	ofstream datafile;				// define stream variable for data
-	int ct2;
-	char temp[80];
-	strcpy(temp, dataname);
-	strcat(temp, "full.txt");
-	datafile.open(temp);		// open file of given name
-	if (datafile.is_open())   {
-      datafile << numinputs << " " << numoutputs << " " << numdataset << "\n";
-      for (int ct=0; ct<numdataset; ct++) {
-	    CalcScaledData(ct, 'A');
-		for (ct2=0; ct2<numinrow; ct2++) datafile << scaleddata[ct2] << "\t";
-		datafile << "\n";
+		// rescaling is done here, one chunk of rows at a time, while the writer's thread
+		// formats and writes the previous chunks
+	if (dataname == 0) {
+		cout << "Unable to create file for unnamed data\n";
+		return;
+	}
+	string filename = string(dataname) + ((format == WRITER_TEXT) ? "full.txt" : "full.bin");
+	ResultWriter writer (filename.c_str(), numinrow, format);
+	if (writer.IsOpen())   {
+	  string header = to_string(numinputs) + " " + to_string(numoutputs) + " " + to_string(numdataset) + "\n";
+	  writer.WriteHeader(header.c_str());
+	  int ct = 0;
+	  while (ct < numdataset) {
+		WriterChunk *chunk = writer.GetChunk();
+		for ( ; (ct < numdataset) && (chunk->rows < chunk->capacity); ct++)
+			dcopy(numinrow, CalcScaledData(ct, 'A'), &chunk->values[numinrow * chunk->rows++]);
+		writer.Submit(chunk);
 	  } 
-	  datafile.close();
+	  writer.Close();
 	  if (goplot) {		// evoke tadpole.exe with name of file
-		  cout << "Invoke the tadpole program, select file " << dataname << "full.txt and plot response.\n" ;
+		  cout << "Invoke the tadpole program, select file " << filename << " and plot response.\n" ;
 	  }
 	}
-	else cout << "Unable to create " << temp << "\n";
+	else cout << "Unable to create " << filename << "\n";
 }
 
 #endif
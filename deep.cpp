@@ -0,0 +1,479 @@
+/*
+*	Library Module Implementing networks of any number of layers in contiguous buffers
+*/
+
+#ifndef DEEP_CPP
+#define DEEP_CPP
+
+#include "Header/library.h"
+
+
+// Implementation of DeepNetwork *****************************
+
+///<summary>
+/// Lays out the layers one after another in each buffer, all four buffers in one arena freed through memory
+///</summary>
+DeepNetwork::DeepNetwork (int numInputs, const vector<LayerSpec> &specs)
+	:LinearLayerNetwork (numInputs, specs[0].numNeurons, *new Arena (BufferBytes (numInputs, specs)))
+{
+	totalWeights = 0;
+	totalNeurons = 0;
+	widestHidden = 0;
+
+	for (size_t l=0; l < specs.size(); l++)
+	{
+		DeepLayer layer;
+
+		layer.numInputs = (l == 0) ? numInputs : specs[l - 1].numNeurons;
+		layer.numNeurons = specs[l].numNeurons;
+		layer.layerType = specs[l].layerType;
+		layer.weightStart = totalWeights;
+		layer.neuronStart = totalNeurons;
+		layer.kernels = FindLayerKernels (layer.numInputs, layer.numNeurons);
+
+		totalWeights += (layer.numInputs + 1) * layer.numNeurons;
+		totalNeurons += layer.numNeurons;
+		if (l + 1 < specs.size()) widestHidden = max (widestHidden, layer.numNeurons);
+
+		layers.push_back (layer);
+	}
+
+	allWeights = memory->Doubles (totalWeights);
+	allDeltaWeights = memory->Doubles (totalWeights);
+	allOutputs = memory->Doubles (totalNeurons);
+	allDeltas = memory->Doubles (totalNeurons);
+
+	//The first layer's arrays, used by the functions of LinearLayerNetwork, are the start of each buffer
+	weights = allWeights;
+	deltaWeights = allDeltaWeights;
+	outputs = allOutputs;
+	deltas = allDeltas;
+
+	//Changes in weights, outputs and deltas start at 0, as the arena is zeroed
+	for (int i=0; i < totalWeights; i++) allWeights[i] = myrand();
+}
+
+
+size_t DeepNetwork::BufferBytes (int numInputs, const vector<LayerSpec> &specs)
+{
+	size_t numWeights = 0, numNeurons = 0;
+
+	for (size_t l=0; l < specs.size(); l++)
+	{
+		numWeights += (size_t) (((l == 0) ? numInputs : specs[l - 1].numNeurons) + 1) * specs[l].numNeurons;
+		numNeurons += specs[l].numNeurons;
+	}
+
+	return 2 * Arena::Bytes (numWeights) + 2 * Arena::Bytes (numNeurons);
+}
+
+
+DeepNetwork::~DeepNetwork ()
+{
+	// the buffers are freed with memory, by the inherited destructor
+}
+
+
+///<summary>
+/// Sums the bias then each input times its weight, in the order WeightedSums does
+///</summary>
+void DeepNetwork::LayerSums (int layer, const double inputs[], double sums[])
+{
+	const DeepLayer &shape = layers[layer];
+	const double *layerWeights = &allWeights[shape.weightStart];
+
+	if (shape.kernels != 0)
+	{
+		PROFILE_KERNEL (depth + layer, PHASE_FORWARD);
+		shape.kernels->sums (layerWeights, inputs, sums);
+		return;
+	}
+
+	if (Pooled (shape.numInputs, shape.numNeurons))
+	{
+		PoolSums (layerWeights, shape.numInputs, shape.numNeurons, inputs, sums);
+		return;
+	}
+
+	for (int neuron=0; neuron < shape.numNeurons; neuron++)
+	{
+		double sum = *layerWeights++;
+
+		for (int ct=0; ct < shape.numInputs; ct++)
+			sum += inputs[ct] * *layerWeights++;
+
+		sums[neuron] = sum;
+	}
+}
+
+
+void DeepNetwork::ActivateLayer (int layer, double values[], int count)
+{
+	ActivateLayerValues (layers[layer].layerType, values, count, layers[layer].numNeurons);
+}
+
+
+void DeepNetwork::LayerDeltas (int layer, const double errors[], double layerDeltas[])
+{
+	const DeepLayer &shape = layers[layer];
+
+	LayerValueDeltas (shape.layerType, &allOutputs[shape.neuronStart], errors, layerDeltas, shape.numNeurons);
+}
+
+
+void DeepNetwork::ForwardLayers (int first)
+{
+	for (int l = first; l < (int) layers.size(); l++)
+	{
+		const DeepLayer &shape = layers[l];
+
+		PROFILE_PHASE (depth + l, PHASE_FORWARD, 2.0 * (shape.numInputs + 1) * shape.numNeurons);
+
+		double *layerOutputs = &allOutputs[shape.neuronStart];
+
+		LayerSums (l, &allOutputs[layers[l - 1].neuronStart], layerOutputs);
+		ActivateLayer (l, layerOutputs, shape.numNeurons);
+	}
+}
+
+
+///<summary>
+/// Each change in weight is found as LinearLayerNetwork::ChangeAllWeights finds it, the bias's input being 1
+///</summary>
+void DeepNetwork::ChangeLayers (int first, const double learningParameters[])
+{
+	for (int l = first; l < (int) layers.size(); l++)
+	{
+		const DeepLayer &shape = layers[l];
+
+		PROFILE_PHASE (depth + l, PHASE_WEIGHTS, 5.0 * (shape.numInputs + 1) * shape.numNeurons);
+
+		const double *inputs = &allOutputs[layers[l - 1].neuronStart];
+		const double *layerDeltas = &allDeltas[shape.neuronStart];
+
+		double *layerWeights = &allWeights[shape.weightStart];
+		double *layerDeltaWeights = &allDeltaWeights[shape.weightStart];
+
+		if (shape.kernels != 0)
+		{
+			PROFILE_KERNEL (depth + l, PHASE_WEIGHTS);
+			shape.kernels->change (inputs, layerDeltas, layerWeights, layerDeltaWeights, learningParameters);
+			continue;
+		}
+
+		if (Pooled (shape.numInputs, shape.numNeurons))
+		{
+			PoolChange (layerWeights, layerDeltaWeights, shape.numInputs, shape.numNeurons, inputs, layerDeltas, learningParameters);
+			continue;
+		}
+
+		for (int neuron=0; neuron < shape.numNeurons; neuron++)
+		{
+			double delta = layerDeltas[neuron];
+
+			*layerDeltaWeights = (delta * learningParameters[0]) + (*layerDeltaWeights * learningParameters[1]);
+			*layerWeights++ += *layerDeltaWeights++;
+
+			for (int ct=0; ct < shape.numInputs; ct++)
+			{
+				*layerDeltaWeights = (inputs[ct] * delta * learningParameters[0]) + (*layerDeltaWeights * learningParameters[1]);
+				*layerWeights++ += *layerDeltaWeights++;
+			}
+		}
+	}
+}
+
+
+void DeepNetwork::CalcOutputs (const double Inputs[])
+{
+	{
+		PROFILE_PHASE (depth, PHASE_FORWARD, 2.0 * numWeights);
+
+		WeightedSums (Inputs);
+		ActivateLayer (0, outputs, numNeurons);
+	}
+
+	ForwardLayers (1);
+}
+
+
+void DeepNetwork::Activate (double values[], int count)
+{
+	ActivateLayer (0, values, count);
+}
+
+
+void DeepNetwork::StoreOutputs (int n, dataset &data)
+{
+	PROFILE_PHASE (OutputDepth(), PHASE_STORE, 0);
+
+	data.SetNthOutputs (n, NetworkOutputs());
+}
+
+
+///<summary>
+/// The errors of a layer are the deltas of the layer after it through its weights. They are added up one neuron
+/// of that layer at a time, along its row of weights, which gives each error the same sum in the same order
+/// as PrevLayersErrors gives going down the columns. Each layer's errors are made in its deltas, then turned into deltas
+///</summary>
+void DeepNetwork::FindDeltas (const double Errors[])
+{
+	int last = (int) layers.size() - 1;
+
+	{
+		PROFILE_PHASE (depth + last, PHASE_DELTAS, 3.0 * layers[last].numNeurons);
+
+		LayerDeltas (last, Errors, &allDeltas[layers[last].neuronStart]);
+	}
+
+	for (int l = last - 1; l >= 0; l--)
+	{
+		const DeepLayer &next = layers[l + 1];
+
+		PROFILE_PHASE (depth + l, PHASE_DELTAS, 2.0 * next.numInputs * next.numNeurons);
+
+		double *errors = &allDeltas[layers[l].neuronStart];
+		const double *nextDeltas = &allDeltas[next.neuronStart];
+		const double *nextWeights = &allWeights[next.weightStart];
+
+		if (next.kernels != 0)
+		{
+			PROFILE_KERNEL (depth + l, PHASE_DELTAS);
+			next.kernels->errors (nextWeights, nextDeltas, errors);
+			LayerDeltas (l, errors, errors);
+			continue;
+		}
+
+		if (Pooled (next.numInputs, next.numNeurons))
+		{
+			PoolErrors (nextWeights, next.numInputs, next.numNeurons, nextDeltas, errors);
+			LayerDeltas (l, errors, errors);
+			continue;
+		}
+
+		for (int ct=0; ct < next.numInputs; ct++) errors[ct] = 0;
+
+		for (int neuron=0; neuron < next.numNeurons; neuron++)
+		{
+			//The bias weight has no layer before it
+			const double *neuronWeights = &nextWeights[neuron * (next.numInputs + 1) + 1];
+
+			for (int ct=0; ct < next.numInputs; ct++)
+				errors[ct] += nextDeltas[neuron] * neuronWeights[ct];
+		}
+
+		LayerDeltas (l, errors, errors);
+	}
+}
+
+
+void DeepNetwork::ChangeAllWeights (const double Inputs[], const double learningParameters[])
+{
+	LinearLayerNetwork::ChangeAllWeights (Inputs, learningParameters);
+
+	ChangeLayers (1, learningParameters);
+}
+
+
+void DeepNetwork::SparseCalcOutputs (const int columns[], const double values[], int count)
+{
+	{
+		PROFILE_PHASE (depth, PHASE_FORWARD, 2.0 * (count + 1) * numNeurons);
+
+		SparseWeightedSums (columns, values, count);
+		ActivateLayer (0, outputs, numNeurons);
+	}
+
+	ForwardLayers (1);
+}
+
+
+///<summary>
+/// This network has no next layer, so LinearLayerNetwork::SparseChangeWeights changes the first layer alone
+///</summary>
+void DeepNetwork::SparseChangeWeights (const int columns[], const double values[], int count, const double learningParameters[])
+{
+	LinearLayerNetwork::SparseChangeWeights (columns, values, count, learningParameters);
+
+	ChangeLayers (1, learningParameters);
+}
+
+
+double * DeepNetwork::NetworkOutputs ()
+{
+	return &allOutputs[layers.back().neuronStart];
+}
+
+
+void DeepNetwork::LayerArrays (int layer, double *&layerWeights, double *&layerDeltaWeights)
+{
+	layerWeights = &allWeights[layers[layer].weightStart];
+	layerDeltaWeights = &allDeltaWeights[layers[layer].weightStart];
+}
+
+
+///<summary>
+/// Each layer sums every row at once with BatchSums, then activates them all, as LinearLayerNetwork::ForwardBatch does for one layer
+///</summary>
+void DeepNetwork::ForwardBatch (const double inputs[], int numRows, double batchOutputs[], double workspace[])
+{
+	const double *layerInputs = inputs;
+	int last = (int) layers.size() - 1;
+
+	for (int l=0; l <= last; l++)
+	{
+		const DeepLayer &shape = layers[l];
+		double *layerOutputs = (l == last) ? batchOutputs : &workspace[(size_t) (l % 2) * numRows * widestHidden];
+
+		BatchSums (&allWeights[shape.weightStart], shape.numInputs, shape.numNeurons, layerInputs, numRows, layerOutputs);
+
+		ActivateLayer (l, layerOutputs, numRows * shape.numNeurons);
+
+		layerInputs = layerOutputs;
+	}
+}
+
+
+void DeepNetwork::ForwardLayerBatch (int layer, const double inputs[], int numRows, double layerOutputs[])
+{
+	const DeepLayer &shape = layers[layer];
+
+	BatchSums (&allWeights[shape.weightStart], shape.numInputs, shape.numNeurons, inputs, numRows, layerOutputs);
+
+	ActivateLayer (layer, layerOutputs, numRows * shape.numNeurons);
+}
+
+
+int DeepNetwork::BatchWorkspace (int numRows)
+{
+	return 2 * numRows * widestHidden;
+}
+
+
+void DeepNetwork::SetTheWeights (const double initialWeights[])
+{
+	dcopy (totalWeights, initialWeights, allWeights);
+}
+
+
+void DeepNetwork::SetTheDeltaWeights (const double initialDeltaWeights[])
+{
+	dcopy (totalWeights, initialDeltaWeights, allDeltaWeights);
+}
+
+
+void DeepNetwork::ReturnTheWeights (double theWeights[])
+{
+	dcopy (totalWeights, allWeights, theWeights);
+}
+
+
+void DeepNetwork::ReturnTheDeltaWeights (double theDeltaWeights[])
+{
+	dcopy (totalWeights, allDeltaWeights, theDeltaWeights);
+}
+
+
+int DeepNetwork::HowManyWeights ()
+{
+	return totalWeights;
+}
+
+
+int DeepNetwork::HowManyOutputs ()
+{
+	return layers.back().numNeurons;
+}
+
+
+char DeepNetwork::LayerType ()
+{
+	return layers[0].layerType;
+}
+
+
+int DeepNetwork::HowManyLayers ()
+{
+	return (int) layers.size();
+}
+
+
+void DeepNetwork::DescribeLayer (int layer, int &layerInputs, int &layerNeurons, char &layerType)
+{
+	layerInputs = layers[layer].numInputs;
+	layerNeurons = layers[layer].numNeurons;
+	layerType = layers[layer].layerType;
+}
+
+
+const char * DeepNetwork::LayerKernelName (int layer)
+{
+	return (layers[layer].kernels != 0) ? layers[layer].kernels->name : "generic";
+}
+
+
+// Building networks *****************************
+
+bool IsValidNetwork (const vector<LayerSpec> &specs)
+{
+	if (specs.empty() || (int) specs.size() > DEEP_MAX_LAYERS) return false;
+
+	for (size_t l=0; l < specs.size(); l++)
+	{
+		char type = specs[l].layerType;
+		bool isOutput = (l + 1 == specs.size());
+
+		if (specs[l].numNeurons <= 0) return false;
+
+		if (isOutput && type != 'S' && type != 'L' && type != 'C') return false;
+		if (!isOutput && type != 'M' && !IsHiddenActivation (type)) return false;
+	}
+
+	return true;
+}
+
+
+bool ParseLayers (const string &text, vector<LayerSpec> &specs)
+{
+	specs.clear();
+
+	const char *next = text.c_str();
+
+	while (*next != 0)
+	{
+		while (isspace (*next)) next++;
+
+		char *end;
+		long size = strtol (next, &end, 10);
+		if (end == next || size <= 0 || size > INT_MAX) return false;
+
+		next = end;
+		while (isspace (*next)) next++;
+
+		LayerSpec spec = { (int) size, (char) toupper (*next) };
+		if (!isalpha (*next)) return false;
+		specs.push_back (spec);
+
+		next++;
+		while (isspace (*next)) next++;
+
+		if (*next == ',' || *next == '-') next++;
+		else if (*next != 0) return false;
+	}
+
+	//A sigmoidal hidden layer has a next layer, so is of type 'M'
+	for (size_t l=0; l + 1 < specs.size(); l++)
+		if (specs[l].layerType == 'S') specs[l].layerType = 'M';
+
+	return IsValidNetwork (specs);
+}
+
+
+LinearLayerNetwork * MakeDeepNet (int numInputs, const vector<LayerSpec> &specs)
+{
+	if (numInputs <= 0 || !IsValidNetwork (specs)) return 0;
+
+	return new DeepNetwork (numInputs, specs);
+}
+
+#endif
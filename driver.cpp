@@ -0,0 +1,886 @@
+/*
+*	Library Module Implementing the headless experiment driver
+*/
+
+#ifndef DRIVER_CPP
+#define DRIVER_CPP
+
+#include "Header/library.h"
+
+
+void WriteJsonString (FILE *out, const string &text)
+{
+	fputc ('"', out);
+
+	for (size_t ct=0; ct < text.size(); ct++)
+	{
+		unsigned char c = text[ct];
+
+		if (c == '"' || c == '\\') fprintf (out, "\\%c", c);
+		else if (c < 0x20) fprintf (out, "\\u%04x", c);
+		else fputc (c, out);
+	}
+
+	fputc ('"', out);
+}
+
+
+void WriteJsonNumber (FILE *out, double value)
+{
+	if (isfinite (value)) fprintf (out, "%.10g", value);
+	else fputs ("null", out);
+}
+
+
+///<summary>
+/// Splits a comma-separated list into its items, dropping spaces
+///</summary>
+vector<string> SplitList (const string &list)
+{
+	vector<string> items (1);
+
+	for (size_t ct=0; ct < list.size(); ct++)
+	{
+		if (list[ct] == ',') items.push_back ("");
+		else if (!isspace (list[ct])) items.back() += list[ct];
+	}
+
+	return items;
+}
+
+
+///<summary>
+/// Parses a list of integers, such as "5,10,20" or "0..9", returning false if any item is not valid
+///</summary>
+bool ParseIntList (const string &list, vector<int> &values)
+{
+	values.clear();
+
+	vector<string> items = SplitList (list);
+
+	for (size_t i=0; i < items.size(); i++)
+	{
+		char *stop;
+		long low = strtol (items[i].c_str(), &stop, 10);
+		long high = low;
+
+		if (stop == items[i].c_str()) return false;
+		if (strncmp (stop, "..", 2) == 0)
+		{
+			const char *second = stop + 2;
+			high = strtol (second, &stop, 10);
+			if (stop == second || high < low) return false;
+		}
+		if (*stop != 0) return false;
+
+		for (long value = low; value <= high; value++) values.push_back ((int) value);
+	}
+
+	return true;
+}
+
+
+///<summary>
+/// Parses a list of numbers, such as "0.1,0.2", returning false if any item is not valid
+///</summary>
+bool ParseDoubleList (const string &list, vector<double> &values)
+{
+	values.clear();
+
+	vector<string> items = SplitList (list);
+
+	for (size_t i=0; i < items.size(); i++)
+	{
+		char *stop;
+		values.push_back (strtod (items[i].c_str(), &stop));
+
+		if (stop == items[i].c_str() || *stop != 0) return false;
+	}
+
+	return true;
+}
+
+
+// Implementation of ExperimentDriver *****************************
+
+///<summary>
+/// Defaults are those the menu starts with, training a multi-layer network on the iris set
+///</summary>
+ExperimentDriver::ExperimentDriver ()
+{
+	mode = "train";
+	networks = "N";
+	hiddens.assign (1, 10);
+	seeds.assign (1, 0);
+	learningRates.assign (1, 0.2);
+	momenta.assign (1, 0.0);
+
+	maxEpoch = 1001;
+	numFolds = 5;
+	batchSize = 1;
+	fineTuneEpochs = 0;
+	hugePages = false;
+	numThreads = thread::hardware_concurrency() > 0 ? thread::hardware_concurrency() : 1;
+
+	trainFile = "Resource/iristrain.txt";
+	testFile = "Resource/irisunseen.txt";
+	outputFile = "-";
+}
+
+
+bool ExperimentDriver::SetOption (const string &name, const string &value)
+{
+	bool valid = true;
+	vector<int> number;
+
+	if (name == "mode")
+	{
+		valid = (value == "train" || value == "sparse" || value == "crossval");
+		if (valid) mode = value;
+	}
+	else if (name == "net")
+	{
+		networks.clear();
+		for (size_t ct=0; ct < value.size(); ct++)
+		{
+			char option = toupper (value[ct]);
+			if (option == 'L' || option == 'S' || option == 'N' || option == 'C' || IsHiddenActivation (option)) networks += option;
+			else if (option != ',' && !isspace (option)) valid = false;
+		}
+		valid = valid && !networks.empty();
+	}
+	else if (name == "layers")
+	{
+		//Such as "20T,10R,3S", checked as IsValidNetwork() does; the last layer's size must be the outputs of the data
+		valid = ParseLayers (value, layers);
+		layerText = valid ? value : "";
+		if (!valid) layers.clear();
+	}
+	else if (name == "hidden")
+		valid = ParseIntList (value, hiddens) && hiddens.size() > 0 && *min_element (hiddens.begin(), hiddens.end()) > 0;
+	else if (name == "seed")
+		valid = ParseIntList (value, seeds) && seeds.size() > 0;
+	else if (name == "lr")
+		valid = ParseDoubleList (value, learningRates);
+	else if (name == "momentum")
+		valid = ParseDoubleList (value, momenta);
+	else if (name == "prune")
+	{
+		valid = ParseDoubleList (value, pruneRatios);
+		for (size_t ct=0; ct < pruneRatios.size(); ct++) valid = valid && pruneRatios[ct] >= 0 && pruneRatios[ct] <= 1;
+
+		//Pruning only ever prunes more, so the ratios are taken smallest first
+		sort (pruneRatios.begin(), pruneRatios.end());
+	}
+	else if (name == "epochs" || name == "folds" || name == "threads" || name == "finetune" || name == "batch")
+	{
+		//Single whole numbers: at least 0 epochs, 2 folds, 1 thread and 1 row a batch
+		int least = (name == "epochs" || name == "finetune") ? 0 : (name == "folds") ? 2 : 1;
+		
+		valid = ParseIntList (value, number) && number.size() == 1 && number[0] >= least;
+		
+		if (valid && name == "epochs") maxEpoch = number[0];
+		if (valid && name == "batch") batchSize = number[0];
+		if (valid && name == "finetune") fineTuneEpochs = number[0];
+		if (valid && name == "folds") numFolds = number[0];
+		if (valid && name == "threads") numThreads = number[0];
+	}
+	else if (name == "hugepages")
+	{
+		valid = (value == "on" || value == "off");
+		hugePages = (value == "on");
+	}
+	else if (name == "train")
+		trainFile = value;
+	else if (name == "test")
+		testFile = value;
+	else if (name == "output")
+		outputFile = value;
+	else if (name == "checkpoints")
+		checkpointFolder = value;
+	else if (name == "config")
+		return ReadConfig (value.c_str());
+	else
+	{
+		error = "Unknown option: " + name;
+		return false;
+	}
+
+	if (!valid) error = "Not a valid value for " + name + ": " + value;
+
+	return valid;
+}
+
+
+bool ExperimentDriver::ParseArguments (int argc, char *argv[], int first)
+{
+	for (int arg = first; arg < argc; arg++)
+	{
+		string name = argv[arg];
+
+		if (name.compare (0, 2, "--") != 0)
+		{
+			error = "Expected an option starting with --, not " + name;
+			return false;
+		}
+		name.erase (0, 2);
+
+		string value;
+		size_t equals = name.find ('=');
+
+		if (equals != string::npos)
+		{
+			value = name.substr (equals + 1);
+			name.erase (equals);
+		}
+		else if (arg + 1 < argc) value = argv[++arg];
+		else
+		{
+			error = "No value for " + name;
+			return false;
+		}
+
+		if (!SetOption (name, value)) return false;
+	}
+
+	return true;
+}
+
+
+bool ExperimentDriver::ReadConfig (const char *filename)
+{
+	ifstream config (filename);
+
+	if (!config.is_open())
+	{
+		error = string("Unable to open config file ") + filename;
+		return false;
+	}
+
+	string line;
+
+	while (getline (config, line))
+	{
+		line = line.substr (0, line.find ('#'));
+
+		size_t equals = line.find ('=');
+		if (equals == string::npos)
+		{
+			if (line.find_first_not_of (" \t\r") == string::npos) continue;
+
+			error = "Expected name = value, not " + line;
+			return false;
+		}
+
+		string name = line.substr (0, equals), value = line.substr (equals + 1);
+
+		//Spaces round the name and value are dropped
+		name.erase (name.find_last_not_of (" \t\r") + 1);
+		name.erase (0, name.find_first_not_of (" \t"));
+		value.erase (value.find_last_not_of (" \t\r") + 1);
+		value.erase (0, value.find_first_not_of (" \t"));
+
+		if (!SetOption (name, value)) return false;
+	}
+
+	return true;
+}
+
+
+void ExperimentDriver::MakeRuns ()
+{
+	runs.clear();
+
+	//Layers, when given, are run instead of the networks, and have their sizes already
+	string swept = layers.empty() ? networks : "D";
+
+	for (size_t n=0; n < swept.size(); n++)
+		for (size_t h=0; h < hiddens.size(); h++)
+		{
+			//Single layers have no hidden nodes, so are run once whatever the hidden sizes
+			bool multiLayer = (swept[n] == 'N') || (swept[n] == 'C') || IsHiddenActivation (swept[n]);
+			if (!multiLayer && h > 0) continue;
+
+			for (size_t s=0; s < seeds.size(); s++)
+				for (size_t l=0; l < learningRates.size(); l++)
+					for (size_t m=0; m < momenta.size(); m++)
+					{
+						RunConfig run;
+						run.networkOption = swept[n];
+						run.hiddenNodes = multiLayer ? hiddens[h] : 0;
+						run.seed = seeds[s];
+						run.learningParameters[0] = learningRates[l];
+						run.learningParameters[1] = momenta[m];
+
+						runs.push_back (run);
+					}
+		}
+}
+
+
+LinearLayerNetwork * ExperimentDriver::MakeRunNet (const RunConfig &config, dataset &data)
+{
+	if (config.networkOption == 'D') return MakeDeepNet (data.numIns(), layers);
+
+	return MakeNet (config.networkOption, config.hiddenNodes, data);
+}
+
+
+bool ExperimentDriver::IsOneHot (const RunConfig &config)
+{
+	return (config.networkOption == 'C') || (config.networkOption == 'D' && layers.back().layerType == 'C');
+}
+
+
+///<summary>
+/// Loads the data sets and opens the output, then runs in the chosen mode and ends with a summary line
+///</summary>
+int ExperimentDriver::Run ()
+{
+	MakeRuns();
+
+	//Set before any arena is made, so the data sets and every network are backed as asked
+	Arena::SetHugePages (hugePages);
+
+	if (mode == "sparse") return RunSparseSets();
+
+	dataset train (trainFile.c_str(), "Training_set");
+
+	if (train.numIns() == 0)
+	{
+		error = "Unable to read " + trainFile;
+		return 1;
+	}
+
+	//Runs index the first row of each set, and cross-validation holds at least one row out of each of two folds
+	if (train.numData() < ((mode == "crossval") ? 2 : 1))
+	{
+		error = trainFile + " has too few rows for " + mode;
+		return 1;
+	}
+
+	//The test set is optional, and unused by cross-validation
+	dataset *test = 0;
+
+	if (mode == "train" && !testFile.empty())
+	{
+		test = new dataset (testFile.c_str(), "Test_set");
+
+		if (test->numIns() != train.numIns() || test->numOuts() != train.numOuts() || test->numData() == 0)
+		{
+			error = "Unable to read " + testFile + ", or it has no rows, or its sizes differ from " + trainFile;
+			delete test;
+			return 1;
+		}
+	}
+
+	//Softmax classifiers learn one target per class, as classtest trains them, so are given one-hot copies of the sets
+	dataset *oneHotTrain = 0, *oneHotTest = 0;
+	bool anyOneHot = false;
+
+	for (size_t run=0; run < runs.size(); run++) anyOneHot = anyOneHot || IsOneHot (runs[run]);
+
+	if (anyOneHot)
+	{
+		oneHotTrain = new dataset (trainFile.c_str(), "Training_set");
+		if (test != 0) oneHotTest = new dataset (testFile.c_str(), "Test_set");
+
+		if (!oneHotTrain->MakeOneHot() || (oneHotTest != 0 && (!oneHotTest->MakeOneHot() || oneHotTest->numOuts() != oneHotTrain->numOuts())))
+			error = "Classes of " + trainFile + ((test != 0) ? " and " + testFile : "") + " cannot be one-hot, as a softmax network needs";
+	}
+
+	//The last of the layers gives every output of the data
+	if (!layers.empty() && error.empty())
+	{
+		int numOuts = (layers.back().layerType == 'C') ? oneHotTrain->numOuts() : train.numOuts();
+
+		if (layers.back().numNeurons != numOuts)
+			error = "Last of the layers " + layerText + " has " + to_string (layers.back().numNeurons) + " neurons, but "
+				  + trainFile + " has " + to_string (numOuts) + " outputs";
+	}
+
+	FILE *out = error.empty() ? OpenOutput() : 0;
+
+	if (out == 0)
+	{
+		delete test;
+		delete oneHotTrain;
+		delete oneHotTest;
+		return 1;
+	}
+
+	PhaseProfile::Reset();
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	if (mode == "train") RunTraining (out, train, test, oneHotTrain, oneHotTest);
+	else RunCrossValidation (out, train, oneHotTrain);
+
+	WriteSummary (out, chrono::duration<double> (chrono::steady_clock::now() - start).count());
+
+	delete test;
+	delete oneHotTrain;
+	delete oneHotTest;
+
+	return 0;
+}
+
+
+///<summary>
+/// Networks of any depth lay out their first layer apart (see DeepNetwork), and pruning fine-tunes on a dense set,
+/// so both are refused; batches are not used, as AdaptSparse changes the weights after every row
+///</summary>
+int ExperimentDriver::RunSparseSets ()
+{
+	if (!layers.empty() || !pruneRatios.empty())
+	{
+		error = "--layers and --prune are not run in sparse mode";
+		return 1;
+	}
+
+	SparseDataset train (trainFile.c_str(), "Training_set");
+
+	if (train.numIns() == 0 || train.numData() == 0)
+	{
+		error = "Unable to read " + trainFile + " as a sparse set, or it has no rows";
+		return 1;
+	}
+
+	SparseDataset *test = 0;
+
+	if (!testFile.empty())
+	{
+		test = new SparseDataset (testFile.c_str(), "Test_set");
+
+		if (test->numIns() != train.numIns() || test->numOuts() != train.numOuts() || test->numData() == 0)
+		{
+			error = "Unable to read " + testFile + " as a sparse set, or it has no rows, or its sizes differ from " + trainFile;
+			delete test;
+			return 1;
+		}
+	}
+
+	FILE *out = OpenOutput();
+
+	if (out == 0)
+	{
+		delete test;
+		return 1;
+	}
+
+	PhaseProfile::Reset();
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	RunSparse (out, train, test);
+
+	WriteSummary (out, chrono::duration<double> (chrono::steady_clock::now() - start).count());
+
+	delete test;
+
+	return 0;
+}
+
+
+FILE * ExperimentDriver::OpenOutput ()
+{
+	FILE *out = (outputFile == "-") ? stdout : fopen (outputFile.c_str(), "w");
+
+	if (out == 0) error = "Unable to create " + outputFile;
+
+	return out;
+}
+
+
+void ExperimentDriver::WriteSummary (FILE *out, double seconds)
+{
+	fprintf (out, "{\"type\":\"summary\",\"mode\":");
+	WriteJsonString (out, mode);
+	fprintf (out, ",\"runs\":%d,\"threads\":%d,\"huge_pages\":%s,\"seconds\":", (int) runs.size(), numThreads, hugePages ? "true" : "false");
+	WriteJsonNumber (out, seconds);
+	fprintf (out, ",\"runs_per_second\":");
+	WriteJsonNumber (out, runs.size() / seconds);
+
+	//Time taken by each phase of each layer over every run, when built with ANN_PROFILE
+	if (PhaseProfile::Enabled())
+	{
+		fprintf (out, ",\"profile\":");
+		PhaseProfile::WriteJson (out);
+	}
+
+	fprintf (out, "}\n");
+
+	if (out != stdout) fclose (out);
+}
+
+
+void ExperimentDriver::WriteConfig (FILE *out, int run)
+{
+	RunConfig &config = runs[run];
+
+	fprintf (out, "{\"type\":\"run\",\"mode\":");
+	WriteJsonString (out, mode);
+	fprintf (out, ",\"run\":%d,\"net\":\"%c\",\"hidden\":%d,\"seed\":%d,\"learning_rate\":", run, config.networkOption, config.hiddenNodes, config.seed);
+	WriteJsonNumber (out, config.learningParameters[0]);
+	fprintf (out, ",\"momentum\":");
+	WriteJsonNumber (out, config.learningParameters[1]);
+	fprintf (out, ",\"epochs\":%d,\"batch\":%d,\"train\":", maxEpoch, (mode == "train") ? batchSize : 1);
+	WriteJsonString (out, trainFile);
+
+	if (config.networkOption == 'D')
+	{
+		fprintf (out, ",\"layers\":");
+		WriteJsonString (out, layerText);
+	}
+}
+
+
+///<summary>
+/// Workers take runs in turn. Each network is made right after seeding the worker's own generator, so its weights
+/// depend only on its seed and no worker waits on another; training uses AdaptRows (or AdaptBatch) and EvaluateRows,
+/// which only read the shared data sets
+///</summary>
+void ExperimentDriver::RunTraining (FILE *out, dataset &train, dataset *test, dataset *oneHotTrain, dataset *oneHotTest)
+{
+	atomic<int> nextRun (0);
+	mutex writeLock;
+
+	vector<int> allRows (train.numData());
+	for (int row=0; row < train.numData(); row++) allRows[row] = row;
+
+	vector<int> testRows ((test != 0) ? test->numData() : 0);
+	for (size_t row=0; row < testRows.size(); row++) testRows[row] = (int) row;
+
+	vector<thread> workers;
+	int numWorkers = min (numThreads, (int) runs.size());
+
+	for (int w=0; w < numWorkers; w++)
+	{
+		workers.push_back (thread ([&] () {
+
+			for (int run = nextRun++; run < (int) runs.size(); run = nextRun++)
+			{
+				RunConfig &config = runs[run];
+
+				//The copies hold the same rows, so the row lists are those of either
+				bool oneHot = IsOneHot (config);
+				dataset &trainSet = oneHot ? *oneHotTrain : train;
+				dataset *testSet = oneHot ? oneHotTest : test;
+
+				int numOuts = trainSet.numOuts();
+				vector<double> sse (numOuts), correct (numOuts);
+
+				SeedThreadRandom (config.seed);
+				LinearLayerNetwork *net = MakeRunNet (config, trainSet);
+
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+				for (int epoch=0; epoch < maxEpoch; epoch++)
+				{
+					if (batchSize > 1) net->AdaptBatch (trainSet, &allRows[0], trainSet.numData(), batchSize, config.learningParameters);
+					else net->AdaptRows (trainSet, &allRows[0], trainSet.numData(), config.learningParameters);
+				}
+
+				double trainSeconds = chrono::duration<double> (chrono::steady_clock::now() - start).count();
+
+				//Sum of the SSE of each output, and mean % correct over the outputs, as CrossValidator reports
+				double trainSSE = 0, trainCorrect = 0, testSSE = 0, testCorrect = 0;
+
+				net->EvaluateRows (trainSet, &allRows[0], trainSet.numData(), &sse[0], &correct[0]);
+				for (int ct=0; ct < numOuts; ct++) { trainSSE += sse[ct]; trainCorrect += correct[ct] / numOuts; }
+
+				if (testSet != 0)
+				{
+					net->EvaluateRows (*testSet, &testRows[0], testSet->numData(), &sse[0], &correct[0]);
+					for (int ct=0; ct < numOuts; ct++) { testSSE += sse[ct]; testCorrect += correct[ct] / numOuts; }
+				}
+
+				string checkpoint;
+				if (!checkpointFolder.empty())
+				{
+					TrainingState state = { maxEpoch, { config.learningParameters[0], config.learningParameters[1] }, 0, ORDER_FILE };
+
+					checkpoint = checkpointFolder + "/run" + to_string(run) + ".ckpt";
+					if (!Checkpoint::Save (checkpoint.c_str(), net, state, &trainSet)) checkpoint.clear();
+				}
+
+				double seconds = chrono::duration<double> (chrono::steady_clock::now() - start).count();
+
+				//Pruned in steps, each fine-tuned on the training set and measured on the test set
+				vector<PruneResult> pruned;
+				WeightPruner pruner (net);
+
+				dataset &measured = (testSet != 0) ? *testSet : trainSet;
+				vector<int> &measuredRows = (testSet != 0) ? testRows : allRows;
+
+				for (size_t p=0; p < pruneRatios.size(); p++)
+				{
+					PruneResult result = { pruneRatios[p], 0, 0, 0, 0 };
+
+					pruner.PruneRatio (net, pruneRatios[p], PRUNE_GLOBAL);
+					pruner.FineTune (net, trainSet, config.learningParameters, fineTuneEpochs);
+
+					net->EvaluateRows (measured, &measuredRows[0], measured.numData(), &sse[0], &correct[0]);
+					for (int ct=0; ct < numOuts; ct++) { result.sse += sse[ct]; result.correct += correct[ct] / numOuts; }
+
+					result.kept = pruner.HowManyKept();
+					result.bytes = SparseWeightNetwork (net).StoredBytes();
+
+					pruned.push_back (result);
+				}
+
+				delete net;
+
+				lock_guard<mutex> guard (writeLock);
+
+				WriteConfig (out, run);
+				fprintf (out, ",\"train_sse\":");
+				WriteJsonNumber (out, trainSSE);
+				fprintf (out, ",\"train_correct\":");
+				WriteJsonNumber (out, trainCorrect);
+
+				if (test != 0)
+				{
+					fprintf (out, ",\"test\":");
+					WriteJsonString (out, testFile);
+					fprintf (out, ",\"test_sse\":");
+					WriteJsonNumber (out, testSSE);
+					fprintf (out, ",\"test_correct\":");
+					WriteJsonNumber (out, testCorrect);
+				}
+
+				fprintf (out, ",\"seconds\":");
+				WriteJsonNumber (out, seconds);
+				fprintf (out, ",\"epochs_per_second\":");
+				WriteJsonNumber (out, maxEpoch / trainSeconds);
+				fprintf (out, ",\"rows_per_second\":");
+				WriteJsonNumber (out, (double) maxEpoch * train.numData() / trainSeconds);
+
+				if (!checkpoint.empty())
+				{
+					fprintf (out, ",\"checkpoint\":");
+					WriteJsonString (out, checkpoint);
+				}
+
+				if (!pruned.empty())
+				{
+					fprintf (out, ",\"finetune\":%d,\"pruned\":[", fineTuneEpochs);
+
+					for (size_t p=0; p < pruned.size(); p++)
+					{
+						fprintf (out, "%s{\"ratio\":", (p > 0) ? "," : "");
+						WriteJsonNumber (out, pruned[p].ratio);
+						fprintf (out, ",\"kept\":%d,\"bytes\":%lld,\"sse\":", pruned[p].kept, pruned[p].bytes);
+						WriteJsonNumber (out, pruned[p].sse);
+						fprintf (out, ",\"correct\":");
+						WriteJsonNumber (out, pruned[p].correct);
+						fprintf (out, "}");
+					}
+
+					fprintf (out, "]");
+				}
+
+				fprintf (out, "}\n");
+				fflush (out);
+			}
+		}));
+	}
+
+	for (int w=0; w < numWorkers; w++) workers[w].join();
+}
+
+
+///<summary>
+/// Workers take runs in turn, as in RunTraining. The SSE of each set is found by ComputeSparse after training,
+/// as SparseDataset keeps no count of correct classifications
+///</summary>
+void ExperimentDriver::RunSparse (FILE *out, SparseDataset &train, SparseDataset *test)
+{
+	atomic<int> nextRun (0);
+	mutex writeLock;
+
+	vector<thread> workers;
+	int numWorkers = min (numThreads, (int) runs.size());
+
+	for (int w=0; w < numWorkers; w++)
+	{
+		workers.push_back (thread ([&] () {
+
+			SparseDataset trainSet = train;
+			SparseDataset *testSet = (test != 0) ? new SparseDataset (*test) : 0;
+
+			for (int run = nextRun++; run < (int) runs.size(); run = nextRun++)
+			{
+				RunConfig &config = runs[run];
+
+				SeedThreadRandom (config.seed);
+				LinearLayerNetwork *net = MakeNet (config.networkOption, trainSet.numIns(), config.hiddenNodes, trainSet.numOuts());
+
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+				for (int epoch=0; epoch < maxEpoch; epoch++) net->AdaptSparse (trainSet, config.learningParameters);
+
+				double trainSeconds = chrono::duration<double> (chrono::steady_clock::now() - start).count();
+
+				net->ComputeSparse (trainSet);
+				double trainSSE = trainSet.TotalSSE(), testSSE = 0;
+
+				if (testSet != 0)
+				{
+					net->ComputeSparse (*testSet);
+					testSSE = testSet->TotalSSE();
+				}
+
+				string checkpoint;
+				if (!checkpointFolder.empty())
+				{
+					TrainingState state = { maxEpoch, { config.learningParameters[0], config.learningParameters[1] }, 0, ORDER_FILE };
+
+					checkpoint = checkpointFolder + "/run" + to_string(run) + ".ckpt";
+					if (!Checkpoint::Save (checkpoint.c_str(), net, state)) checkpoint.clear();
+				}
+
+				double seconds = chrono::duration<double> (chrono::steady_clock::now() - start).count();
+
+				delete net;
+
+				lock_guard<mutex> guard (writeLock);
+
+				WriteConfig (out, run);
+				fprintf (out, ",\"non_zeros\":%lld,\"train_sse\":", trainSet.NonZeros());
+				WriteJsonNumber (out, trainSSE);
+
+				if (testSet != 0)
+				{
+					fprintf (out, ",\"test\":");
+					WriteJsonString (out, testFile);
+					fprintf (out, ",\"test_sse\":");
+					WriteJsonNumber (out, testSSE);
+				}
+
+				fprintf (out, ",\"seconds\":");
+				WriteJsonNumber (out, seconds);
+				fprintf (out, ",\"epochs_per_second\":");
+				WriteJsonNumber (out, maxEpoch / trainSeconds);
+				fprintf (out, ",\"rows_per_second\":");
+				WriteJsonNumber (out, (double) maxEpoch * trainSet.numData() / trainSeconds);
+
+				if (!checkpoint.empty())
+				{
+					fprintf (out, ",\"checkpoint\":");
+					WriteJsonString (out, checkpoint);
+				}
+
+				fprintf (out, "}\n");
+				fflush (out);
+			}
+
+			delete testSet;
+		}));
+	}
+
+	for (int w=0; w < numWorkers; w++) workers[w].join();
+}
+
+
+void ExperimentDriver::RunCrossValidation (FILE *out, dataset &data, dataset *oneHotData)
+{
+	for (int run=0; run < (int) runs.size(); run++)
+	{
+		RunConfig &config = runs[run];
+		dataset &folded = IsOneHot (config) ? *oneHotData : data;
+
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+		CrossValidator validator (folded, numFolds, numThreads, config.networkOption, config.hiddenNodes, maxEpoch, config.learningParameters);
+		if (config.networkOption == 'D') validator.UseLayers (layers);
+		validator.Run (config.seed);
+
+		double seconds = chrono::duration<double> (chrono::steady_clock::now() - start).count();
+
+		//The validator may use fewer folds than asked, if there are fewer rows
+		int folds = validator.HowManyFolds();
+
+		double meanSSE = 0, meanCorrect = 0, varSSE = 0, varCorrect = 0;
+
+		for (int fold=0; fold < folds; fold++)
+		{
+			meanSSE += validator.GetFold(fold).sse / folds;
+			meanCorrect += validator.GetFold(fold).correct / folds;
+		}
+
+		for (int fold=0; fold < folds; fold++)
+		{
+			varSSE += pow (validator.GetFold(fold).sse - meanSSE, 2) / (folds - 1);
+			varCorrect += pow (validator.GetFold(fold).correct - meanCorrect, 2) / (folds - 1);
+		}
+
+		WriteConfig (out, run);
+		fprintf (out, ",\"folds\":%d,\"sse_mean\":", folds);
+		WriteJsonNumber (out, meanSSE);
+		fprintf (out, ",\"sse_variance\":");
+		WriteJsonNumber (out, varSSE);
+		fprintf (out, ",\"correct_mean\":");
+		WriteJsonNumber (out, meanCorrect);
+		fprintf (out, ",\"correct_variance\":");
+		WriteJsonNumber (out, varCorrect);
+
+		fprintf (out, ",\"fold_sse\":[");
+		for (int fold=0; fold < folds; fold++)
+		{
+			if (fold > 0) fputc (',', out);
+			WriteJsonNumber (out, validator.GetFold(fold).sse);
+		}
+		fprintf (out, "],\"fold_correct\":[");
+		for (int fold=0; fold < folds; fold++)
+		{
+			if (fold > 0) fputc (',', out);
+			WriteJsonNumber (out, validator.GetFold(fold).correct);
+		}
+		fprintf (out, "],\"seconds\":");
+		WriteJsonNumber (out, seconds);
+		fprintf (out, "}\n");
+		fflush (out);
+	}
+}
+
+
+const char * ExperimentDriver::Error ()
+{
+	return error.c_str();
+}
+
+
+void ExperimentDriver::PrintUsage (const char *program)
+{
+	cout << "Usage: " << program << " run [--name value ...]" << endl
+		 << "Lists are comma-separated; integer lists may hold ranges such as 0..9. Options:" << endl
+		 << "  --mode train|sparse|crossval" << endl
+		 << "                            train on one set and test on another, the same on sets of sparse inputs" << endl
+		 << "                            (lines of targets then column:value pairs), or k-fold cross-validate [train]" << endl
+		 << "  --net L,S,N,T,R,E,H,C     networks: linear, sigmoidal, multi-layer, multi-layer with a tanh, ReLU," << endl
+		 << "                            leaky ReLU or hard sigmoid hidden layer, and softmax classifier trained" << endl
+		 << "                            on one-hot classes [N]" << endl
+		 << "  --hidden list             hidden nodes of multi-layer networks [10]" << endl
+		 << "  --layers spec             a network of any depth instead of --net and --hidden, as size and type" << endl
+		 << "                            of each layer, such as 20T,10R,3S; hidden types M,T,R,E,H, output S,L,C" << endl
+		 << "  --seed list               seeds of the random weights [0]" << endl
+		 << "  --lr list                 learning rates [0.2]" << endl
+		 << "  --momentum list           momenta [0]" << endl
+		 << "  --epochs n                epochs of each run [1001]" << endl
+		 << "  --batch n                 rows of each mini-batch in train mode, weights changed by their mean" << endl
+		 << "                            gradient; 1 changes them after every row [1]" << endl
+		 << "  --folds n                 folds for crossval [5]" << endl
+		 << "  --threads n               runs (or folds) trained at once [cores]" << endl
+		 << "  --hugepages on|off        back the arrays of large data sets and networks with huge pages [off]" << endl
+		 << "  --train file              training set [Resource/iristrain.txt]" << endl
+		 << "  --test file               test set, \"\" for none [Resource/irisunseen.txt]" << endl
+		 << "  --output file             JSON lines, - for the console [-]" << endl
+		 << "  --checkpoints folder      save each trained run as folder/run<n>.ckpt" << endl
+		 << "  --prune list              after training, prune the smallest weights to each ratio in turn," << endl
+		 << "                            reporting the weights kept, their bytes, and the test SSE [none]" << endl
+		 << "  --finetune n              epochs of training after each pruning, pruned weights kept at 0 [0]" << endl
+		 << "  --config file             read name = value lines, # for comments" << endl;
+}
+
+#endif
@@ -0,0 +1,143 @@
+/*
+*	Library Module Implementing the cache-blocked matrix multiply
+*/
+
+#ifndef GEMM_CPP
+#define GEMM_CPP
+
+#include "Header/library.h"
+
+//Two doubles, added and multiplied together in one SSE2 instruction
+typedef double GemmPair __attribute__ ((vector_size (16)));
+
+
+// Implementation of GemmEngine *****************************
+
+GemmEngine::GemmEngine ()
+	:buffers (Arena::Bytes (GEMM_MC * GEMM_KC) + Arena::Bytes (GEMM_KC * GEMM_NC))
+{
+	packedA = buffers.Doubles (GEMM_MC * GEMM_KC);
+	packedB = buffers.Doubles (GEMM_KC * GEMM_NC);
+}
+
+
+void GemmEngine::PackA (bool transA, const double A[], int lda, int rows, int depth)
+{
+	double *packed = packedA;
+
+	for (int first=0; first < rows; first += GEMM_MR)
+		for (int p=0; p < depth; p++)
+			for (int i=0; i < GEMM_MR; i++, packed++)
+			{
+				int row = first + i;
+
+				if (row >= rows) *packed = 0;
+				else *packed = transA ? A[(size_t) p * lda + row] : A[(size_t) row * lda + p];
+			}
+}
+
+
+void GemmEngine::PackB (bool transB, const double B[], int ldb, int depth, int columns)
+{
+	double *packed = packedB;
+
+	for (int first=0; first < columns; first += GEMM_NR)
+		for (int p=0; p < depth; p++)
+			for (int j=0; j < GEMM_NR; j++, packed++)
+			{
+				int column = first + j;
+
+				if (column >= columns) *packed = 0;
+				else *packed = transB ? B[(size_t) column * ldb + p] : B[(size_t) p * ldb + column];
+			}
+}
+
+
+///<summary>
+/// The tile is loaded from C, so each element goes on adding one product after another, as a plain loop adds them.
+/// Each step broadcasts one value of the A sliver against the B sliver, two columns to an instruction
+///</summary>
+void GemmEngine::Kernel (int depth, const double a[], const double b[], double C[], int ldc, int rows, int columns)
+{
+	const int pairs = GEMM_NR / 2;
+	GemmPair tile[GEMM_MR][pairs];
+
+	for (int i=0; i < GEMM_MR; i++)
+		for (int j=0; j < pairs; j++)
+		{
+			int column = 2 * j;
+
+			tile[i][j][0] = (i < rows && column < columns) ? C[(size_t) i * ldc + column] : 0;
+			tile[i][j][1] = (i < rows && column + 1 < columns) ? C[(size_t) i * ldc + column + 1] : 0;
+		}
+
+	for (int p=0; p < depth; p++, a += GEMM_MR, b += GEMM_NR)
+	{
+		GemmPair sliver[pairs];
+		memcpy (sliver, b, sizeof(sliver));
+
+		//Unrolled in full, so the tile is kept in registers rather than in memory
+		#pragma GCC unroll 8
+		for (int i=0; i < GEMM_MR; i++)
+		{
+			GemmPair value = { a[i], a[i] };
+
+			#pragma GCC unroll 8
+			for (int j=0; j < pairs; j++) tile[i][j] += value * sliver[j];
+		}
+	}
+
+	for (int i=0; i < rows; i++)
+		for (int column=0; column < columns; column++)
+			C[(size_t) i * ldc + column] = tile[i][column / 2][column % 2];
+}
+
+
+///<summary>
+/// The loops of the blocked algorithm: panels of B by GEMM_NC columns and GEMM_KC depth, blocks of A by GEMM_MC rows,
+/// then tiles. The depth blocks are taken in order, so each element of C still has its products added in order
+///</summary>
+void GemmEngine::Multiply (bool transA, bool transB, int m, int n, int k, const double A[], int lda, const double B[], int ldb, double C[], int ldc)
+{
+	for (int jc=0; jc < n; jc += GEMM_NC)
+	{
+		int nc = min (GEMM_NC, n - jc);
+
+		for (int pc=0; pc < k; pc += GEMM_KC)
+		{
+			int kc = min (GEMM_KC, k - pc);
+
+			PackB (transB, transB ? &B[(size_t) jc * ldb + pc] : &B[(size_t) pc * ldb + jc], ldb, kc, nc);
+
+			for (int ic=0; ic < m; ic += GEMM_MC)
+			{
+				int mc = min (GEMM_MC, m - ic);
+
+				PackA (transA, transA ? &A[(size_t) pc * lda + ic] : &A[(size_t) ic * lda + pc], lda, mc, kc);
+
+				for (int jr=0; jr < nc; jr += GEMM_NR)
+					for (int ir=0; ir < mc; ir += GEMM_MR)
+						Kernel (kc, &packedA[(size_t) ir * kc], &packedB[(size_t) jr * kc],
+								&C[(size_t) (ic + ir) * ldc + jc + jr], ldc, min (GEMM_MR, mc - ir), min (GEMM_NR, nc - jr));
+			}
+		}
+	}
+}
+
+
+// Engine of each thread *****************************
+
+GemmEngine & ThreadGemm ()
+{
+	static thread_local GemmEngine engine;
+
+	return engine;
+}
+
+
+void Gemm (bool transA, bool transB, int m, int n, int k, const double A[], int lda, const double B[], int ldb, double C[], int ldc)
+{
+	ThreadGemm().Multiply (transA, transB, m, n, k, A, lda, B, ldb, C, ldc);
+}
+
+#endif
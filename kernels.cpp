@@ -0,0 +1,121 @@
+/*
+*	Library Module Implementing the registry of kernels of tiny layers
+*/
+
+#ifndef KERNELS_CPP
+#define KERNELS_CPP
+
+#include "Header/library.h"
+
+
+// Kernels of one size *****************************
+
+///<summary>
+/// As LinearLayerNetwork::WeightedSums, for a layer of Ins inputs and Neurons neurons
+///</summary>
+template <int Ins, int Neurons> void FixedSums (const double weights[], const double inputs[], double sums[])
+{
+	#pragma GCC unroll 16
+	for (int neuron=0; neuron < Neurons; neuron++)
+	{
+		const double *neuronWeights = &weights[neuron * (Ins + 1)];
+
+		double sum = neuronWeights[0];
+
+		#pragma GCC unroll 16
+		for (int ct=0; ct < Ins; ct++) sum += inputs[ct] * neuronWeights[ct + 1];
+
+		sums[neuron] = sum;
+	}
+}
+
+
+///<summary>
+/// As LinearLayerNetwork::PrevLayersErrors, for a layer of Ins inputs and Neurons neurons
+///</summary>
+template <int Ins, int Neurons> void FixedErrors (const double weights[], const double deltas[], double errors[])
+{
+	#pragma GCC unroll 16
+	for (int ct=0; ct < Ins; ct++)
+	{
+		double error = 0;
+
+		#pragma GCC unroll 16
+		for (int neuron=0; neuron < Neurons; neuron++) error += deltas[neuron] * weights[neuron * (Ins + 1) + ct + 1];
+
+		errors[ct] = error;
+	}
+}
+
+
+///<summary>
+/// As LinearLayerNetwork::ChangeAllWeights, for a layer of Ins inputs and Neurons neurons
+///</summary>
+template <int Ins, int Neurons> void FixedChange (const double inputs[], const double deltas[], double weights[], double deltaWeights[], const double learningParameters[])
+{
+	double rate = learningParameters[0], momentum = learningParameters[1];
+
+	#pragma GCC unroll 16
+	for (int neuron=0; neuron < Neurons; neuron++)
+	{
+		double *neuronWeights = &weights[neuron * (Ins + 1)];
+		double *neuronDeltaWeights = &deltaWeights[neuron * (Ins + 1)];
+		double delta = deltas[neuron];
+
+		//Bias weight, whose input is 1
+		neuronDeltaWeights[0] = (delta * rate) + (neuronDeltaWeights[0] * momentum);
+		neuronWeights[0] += neuronDeltaWeights[0];
+
+		#pragma GCC unroll 16
+		for (int ct=0; ct < Ins; ct++)
+		{
+			neuronDeltaWeights[ct + 1] = (inputs[ct] * delta * rate) + (neuronDeltaWeights[ct + 1] * momentum);
+			neuronWeights[ct + 1] += neuronDeltaWeights[ct + 1];
+		}
+	}
+}
+
+
+// Registry *****************************
+
+//Kernels of a layer of ins inputs and neurons neurons
+#define LAYER_KERNELS(ins, neurons) { ins, neurons, #ins "x" #neurons, FixedSums<ins, neurons>, FixedErrors<ins, neurons>, FixedChange<ins, neurons> }
+
+///<summary>
+/// The sizes MakeNet builds for the data sets in Resource: 2 inputs for xordata, nonlinsep, logdata and train,
+/// 4 for iris, hidden layers of up to 10 and outputs of up to 4, and the output layers after 8 or 10 hidden neurons
+///</summary>
+static const LayerKernels REGISTERED_KERNELS[] = {
+
+	LAYER_KERNELS(1, 1), LAYER_KERNELS(1, 2), LAYER_KERNELS(1, 3), LAYER_KERNELS(1, 4), LAYER_KERNELS(1, 8), LAYER_KERNELS(1, 10),
+	LAYER_KERNELS(2, 1), LAYER_KERNELS(2, 2), LAYER_KERNELS(2, 3), LAYER_KERNELS(2, 4), LAYER_KERNELS(2, 8), LAYER_KERNELS(2, 10),
+	LAYER_KERNELS(3, 1), LAYER_KERNELS(3, 2), LAYER_KERNELS(3, 3), LAYER_KERNELS(3, 4), LAYER_KERNELS(3, 8), LAYER_KERNELS(3, 10),
+	LAYER_KERNELS(4, 1), LAYER_KERNELS(4, 2), LAYER_KERNELS(4, 3), LAYER_KERNELS(4, 4), LAYER_KERNELS(4, 8), LAYER_KERNELS(4, 10),
+	LAYER_KERNELS(8, 1), LAYER_KERNELS(8, 2), LAYER_KERNELS(8, 3), LAYER_KERNELS(8, 4),
+	LAYER_KERNELS(10, 1), LAYER_KERNELS(10, 2), LAYER_KERNELS(10, 3), LAYER_KERNELS(10, 4)
+};
+
+#undef LAYER_KERNELS
+
+
+const LayerKernels * FindLayerKernels (int numInputs, int numNeurons)
+{
+	for (int n=0; n < HowManyLayerKernels(); n++)
+		if (REGISTERED_KERNELS[n].numInputs == numInputs && REGISTERED_KERNELS[n].numNeurons == numNeurons) return &REGISTERED_KERNELS[n];
+
+	return 0;
+}
+
+
+int HowManyLayerKernels ()
+{
+	return (int) (sizeof(REGISTERED_KERNELS) / sizeof(REGISTERED_KERNELS[0]));
+}
+
+
+const LayerKernels & NthLayerKernels (int n)
+{
+	return REGISTERED_KERNELS[n];
+}
+
+#endif
@@ -16,8 +16,8 @@
 double myrand () 
 {			
 	// return a random number in the range -1..1
-	// do so calling the rand function in math library
-   return -1.0 + (2.0 * rand() / RAND_MAX);
+	// do so from the generator of this thread, seeded by SeedThreadRandom
+   return ThreadRandom().Symmetric();
 }
 
 // Implementation of LinearLayerNetwork *****************************
@@ -29,8 +29,9 @@ double myrand ()
 ///
 ///<argument="int numIns">Number of inputs</argument>
 ///<argument="int numOuts">Number of outputs</argument>
+///<argument="Arena *arena">Arena to carve the arrays from, or 0 for the layer to make its own</argument>
 ///</summary>
-LinearLayerNetwork::LinearLayerNetwork (int numIns, int numOuts) { 
+LinearLayerNetwork::LinearLayerNetwork (int numIns, int numOuts, Arena *arena) { 
 	 
 	//Store number of inputs
 	numInputs = numIns;							
@@ -41,19 +42,34 @@ LinearLayerNetwork::LinearLayerNetwork (int numIns, int numOuts) {
 	//Calculate and store number of weights
 	// "+ 1" refers to the bias
 	numWeights = (numInputs + 1) * numNeurons;	
-				
+	
+	//A layer on its own is the first; a network numbers the layers after it
+	depth = 0;
+	
+	//One block for all four arrays, unless the network provides one
+	memory = (arena == 0) ? new Arena (LayerBytes(numInputs, numNeurons)) : 0;
+	if (arena == 0) arena = memory;
 					
 	//Allocate space for the output array							
-	outputs = new double [numNeurons];			
+	outputs = arena->Doubles(numNeurons);			
 	
 	//Allocate space for the delta array	
-	deltas = new double [numNeurons];			
+	deltas = arena->Doubles(numNeurons);			
     
     //Allocate space for the weight array	
-    weights = new double [numWeights];			
+    weights = arena->Doubles(numWeights);			
     
     //Allocate space for the delta-weight array	
-    deltaWeights = new double [numWeights];	
+    deltaWeights = arena->Doubles(numWeights);	
+    
+    //No sparse pass yet: the steps of each input are made by the first
+    sparseSteps = 0;
+    
+    //Kernels of this size, if any are registered
+    kernels = FindLayerKernels (numInputs, numNeurons);
+    
+    //Run on the calling thread until given a pool
+    pool = 0;
     
     	
 
@@ -77,15 +93,45 @@ LinearLayerNetwork::LinearLayerNetwork (int numIns, int numOuts) {
 }
 
 
+///<summary>
+/// Leaves the arrays at 0 until the network sets them
+///</summary>
+LinearLayerNetwork::LinearLayerNetwork (int numIns, int numOuts, Arena &buffers) {
+
+	numInputs = numIns;
+	numNeurons = numOuts;
+	numWeights = (numInputs + 1) * numNeurons;
+	depth = 0;
+	
+	outputs = 0;
+	deltas = 0;
+	weights = 0;
+	deltaWeights = 0;
+	memory = &buffers;
+	
+	sparseSteps = 0;
+	kernels = FindLayerKernels (numInputs, numNeurons);
+	pool = 0;
+}
+
+
+///<summary>
+/// Returns the bytes taken in an arena by the outputs, deltas, weights and delta-weights of a layer
+///</summary>
+size_t LinearLayerNetwork::LayerBytes (int numIns, int numOuts) {
+
+	return 2 * Arena::Bytes(numOuts) + 2 * Arena::Bytes((size_t) (numIns + 1) * numOuts);
+}
+
+
 ///<summary>
 /// Destructor for the Object: LinearLayerNetwork, frees memory
 ///</summary>
 LinearLayerNetwork::~LinearLayerNetwork() {
 
-	delete [] weights; 					
-    delete [] deltaWeights;				
-	delete [] outputs;					
-	delete [] deltas; 					
+	//Weights, delta-weights, outputs and deltas are all in the arena
+	//(and, for a network, so are the arrays of any layers sharing it)
+	if (memory != 0) delete memory;
 }
 
 
@@ -98,6 +144,33 @@ LinearLayerNetwork::~LinearLayerNetwork() {
 ///</summary>
 void LinearLayerNetwork::CalcOutputs(const double inputs[]) {
 
+	PROFILE_PHASE (depth, PHASE_FORWARD, 2.0 * numWeights);
+	
+	WeightedSums (inputs);
+}
+
+
+///<summary>
+/// Calculates the weighted sum of each neuron, the bias weight first
+///
+///<argument="const double inputs[]">Array containing the inputs</argument>
+///</summary>
+void LinearLayerNetwork::WeightedSums (const double inputs[]) {
+
+	//Layers of a registered size sum in the same order, unrolled
+	if (kernels != 0)
+	{
+		PROFILE_KERNEL (depth, PHASE_FORWARD);
+		kernels->sums (weights, inputs, outputs);
+		return;
+	}
+	
+	if (Pooled (numInputs, numNeurons))
+	{
+		PoolSums (weights, numInputs, numNeurons, inputs, outputs);
+		return;
+	}
+	
 	//Tracks which weight is being accessed
 	int weight_index = 0;
 	
@@ -113,12 +186,318 @@ void LinearLayerNetwork::CalcOutputs(const double inputs[]) {
 }
 
 
+///<summary>
+/// Leaves the weighted sums as they are, as the activation of a linear layer is the sum itself
+///</summary>
+void LinearLayerNetwork::Activate (double [], int) {
+
+}
+
+
+///<summary>
+/// Calculates the sums of every row, in the same order as CalcOutputs so the results are identical,
+/// then activates the whole batch at once. Nothing but the weights is read from the layer
+///
+///<argument="const double inputs[]">Array containing numRows rows of numInputs inputs</argument>
+///<argument="int numRows">Amount of rows</argument>
+///<argument="double batchOutputs[]">Array onto which numRows rows of numNeurons outputs are stored</argument>
+///<argument="double workspace[]">Unused by a single layer</argument>
+///</summary>
+void LinearLayerNetwork::ForwardBatch (const double inputs[], int numRows, double batchOutputs[], double []) {
+
+	if (Pooled (numInputs, numNeurons))
+		PoolBatchSums (weights, numInputs, numNeurons, inputs, numRows, batchOutputs);
+	else
+		BatchSums (weights, numInputs, numNeurons, inputs, numRows, batchOutputs);
+	
+	Activate (batchOutputs, numRows * numNeurons);
+}
+
+
+///<summary>
+/// Each row's sums start from the biases, then Gemm adds inputs times weights in order of input, as WeightedSums does.
+/// The weights of a neuron are a row of the layer's weights after its bias, so are taken as the transpose
+///</summary>
+void LinearLayerNetwork::BatchSums (const double layerWeights[], int layerInputs, int layerNeurons, const double inputs[], int numRows, double sums[]) {
+
+	if (layerInputs * layerNeurons >= GEMM_MIN_WEIGHTS)
+	{
+		for (int row=0; row < numRows; row++)
+			for (int neuron_counter=0; neuron_counter < layerNeurons; neuron_counter++)
+				sums[(size_t) row * layerNeurons + neuron_counter] = layerWeights[neuron_counter * (layerInputs + 1)];
+		
+		Gemm (false, true, numRows, layerNeurons, layerInputs, inputs, layerInputs, &layerWeights[1], layerInputs + 1, sums, layerNeurons);
+		return;
+	}
+	
+	for (int row=0; row < numRows; row++)
+	{
+		const double *rowInputs = &inputs[(size_t) row * layerInputs];
+		double *rowSums = &sums[(size_t) row * layerNeurons];
+		
+		//Tracks which weight is being accessed
+		int weight_index = 0;
+		
+		for (int neuron_counter=0; neuron_counter < layerNeurons; neuron_counter++) 
+		{
+			double sum = layerWeights[weight_index++];
+			
+			for (int input_counter=0; input_counter < layerInputs; input_counter++)
+				sum += rowInputs[input_counter] * layerWeights[weight_index++];
+			
+			rowSums[neuron_counter] = sum;
+		}
+	}
+}
+
+
+///<summary>
+/// Each error is summed from 0 over the neurons in turn, as PrevLayersErrors sums it
+///</summary>
+void LinearLayerNetwork::BatchErrors (const double layerWeights[], int layerInputs, int layerNeurons, const double batchDeltas[], int numRows, double errors[]) {
+
+	for (size_t ct=0; ct < (size_t) numRows * layerInputs; ct++) errors[ct] = 0;
+	
+	if (layerInputs * layerNeurons >= GEMM_MIN_WEIGHTS)
+	{
+		Gemm (false, false, numRows, layerInputs, layerNeurons, batchDeltas, layerNeurons, &layerWeights[1], layerInputs + 1, errors, layerInputs);
+		return;
+	}
+	
+	for (int row=0; row < numRows; row++)
+	{
+		const double *rowDeltas = &batchDeltas[(size_t) row * layerNeurons];
+		double *rowErrors = &errors[(size_t) row * layerInputs];
+		
+		for (int neuron_counter=0; neuron_counter < layerNeurons; neuron_counter++)
+		{
+			//The bias weight has no layer before it
+			const double *neuronWeights = &layerWeights[neuron_counter * (layerInputs + 1) + 1];
+			
+			for (int input_counter=0; input_counter < layerInputs; input_counter++)
+				rowErrors[input_counter] += rowDeltas[neuron_counter] * neuronWeights[input_counter];
+		}
+	}
+}
+
+
+///<summary>
+/// Each gradient is summed from 0 over the rows in turn. The deltas of a neuron are a column of batchDeltas[], so are
+/// taken as the transpose, and the gradients of its inputs are stored after that of its bias, as its weights are
+///</summary>
+void LinearLayerNetwork::BatchGradient (const double batchDeltas[], const double inputs[], int layerInputs, int layerNeurons, int numRows, double gradient[]) {
+
+	for (int ct=0; ct < (layerInputs + 1) * layerNeurons; ct++) gradient[ct] = 0;
+	
+	for (int row=0; row < numRows; row++)
+		for (int neuron_counter=0; neuron_counter < layerNeurons; neuron_counter++)
+			gradient[neuron_counter * (layerInputs + 1)] += batchDeltas[(size_t) row * layerNeurons + neuron_counter];
+	
+	if (layerInputs * layerNeurons >= GEMM_MIN_WEIGHTS)
+	{
+		Gemm (true, false, layerNeurons, layerInputs, numRows, batchDeltas, layerNeurons, inputs, layerInputs, &gradient[1], layerInputs + 1);
+		return;
+	}
+	
+	for (int row=0; row < numRows; row++)
+	{
+		const double *rowDeltas = &batchDeltas[(size_t) row * layerNeurons];
+		const double *rowInputs = &inputs[(size_t) row * layerInputs];
+		
+		for (int neuron_counter=0; neuron_counter < layerNeurons; neuron_counter++)
+		{
+			double *neuronGradient = &gradient[neuron_counter * (layerInputs + 1) + 1];
+			
+			for (int input_counter=0; input_counter < layerInputs; input_counter++)
+				neuronGradient[input_counter] += rowDeltas[neuron_counter] * rowInputs[input_counter];
+		}
+	}
+}
+
+
+///<summary>
+/// Arrays of a layer and the row being worked on, shared by the parts of a task of the pool
+///</summary>
+struct PoolLayerTask {
+
+	double *weights;
+	double *deltaWeights;
+	const double *inputs;
+	const double *deltas;
+	double *results;
+	const double *learningParameters;
+	int numInputs;
+	int numNeurons;
+	int numRows;
+};
+
+
+///<summary>
+/// Weighted sums of one part of the neurons, as WeightedSums finds them
+///</summary>
+static void PoolSumsPart (void *context, int part, int numParts) {
+
+	PoolLayerTask &task = *(PoolLayerTask *) context;
+	
+	int first, last;
+	SpinPool::Split (task.numNeurons, part, numParts, first, last);
+	
+	for (int neuron = first; neuron < last; neuron++)
+	{
+		const double *neuronWeights = &task.weights[neuron * (task.numInputs + 1)];
+		double sum = neuronWeights[0];
+		
+		for (int ct=0; ct < task.numInputs; ct++) sum += task.inputs[ct] * neuronWeights[ct + 1];
+		
+		task.results[neuron] = sum;
+	}
+}
+
+
+///<summary>
+/// Weighted sums of one part of the neurons for every row, as BatchSums finds them: biases first, then Gemm
+/// adds the inputs times the part's weights, writing the part's columns of the rows of sums
+///</summary>
+static void PoolBatchSumsPart (void *context, int part, int numParts) {
+
+	PoolLayerTask &task = *(PoolLayerTask *) context;
+	
+	int first, last;
+	SpinPool::Split (task.numNeurons, part, numParts, first, last);
+	
+	if (first == last) return;
+	
+	for (int row=0; row < task.numRows; row++)
+		for (int neuron = first; neuron < last; neuron++)
+			task.results[(size_t) row * task.numNeurons + neuron] = task.weights[neuron * (task.numInputs + 1)];
+	
+	Gemm (false, true, task.numRows, last - first, task.numInputs, task.inputs, task.numInputs,
+		  &task.weights[first * (task.numInputs + 1) + 1], task.numInputs + 1, &task.results[first], task.numNeurons);
+}
+
+
+///<summary>
+/// Errors of one part of the inputs, each summed over the neurons in turn, as PrevLayersErrors sums it
+///</summary>
+static void PoolErrorsPart (void *context, int part, int numParts) {
+
+	PoolLayerTask &task = *(PoolLayerTask *) context;
+	
+	int first, last;
+	SpinPool::Split (task.numInputs, part, numParts, first, last);
+	
+	for (int ct = first; ct < last; ct++)
+	{
+		double error = 0;
+		
+		for (int neuron=0; neuron < task.numNeurons; neuron++)
+			error += task.deltas[neuron] * task.weights[neuron * (task.numInputs + 1) + ct + 1];
+		
+		task.results[ct] = error;
+	}
+}
+
+
+///<summary>
+/// Changes in weights, and weights, of one part of the neurons, as ChangeAllWeights finds them
+///</summary>
+static void PoolChangePart (void *context, int part, int numParts) {
+
+	PoolLayerTask &task = *(PoolLayerTask *) context;
+	double rate = task.learningParameters[0], momentum = task.learningParameters[1];
+	
+	int first, last;
+	SpinPool::Split (task.numNeurons, part, numParts, first, last);
+	
+	for (int neuron = first; neuron < last; neuron++)
+	{
+		double *neuronWeights = &task.weights[neuron * (task.numInputs + 1)];
+		double *neuronDeltaWeights = &task.deltaWeights[neuron * (task.numInputs + 1)];
+		double delta = task.deltas[neuron];
+		
+		//Bias weight, whose input is 1
+		neuronDeltaWeights[0] = (delta * rate) + (neuronDeltaWeights[0] * momentum);
+		neuronWeights[0] += neuronDeltaWeights[0];
+		
+		for (int ct=0; ct < task.numInputs; ct++)
+		{
+			neuronDeltaWeights[ct + 1] = (task.inputs[ct] * delta * rate) + (neuronDeltaWeights[ct + 1] * momentum);
+			neuronWeights[ct + 1] += neuronDeltaWeights[ct + 1];
+		}
+	}
+}
+
+
+bool LinearLayerNetwork::Pooled (int layerInputs, int layerNeurons) {
+
+	return pool != 0 && pool->HowManyParts() > 1 && (layerInputs + 1) * layerNeurons >= POOL_MIN_WEIGHTS;
+}
+
+
+void LinearLayerNetwork::PoolSums (const double layerWeights[], int layerInputs, int layerNeurons, const double inputs[], double sums[]) {
+
+	PoolLayerTask task = { (double *) layerWeights, 0, inputs, 0, sums, 0, layerInputs, layerNeurons, 1 };
+	
+	pool->Run (PoolSumsPart, &task);
+}
+
+
+void LinearLayerNetwork::PoolErrors (const double layerWeights[], int layerInputs, int layerNeurons, const double layerDeltas[], double errors[]) {
+
+	PoolLayerTask task = { (double *) layerWeights, 0, 0, layerDeltas, errors, 0, layerInputs, layerNeurons, 1 };
+	
+	pool->Run (PoolErrorsPart, &task);
+}
+
+
+void LinearLayerNetwork::PoolChange (double layerWeights[], double layerDeltaWeights[], int layerInputs, int layerNeurons,
+									 const double inputs[], const double layerDeltas[], const double learningParameters[]) {
+
+	PoolLayerTask task = { layerWeights, layerDeltaWeights, inputs, layerDeltas, 0, learningParameters, layerInputs, layerNeurons, 1 };
+	
+	pool->Run (PoolChangePart, &task);
+}
+
+
+void LinearLayerNetwork::PoolBatchSums (const double layerWeights[], int layerInputs, int layerNeurons, const double inputs[], int numRows, double sums[]) {
+
+	PoolLayerTask task = { (double *) layerWeights, 0, inputs, 0, sums, 0, layerInputs, layerNeurons, numRows };
+	
+	pool->Run (PoolBatchSumsPart, &task);
+}
+
+
+///<summary>
+/// Follows the chain of next layers to the layer, then sums and activates its rows as its ForwardBatch would
+///</summary>
+void LinearLayerNetwork::ForwardLayerBatch (int layer, const double inputs[], int numRows, double layerOutputs[]) {
+
+	LinearLayerNetwork *shape = this;
+	for (int l=0; l < layer; l++) shape = shape->NextLayer();
+	
+	BatchSums (shape->weights, shape->numInputs, shape->numNeurons, inputs, numRows, layerOutputs);
+	
+	shape->Activate (layerOutputs, numRows * shape->numNeurons);
+}
+
+
+int LinearLayerNetwork::BatchWorkspace (int) {
+
+	return 0;
+}
+
+
 ///<summary>
 /// Passes each item in the dataset to the network then calculates and stores the outputs
 ///
 ///<argument="dataset &data">Location to the dataset containing data to be tested</argument>
+///<argument="MetricsAccumulator *metrics">If given, accumulates SSE and % correct classifications while the outputs are still in cache</argument>
 ///</summary>
-void LinearLayerNetwork::ComputeNetwork (dataset &data) {
+void LinearLayerNetwork::ComputeNetwork (dataset &data, MetricsAccumulator *metrics) {
+
+	PROFILE_PASS (data.numData());
+	
+	if (metrics) metrics->Reset();
 
 	//For each item in the data-set
 	for (int i=0; i < data.numData(); i++) 
@@ -128,6 +507,8 @@ void LinearLayerNetwork::ComputeNetwork (dataset &data) {
 	    
 	    //Save outputs into data-set
 		StoreOutputs(i, data);
+		
+		if (metrics) metrics->Accumulate(NetworkOutputs(), data.GetNthTargets(i));
 	}
 }
 
@@ -140,6 +521,8 @@ void LinearLayerNetwork::ComputeNetwork (dataset &data) {
 ///</summary>
 void LinearLayerNetwork::StoreOutputs (int n, dataset &data) {
 
+	PROFILE_PHASE (depth, PHASE_STORE, 0);
+	
 	//Passes output-array into the dataset
 	data.SetNthOutputs(n, outputs);
 }
@@ -154,6 +537,8 @@ void LinearLayerNetwork::StoreOutputs (int n, dataset &data) {
 ///</summary>
 void LinearLayerNetwork::FindDeltas (const double errors[]) {
 	
+	PROFILE_PHASE (depth, PHASE_DELTAS, 0);
+	
 	////only copying has to be done, there are as many errors as there are outputs and as many outputs as there are neurons
 	dcopy(numNeurons, errors, deltas);
 	
@@ -170,6 +555,22 @@ void LinearLayerNetwork::FindDeltas (const double errors[]) {
 ///</summary>
 void LinearLayerNetwork::ChangeAllWeights (const double Inputs[], const double learningParameters[]) {
 
+	//Three multiplies and two adds per weight
+	PROFILE_PHASE (depth, PHASE_WEIGHTS, 5.0 * numWeights);
+	
+	if (kernels != 0)
+	{
+		PROFILE_KERNEL (depth, PHASE_WEIGHTS);
+		kernels->change (Inputs, deltas, weights, deltaWeights, learningParameters);
+		return;
+	}
+	
+	if (Pooled (numInputs, numNeurons))
+	{
+		PoolChange (weights, deltaWeights, numInputs, numNeurons, Inputs, deltas, learningParameters);
+		return;
+	}
+	
 	//Used to keep track of the current input
 	double current_input;
 	
@@ -202,23 +603,422 @@ void LinearLayerNetwork::ChangeAllWeights (const double Inputs[], const double l
 
 
 
-void LinearLayerNetwork::AdaptNetwork (dataset &data, const double learningParameters[]) {
-		// pass whole dataset to network : for each item
-		//   calculate outputs, copying them back to data
-		//   adjust weights using the delta rule : targets are in data
-		//     where learnparas[0] is learning rate; learnparas[1] is momentum
-
-	for (int i=0; i<data.numData(); i++) 
+void LinearLayerNetwork::AdaptNetwork (dataset &data, const double learningParameters[], MetricsAccumulator *metrics) {
+		// pass whole dataset to network : for each item
+		//   calculate outputs, copying them back to data
+		//   adjust weights using the delta rule : targets are in data
+		//     where learnparas[0] is learning rate; learnparas[1] is momentum
+		//   if metrics given, accumulate SSE and % classifications of the outputs as they are found
+
+	PROFILE_PASS (data.numData());
+	
+#ifdef ANN_PROFILE
+	//Layer the errors are timed against
+	int outputDepth = OutputDepth();
+#endif
+	
+	if (metrics) metrics->Reset();
+
+	for (int i=0; i<data.numData(); i++) 
+	{
+			// for each item in data set
+		CalcOutputs(data.GetNthInputs(i));
+			// get inputs from data and pass to network to calculate the outputs
+		StoreOutputs (i, data);
+			// return calculated outputs from network back to dataset 
+		if (metrics) metrics->Accumulate(NetworkOutputs(), data.GetNthTargets(i));
+			// and add them to the metrics while in cache
+		double *errors;
+		{
+			PROFILE_PHASE (outputDepth, PHASE_ERRORS, data.numOuts());
+			errors = data.GetNthErrors(i);
+		}
+			// get errors from data
+		FindDeltas(errors);
+			// and so get neuron to calculate the delta
+		ChangeAllWeights(data.GetNthInputs(i), learningParameters);
+			// and then change all the weights, passing inputs and learning constants
+	}
+}
+
+
+///<summary>
+/// Passes each item in the dataset to the network in the given order, storing the outputs and adjusting the weights
+///
+///<argument="dataset &data">Location to the dataset containing data to learn from</argument>
+///<argument="const double learningParameters[]"> Array containing the parameters: {learning-rate, momentum}</argument>
+///<argument="const int order[]">Array containing the index of every row, in the order they are presented</argument>
+///<argument="MetricsAccumulator *metrics">If given, accumulates SSE and % correct classifications of the outputs as they are found</argument>
+///</summary>
+void LinearLayerNetwork::AdaptNetwork (dataset &data, const double learningParameters[], const int order[], MetricsAccumulator *metrics) {
+
+	PROFILE_PASS (data.numData());
+	
+#ifdef ANN_PROFILE
+	//Layer the errors are timed against
+	int outputDepth = OutputDepth();
+#endif
+	
+	if (metrics) metrics->Reset();
+
+	for (int i=0; i<data.numData(); i++) 
+	{
+		//Row to be presented next
+		int row = order[i];
+		
+		CalcOutputs(data.GetNthInputs(row));
+		
+		StoreOutputs (row, data);
+		
+		if (metrics) metrics->Accumulate(NetworkOutputs(), data.GetNthTargets(row));
+		
+		double *errors;
+		{
+			PROFILE_PHASE (outputDepth, PHASE_ERRORS, data.numOuts());
+			errors = data.GetNthErrors(row);
+		}
+		
+		FindDeltas(errors);
+		
+		ChangeAllWeights(data.GetNthInputs(row), learningParameters);
+	}
+}
+
+
+///<summary>
+/// Passes the selected rows of the dataset to the network and adjusts the weights using the delta rule.
+/// Errors are found in a local array, so the dataset is only read from
+///
+///<argument="dataset &data">Location to the dataset containing data to learn from</argument>
+///<argument="const int rows[]">Array containing the indices of the rows to learn from, in order</argument>
+///<argument="int numRows">Amount of rows in rows[]</argument>
+///<argument="const double learningParameters[]"> Array containing the parameters: {learning-rate, momentum}</argument>
+///</summary>
+void LinearLayerNetwork::AdaptRows (dataset &data, const int rows[], int numRows, const double learningParameters[]) {
+
+	PROFILE_PASS (numRows);
+	
+#ifdef ANN_PROFILE
+	//Layer the errors are timed against
+	int outputDepth = OutputDepth();
+#endif
+	
+	//Errors of the current row: one for each output of the network
+	double rowErrors[data.numOuts()];
+	
+	for (int i=0; i < numRows; i++) 
+	{
+		//Calculates outputs of the selected row
+		CalcOutputs(data.GetNthInputs(rows[i]));
+		
+		double *networkOutputs = NetworkOutputs();
+		double *targets = data.GetNthTargets(rows[i]);
+		
+		//Error = target - output, as found by dataset::GetNthErrors
+		{
+			PROFILE_PHASE (outputDepth, PHASE_ERRORS, data.numOuts());
+			for (int ct=0; ct < data.numOuts(); ct++)
+				rowErrors[ct] = targets[ct] - networkOutputs[ct];
+		}
+		
+		FindDeltas(rowErrors);
+		
+		ChangeAllWeights(data.GetNthInputs(rows[i]), learningParameters);
+	}
+}
+
+
+///<summary>
+/// Passes the selected rows of the dataset to the network and finds, for each output, 
+/// the mean sum squared error and the % correct classifications, as dataset::CalcSSE and 
+/// dataset::CalcCorrectClassifications would. The dataset is only read from
+///
+///<argument="dataset &data">Location to the dataset containing data to be tested</argument>
+///<argument="const int rows[]">Array containing the indices of the rows to test</argument>
+///<argument="int numRows">Amount of rows in rows[]</argument>
+///<argument="double sse[]">Array onto which the mean sum squared error of each output is stored</argument>
+///<argument="double correct[]">Array onto which the % correct classifications of each output is stored</argument>
+///</summary>
+void LinearLayerNetwork::EvaluateRows (dataset &data, const int rows[], int numRows, double sse[], double correct[]) {
+
+	PROFILE_PASS (numRows);
+	
+	//Accumulator local to this call, so many threads can evaluate the same dataset
+	MetricsAccumulator metrics (data);
+	
+	for (int i=0; i < numRows; i++) 
+	{
+		CalcOutputs(data.GetNthInputs(rows[i]));
+		
+		metrics.Accumulate(NetworkOutputs(), data.GetNthTargets(rows[i]));
+	}
+	
+	dcopy (data.numOuts(), metrics.CalcSSE(), sse);
+	dcopy (data.numOuts(), metrics.CalcCorrectClassifications(), correct);
+}
+
+
+
+///<summary>
+/// Rows are taken batchSize at a time. Each layer's outputs of the whole batch are found, then the deltas of the whole
+/// batch layer by layer back from the output, then each layer's weights are changed by its gradient. As in AdaptRows,
+/// every delta is found before any weight is changed, and the change in weight is (gradient * learning_rate / rows)
+/// + (momentum * previous change), which for one row is the change ChangeAllWeights makes
+///
+///<argument="dataset &data">Location to the dataset containing data to learn from</argument>
+///<argument="const int rows[]">Array containing the indices of the rows to learn from, in order</argument>
+///<argument="int numRows">Amount of rows in rows[]</argument>
+///<argument="int batchSize">Rows of each batch</argument>
+///<argument="const double learningParameters[]"> Array containing the parameters: {learning-rate, momentum}</argument>
+///</summary>
+void LinearLayerNetwork::AdaptBatch (dataset &data, const int rows[], int numRows, int batchSize, const double learningParameters[]) {
+
+	PROFILE_PASS (numRows);
+	
+	int numLayers = HowManyLayers();
+	int last = numLayers - 1;
+	batchSize = max (1, batchSize);
+	
+	vector<int> layerInputs (numLayers), layerNeurons (numLayers);
+	vector<char> layerTypes (numLayers);
+	vector<double *> layerWeights (numLayers), layerDeltaWeights (numLayers);
+	
+	//The batch's inputs, then each layer's outputs and deltas of the batch, one row after another
+	vector<size_t> outputStart (numLayers), deltaStart (numLayers);
+	size_t batchDoubles = (size_t) batchSize * numInputs;
+	int mostWeights = 0;
+	
+	for (int l=0; l < numLayers; l++)
+	{
+		DescribeLayer (l, layerInputs[l], layerNeurons[l], layerTypes[l]);
+		LayerArrays (l, layerWeights[l], layerDeltaWeights[l]);
+		
+		outputStart[l] = batchDoubles;
+		deltaStart[l] = batchDoubles + (size_t) batchSize * layerNeurons[l];
+		batchDoubles += 2 * (size_t) batchSize * layerNeurons[l];
+		
+		mostWeights = max (mostWeights, (layerInputs[l] + 1) * layerNeurons[l]);
+	}
+	
+	vector<double> batch (batchDoubles), gradient (mostWeights);
+	
+	for (int first=0; first < numRows; first += batchSize)
+	{
+		int count = min (batchSize, numRows - first);
+		
+		for (int i=0; i < count; i++)
+			dcopy (numInputs, data.GetNthInputs(rows[first + i]), &batch[(size_t) i * numInputs]);
+		
+		for (int l=0; l < numLayers; l++)
+		{
+			PROFILE_PHASE (depth + l, PHASE_FORWARD, 2.0 * (layerInputs[l] + 1) * layerNeurons[l] * count);
+			
+			const double *inputs = (l == 0) ? &batch[0] : &batch[outputStart[l - 1]];
+			double *outputs = &batch[outputStart[l]];
+			
+			BatchSums (layerWeights[l], layerInputs[l], layerNeurons[l], inputs, count, outputs);
+			ActivateLayerValues (layerTypes[l], outputs, count * layerNeurons[l], layerNeurons[l]);
+		}
+		
+		//Error = target - output, as found by dataset::GetNthErrors, in the deltas of the output layer
+		{
+			PROFILE_PHASE (depth + last, PHASE_ERRORS, (double) count * layerNeurons[last]);
+			
+			for (int i=0; i < count; i++)
+			{
+				const double *targets = data.GetNthTargets(rows[first + i]);
+				const double *outputs = &batch[outputStart[last] + (size_t) i * layerNeurons[last]];
+				double *errors = &batch[deltaStart[last] + (size_t) i * layerNeurons[last]];
+				
+				for (int ct=0; ct < layerNeurons[last]; ct++) errors[ct] = targets[ct] - outputs[ct];
+			}
+		}
+		
+		//Each layer's errors, made into its deltas, give the errors of the layer before
+		for (int l = last; l >= 0; l--)
+		{
+			PROFILE_PHASE (depth + l, PHASE_DELTAS, (l > 0) ? 2.0 * layerInputs[l] * layerNeurons[l] * count : 0);
+			
+			double *deltas = &batch[deltaStart[l]];
+			
+			LayerValueDeltas (layerTypes[l], &batch[outputStart[l]], deltas, deltas, count * layerNeurons[l]);
+			
+			if (l > 0) BatchErrors (layerWeights[l], layerInputs[l], layerNeurons[l], deltas, count, &batch[deltaStart[l - 1]]);
+		}
+		
+		double rate = learningParameters[0] / count;
+		
+		for (int l=0; l < numLayers; l++)
+		{
+			int numLayerWeights = (layerInputs[l] + 1) * layerNeurons[l];
+			
+			PROFILE_PHASE (depth + l, PHASE_WEIGHTS, (2.0 * count + 4) * numLayerWeights);
+			
+			const double *inputs = (l == 0) ? &batch[0] : &batch[outputStart[l - 1]];
+			
+			BatchGradient (&batch[deltaStart[l]], inputs, layerInputs[l], layerNeurons[l], count, &gradient[0]);
+			
+			double *weightsOfLayer = layerWeights[l];
+			double *deltaWeightsOfLayer = layerDeltaWeights[l];
+			
+			for (int weight_index=0; weight_index < numLayerWeights; weight_index++)
+			{
+				deltaWeightsOfLayer[weight_index] = (gradient[weight_index] * rate) + (deltaWeightsOfLayer[weight_index] * learningParameters[1]);
+				weightsOfLayer[weight_index] += deltaWeightsOfLayer[weight_index];
+			}
+		}
+	}
+}
+
+
+///<summary>
+/// Sums the bias then each non-zero input times its weight, in order of column; the zero inputs that
+/// WeightedSums would also add change nothing, so the sums are the same
+///</summary>
+void LinearLayerNetwork::SparseWeightedSums (const int columns[], const double values[], int count) {
+
+	for (int neuron_counter=0; neuron_counter < numNeurons; neuron_counter++) 
+	{
+		const double *neuronWeights = &weights[neuron_counter * (numInputs + 1)];
+		
+		double sum = neuronWeights[0];
+		
+		for (int ct=0; ct < count; ct++)
+			sum += values[ct] * neuronWeights[columns[ct] + 1];
+		
+		outputs[neuron_counter] = sum;
+	}
+}
+
+
+void LinearLayerNetwork::SparseCalcOutputs (const int columns[], const double values[], int count) {
+
+	{
+		PROFILE_PHASE (depth, PHASE_FORWARD, 2.0 * (count + 1) * numNeurons);
+		
+		SparseWeightedSums (columns, values, count);
+		Activate (outputs, numNeurons);
+	}
+	
+	if (NextLayer() != 0) NextLayer()->CalcOutputs (outputs);
+}
+
+
+void LinearLayerNetwork::CatchUpColumn (int column, double momentum) {
+
+	long long skipped = sparseSteps - columnSteps[column];
+	if (skipped == 0) return;
+	
+	columnSteps[column] = sparseSteps;
+	
+	double decay = pow (momentum, (double) skipped);
+	double growth = (momentum == 1) ? (double) skipped : momentum * (1 - decay) / (1 - momentum);
+	
+	for (int neuron_index=0; neuron_index < numNeurons; neuron_index++)
+	{
+		int weight_index = neuron_index * (numInputs + 1) + column + 1;
+		
+		weights[weight_index] += deltaWeights[weight_index] * growth;
+		deltaWeights[weight_index] *= decay;
+	}
+}
+
+
+///<summary>
+/// Changes the weights of the non-zero inputs, already brought up to date, and the bias weights as ChangeAllWeights does
+///</summary>
+void LinearLayerNetwork::SparseChangeWeights (const int columns[], const double values[], int count, const double learningParameters[]) {
+
+	{
+		PROFILE_PHASE (depth, PHASE_WEIGHTS, 5.0 * (count + 1) * numNeurons);
+		
+		for (int neuron_index=0; neuron_index < numNeurons; neuron_index++)
+		{
+			double *neuronWeights = &weights[neuron_index * (numInputs + 1)];
+			double *neuronDeltaWeights = &deltaWeights[neuron_index * (numInputs + 1)];
+			
+			//Bias weight, whose input is 1
+			neuronDeltaWeights[0] = (deltas[neuron_index] * learningParameters[0]) + (neuronDeltaWeights[0] * learningParameters[1]);
+			neuronWeights[0] += neuronDeltaWeights[0];
+			
+			for (int ct=0; ct < count; ct++)
+			{
+				int input_index = columns[ct] + 1;
+				
+				neuronDeltaWeights[input_index] = (values[ct] * deltas[neuron_index] * learningParameters[0])
+												+ (neuronDeltaWeights[input_index] * learningParameters[1]);
+				neuronWeights[input_index] += neuronDeltaWeights[input_index];
+			}
+		}
+		
+		//This row is done for the non-zero inputs
+		sparseSteps++;
+		for (int ct=0; ct < count; ct++) columnSteps[columns[ct]] = sparseSteps;
+	}
+	
+	if (NextLayer() != 0) NextLayer()->ChangeAllWeights (outputs, learningParameters);
+}
+
+
+void LinearLayerNetwork::AdaptSparse (SparseDataset &data, const double learningParameters[]) {
+
+	PROFILE_PASS (data.numData());
+	
+#ifdef ANN_PROFILE
+	//Layer the errors are timed against
+	int outputDepth = OutputDepth();
+#endif
+	
+	if ((int) columnSteps.size() != numInputs) columnSteps.assign (numInputs, 0);
+	
+	//Errors of the current row: one for each output of the network
+	double rowErrors[data.numOuts()];
+	
+	for (int i=0; i < data.numData(); i++) 
+	{
+		const int *columns = data.GetNthColumns(i);
+		const double *values = data.GetNthValues(i);
+		int count = data.RowNonZeros(i);
+		
+		//The weights of this row's inputs are brought up to date before they are read
+		for (int ct=0; ct < count; ct++) CatchUpColumn (columns[ct], learningParameters[1]);
+		
+		SparseCalcOutputs (columns, values, count);
+		
+		double *networkOutputs = NetworkOutputs();
+		double *targets = data.GetNthTargets(i);
+		
+		data.SetNthOutputs (i, networkOutputs);
+		
+		//Error = target - output, as found by dataset::GetNthErrors
+		{
+			PROFILE_PHASE (outputDepth, PHASE_ERRORS, data.numOuts());
+			for (int ct=0; ct < data.numOuts(); ct++)
+				rowErrors[ct] = targets[ct] - networkOutputs[ct];
+		}
+		
+		FindDeltas (rowErrors);
+		
+		SparseChangeWeights (columns, values, count, learningParameters);
+	}
+	
+	//Every weight up to date, ready for the next pass or any other use of the network
+	for (int column=0; column < numInputs; column++) CatchUpColumn (column, learningParameters[1]);
+	
+	sparseSteps = 0;
+	columnSteps.assign (numInputs, 0);
+}
+
+
+void LinearLayerNetwork::ComputeSparse (SparseDataset &data) {
+
+	PROFILE_PASS (data.numData());
+	
+	for (int i=0; i < data.numData(); i++) 
 	{
-			// for each item in data set
-		CalcOutputs(data.GetNthInputs(i));
-			// get inputs from data and pass to network to calculate the outputs
-		StoreOutputs (i, data);
-			// return calculated outputs from network back to dataset 
-		FindDeltas(data.GetNthErrors(i));
-			// get errors from data and so get neuron to calculate the delta
-		ChangeAllWeights(data.GetNthInputs(i), learningParameters);
-			// and then change all the weights, passing inputs and learning constants
+		SparseCalcOutputs (data.GetNthColumns(i), data.GetNthValues(i), data.RowNonZeros(i));
+		
+		data.SetNthOutputs (i, NetworkOutputs());
 	}
 }
 
@@ -253,6 +1053,115 @@ void LinearLayerNetwork::ReturnTheWeights (double currentWeights[]) {
 } 
 
 
+void LinearLayerNetwork::SetTheDeltaWeights (const double initialDeltaWeights[]) {
+	// set the changes in weights of the layer, as SetTheWeights sets the weights
+	dcopy (numWeights, initialDeltaWeights, deltaWeights);
+}
+
+
+void LinearLayerNetwork::ReturnTheDeltaWeights (double currentDeltaWeights[]) {
+	// copy the changes in weights, as ReturnTheWeights copies the weights
+	dcopy (numWeights, deltaWeights, currentDeltaWeights);
+}
+
+
+int LinearLayerNetwork::HowManyInputs () {
+
+	return numInputs;
+}
+
+
+int LinearLayerNetwork::HowManyNeurons () {
+
+	return numNeurons;
+}
+
+
+int LinearLayerNetwork::HowManyOutputs () {
+
+	return numNeurons;
+}
+
+
+char LinearLayerNetwork::LayerType () {
+
+	return 'L';
+}
+
+
+const char * LinearLayerNetwork::KernelName () {
+
+	return (kernels != 0) ? kernels->name : "generic";
+}
+
+
+void LinearLayerNetwork::SetPool (SpinPool *thePool) {
+
+	for (LinearLayerNetwork *layer = this; layer != 0; layer = layer->NextLayer()) layer->pool = thePool;
+}
+
+
+LinearLayerNetwork * LinearLayerNetwork::NextLayer () {
+
+	//A single layer is the output layer
+	return 0;
+}
+
+
+int LinearLayerNetwork::OutputDepth () {
+
+	return depth + HowManyLayers() - 1;
+}
+
+
+int LinearLayerNetwork::HowManyLayers () {
+
+	int count = 0;
+	
+	for (LinearLayerNetwork *layer = this; layer != 0; layer = layer->NextLayer()) count++;
+	
+	return count;
+}
+
+
+///<summary>
+/// Walks to the layer through NextLayer()
+///</summary>
+void LinearLayerNetwork::DescribeLayer (int layer, int &layerInputs, int &layerNeurons, char &layerType) {
+
+	LinearLayerNetwork *described = this;
+	
+	for (int ct=0; ct < layer; ct++) described = described->NextLayer();
+	
+	layerInputs = described->numInputs;
+	layerNeurons = described->numNeurons;
+	layerType = described->LayerType();
+}
+
+
+///<summary>
+/// Walks to the layer through NextLayer()
+///</summary>
+void LinearLayerNetwork::LayerArrays (int layer, double *&layerWeights, double *&layerDeltaWeights) {
+
+	LinearLayerNetwork *found = this;
+	
+	for (int ct=0; ct < layer; ct++) found = found->NextLayer();
+	
+	layerWeights = found->weights;
+	layerDeltaWeights = found->deltaWeights;
+}
+
+
+///<summary>
+/// Returns the outputs of this layer, which are the network's outputs for a single layer
+///</summary>
+double * LinearLayerNetwork::NetworkOutputs () {
+
+	return outputs;
+}
+
+
 ///<summary>
 /// Calculates and returns the errors of the previous layer, only works if the output only has one neuron
 ///
@@ -260,6 +1169,9 @@ void LinearLayerNetwork::ReturnTheWeights (double currentWeights[]) {
 ///</summary>
 void LinearLayerNetwork::PrevLayersErrors (double previousErrors[]) {
 
+	//A multiply and an add per weight, bias weights aside
+	PROFILE_PHASE (depth, PHASE_DELTAS, 2.0 * numInputs * numNeurons);
+	
 	/*
 	//CODE for only ONE node in output layer
 	//Each previous neuron output is an input to this network
@@ -272,6 +1184,18 @@ void LinearLayerNetwork::PrevLayersErrors (double previousErrors[]) {
 	}
 	*/
 
+	if (kernels != 0)
+	{
+		PROFILE_KERNEL (depth, PHASE_DELTAS);
+		kernels->errors (weights, deltas, previousErrors);
+		return;
+	}
+	
+	if (Pooled (numInputs, numNeurons))
+	{
+		PoolErrors (weights, numInputs, numNeurons, deltas, previousErrors);
+		return;
+	}
 	
 	//For each input 
 	for(int i=0; i < numInputs; i++)
@@ -293,7 +1217,7 @@ void LinearLayerNetwork::PrevLayersErrors (double previousErrors[]) {
 
 // Implementation of SigmoidalLayerNetwork *****************************
 
-SigmoidalLayerNetwork::SigmoidalLayerNetwork (int numInputs, int numOutputs):LinearLayerNetwork (numInputs, numOutputs) 
+SigmoidalLayerNetwork::SigmoidalLayerNetwork (int numInputs, int numOutputs, Arena *arena):LinearLayerNetwork (numInputs, numOutputs, arena) 
 {
 	// just use inherited constructor - no extra variables to initialise
 }
@@ -305,6 +1229,12 @@ SigmoidalLayerNetwork::~SigmoidalLayerNetwork()
 
 
 
+char SigmoidalLayerNetwork::LayerType () 
+{
+	return 'S';
+}
+
+
 ///<summary>
 ///	Calculates the outputs of the sigmoidal layer
 /// Equation:
@@ -316,15 +1246,25 @@ SigmoidalLayerNetwork::~SigmoidalLayerNetwork()
 void SigmoidalLayerNetwork::CalcOutputs(const double inputs[]) {		
 	// Calculate outputs being Sigmoid (WeightedSum of ins)
 	
-	//Makes use of inheritance to find outputs as done with linear-activation networks
-	LinearLayerNetwork::CalcOutputs(inputs);
+	PROFILE_PHASE (depth, PHASE_FORWARD, 2.0 * numWeights);
 	
+	//Makes use of inheritance to find outputs as done with linear-activation networks
+	WeightedSums(inputs);
 	
-	for (int neuron_counter=0; neuron_counter < numNeurons; neuron_counter++) 
-	{	
-		//Actual output = 1 / (1 + exp( - temp_output ) )
-		outputs[neuron_counter] = 1 / (1 + exp( -1 * outputs[neuron_counter]));
-	} 
+	Activate (outputs, numNeurons);
+}
+
+
+///<summary>
+/// Applies the sigmoid to each weighted sum
+///
+///<argument="double values[]">Array containing the weighted sums</argument>
+///<argument="int count">Amount of values</argument>
+///</summary>
+void SigmoidalLayerNetwork::Activate (double values[], int count) {
+
+	//Actual output = 1 / (1 + exp( - temp_output ) )
+	ActivateValues<SigmoidActivation> (values, count);
 }
 
 ///<summary>
@@ -336,12 +1276,67 @@ void SigmoidalLayerNetwork::CalcOutputs(const double inputs[]) {
 ///</summary>
 void SigmoidalLayerNetwork::FindDeltas (const double errors[]) {		
 	
-	for(int output_index=0; output_index < numNeurons; output_index++)
-	{
-		//Calculates delta for each neuron
-		deltas[output_index] = outputs[output_index] * (1 - outputs[output_index]) * errors[output_index];
-	}
+	PROFILE_PHASE (depth, PHASE_DELTAS, 3.0 * numNeurons);
+	
+	//Calculates delta for each neuron
+	ActivationDeltas<SigmoidActivation> (outputs, errors, deltas, numNeurons);
+}
+
+// Implementation of SoftmaxLayerNetwork *****************************
+
+SoftmaxLayerNetwork::SoftmaxLayerNetwork (int numInputs, int numOutputs, Arena *arena):LinearLayerNetwork (numInputs, numOutputs, arena) 
+{
+	// just use inherited constructor - no extra variables to initialise
+}
+
+SoftmaxLayerNetwork::~SoftmaxLayerNetwork() 
+{
+	// destructor - does not need to do anything other than call inherited destructor
+}
+
+
+char SoftmaxLayerNetwork::LayerType () 
+{
+	return 'C';
+}
+
+
+///<summary>
+///	Calculates the outputs of the softmax layer
+/// Equation:
+/// output = exp( sum ) / SUM{ exp( sums of all neurons ) }
+///
+///<argument="const double inputs[]">Array containing the inputs</argument>
+///</summary>
+void SoftmaxLayerNetwork::CalcOutputs(const double inputs[]) {
+	
+	PROFILE_PHASE (depth, PHASE_FORWARD, 2.0 * numWeights);
+	
+	WeightedSums(inputs);
+	
+	Softmax (outputs, numNeurons);
+}
+
+
+void SoftmaxLayerNetwork::Activate (double values[], int count) {
+
+	for (int row_start=0; row_start < count; row_start += numNeurons)
+		Softmax (&values[row_start], numNeurons);
+}
+
+
+///<summary>
+/// Calculates and stores the deltas for softmax outputs trained on the cross-entropy
+/// Equation:
+/// Deltas = Errors = Targets - Outputs
+///
+///<argument="const double errors[]">Array containing the errors</argument>
+///</summary>
+void SoftmaxLayerNetwork::FindDeltas (const double errors[]) {
 	
+	PROFILE_PHASE (depth, PHASE_DELTAS, 0);
+	
+	dcopy(numNeurons, errors, deltas);
 }
 
 /* Implementation of MultiLayerNetwork *****************************/
@@ -352,15 +1347,22 @@ void SigmoidalLayerNetwork::FindDeltas (const double errors[]) {
 ///<argument="int numInputs"> Amount of inputs to the layer</argument>
 ///<argument="int numOutputs"> Amount of outputs to the layer</argument>
 ///<argyment="LinearLayerNetwork *to_next_layer"> Pointer to the next layer</argument>
+///<argument="Arena *arena"> Arena shared by the layers of the network, or 0</argument>
 ///</summary>
-MultiLayerNetwork::MultiLayerNetwork (int numInputs, int numOutputs, LinearLayerNetwork *to_next_layer) :SigmoidalLayerNetwork (numInputs, numOutputs) 
+MultiLayerNetwork::MultiLayerNetwork (int numInputs, int numOutputs, LinearLayerNetwork *to_next_layer, Arena *arena) :SigmoidalLayerNetwork (numInputs, numOutputs, arena) 
 {
 	// Construct a hidden layer with numInputs inputs and numOutputs outputs
 	// Where (a pointer to) its next layer is in to_next_layer
-	to_next_layer = new SigmoidalLayerNetwork(numInputs, numOutputs);
 
 	// Attach the pointer to the next layer that is passed
 	nextlayer = to_next_layer;
+	
+	// Number the layers after this one, by which their phases are timed
+	int next_depth = depth + 1;
+	for (LinearLayerNetwork *layer = nextlayer; layer != 0; layer = layer->NextLayer()) layer->depth = next_depth++;
+	
+	// The shared arena is freed with this layer, after the next layer is deleted
+	if (arena != 0) memory = arena;
 }
 
 ///<summary>
@@ -489,4 +1491,190 @@ void MultiLayerNetwork::ReturnTheWeights (double theWeights[])
 	dcopy (HowManyWeights(), buffer, theWeights);
 }
 
+///<summary>
+/// Initialises the changes in weights of the main layer, then of the next layer
+///</summary>
+void MultiLayerNetwork::SetTheDeltaWeights (const double initialDeltaWeights[])
+{
+	LinearLayerNetwork::SetTheDeltaWeights(initialDeltaWeights);
+	
+	nextlayer -> SetTheDeltaWeights(&initialDeltaWeights[numWeights]);
+}
+
+
+///<summary>
+/// Copies the changes in weights of the main layer, then of the next layer
+///</summary>
+void MultiLayerNetwork::ReturnTheDeltaWeights (double theDeltaWeights[]) 
+{
+	LinearLayerNetwork::ReturnTheDeltaWeights(theDeltaWeights);
+	
+	nextlayer -> ReturnTheDeltaWeights(&theDeltaWeights[numWeights]);
+}
+
+
+char MultiLayerNetwork::LayerType () 
+{
+	return 'M';
+}
+
+
+LinearLayerNetwork * MultiLayerNetwork::NextLayer () 
+{
+	return nextlayer;
+}
+
+
+///<summary>
+/// Hidden outputs go at the start of the workspace; the rest is handed to the next layer
+///</summary>
+void MultiLayerNetwork::ForwardBatch (const double inputs[], int numRows, double batchOutputs[], double workspace[]) 
+{
+	double *hiddenOutputs = workspace;
+	
+	SigmoidalLayerNetwork::ForwardBatch (inputs, numRows, hiddenOutputs, 0);
+	
+	nextlayer->ForwardBatch (hiddenOutputs, numRows, batchOutputs, &workspace[numRows * numNeurons]);
+}
+
+
+int MultiLayerNetwork::BatchWorkspace (int numRows) 
+{
+	return numRows * numNeurons + nextlayer->BatchWorkspace (numRows);
+}
+
+
+int MultiLayerNetwork::HowManyOutputs () 
+{
+	return nextlayer->HowManyOutputs();
+}
+
+
+///<summary>
+/// Returns the outputs of the next layer, which are the outputs of the network
+///</summary>
+double * MultiLayerNetwork::NetworkOutputs () 
+{
+	return nextlayer->NetworkOutputs();
+}
+
+
+/* Implementation of ActivationMultiLayerNetwork *****************************/
+
+template <class Act> ActivationMultiLayerNetwork<Act>::ActivationMultiLayerNetwork (int numInputs, int numOutputs, LinearLayerNetwork *to_next_layer, Arena *arena) :MultiLayerNetwork (numInputs, numOutputs, to_next_layer, arena) 
+{
+	// just use inherited constructor - the activation is the template argument
+}
+
+
+template <class Act> char ActivationMultiLayerNetwork<Act>::LayerType () 
+{
+	return Act::TYPE;
+}
+
+
+///<summary>
+/// Calculates the outputs of this layer then of the next layer, as MultiLayerNetwork does
+///
+///<argument="const double Inputs[]"> An array containing inputs to the network</argument>
+///</summary>
+template <class Act> void ActivationMultiLayerNetwork<Act>::CalcOutputs (const double Inputs[]) 
+{
+	{
+		PROFILE_PHASE (depth, PHASE_FORWARD, 2.0 * numWeights);
+		
+		WeightedSums (Inputs);
+		ActivateValues<Act> (outputs, numNeurons);
+	}
+	
+	nextlayer->CalcOutputs (outputs);
+}
+
+
+template <class Act> void ActivationMultiLayerNetwork<Act>::Activate (double values[], int count) 
+{
+	ActivateValues<Act> (values, count);
+}
+
+
+///<summary>
+/// Calculates the deltas in the next layer, then back-propagates its errors to this layer, as MultiLayerNetwork does
+///
+///<argument="const double Errors[]"> Array containing the errors of the network (target - output)</argument>
+///</summary>
+template <class Act> void ActivationMultiLayerNetwork<Act>::FindDeltas (const double Errors[]) 
+{
+	nextlayer->FindDeltas (Errors);
+	
+	double thisErrors[numNeurons];
+	nextlayer->PrevLayersErrors (thisErrors);
+	
+	PROFILE_PHASE (depth, PHASE_DELTAS, (double) Act::DELTA_FLOPS * numNeurons);
+	
+	ActivationDeltas<Act> (outputs, thisErrors, deltas, numNeurons);
+}
+
+
+///<summary>
+/// Creates and returns a neural-layer
+///
+///<argument="char option"> Controls the mode of operation of the function:
+/// IF = 'L': Creates and returns linear activation layer
+/// IF = 'S': Creates and returns sigmoidal activation layer 
+/// IF = 'T', 'R', 'E' or 'H': Creates and returns multi-layer network of that hidden activation
+/// IF = 'C': Creates and returns multi-layer network with a softmax output layer
+/// ELSE: Creates and returns multi-layer sigmoidal activation network</argument>
+///<argument="int hiddenNodes">Number of nodes in the hidden layer</argument>
+///<argument="dataset &data">Location to the dataset containing data to be used</argument>
+///
+///<return="LinearLayerNetwork*">Layer of neurons</return>
+///</summary>
+LinearLayerNetwork * MakeNet (char option, int hiddenNodes, dataset &data) {
+
+	return MakeNet (option, data.numIns(), hiddenNodes, data.numOuts());
+}
+
+
+///<summary>
+/// Creates and returns a neural-layer of the given size
+///
+///<argument="char option"> 'L' linear layer, 'S' sigmoidal layer, 'T', 'R', 'E' or 'H' multi-layer network of that
+/// hidden activation, 'C' multi-layer network with a softmax output layer, else multi-layer sigmoidal network</argument>
+///<argument="int numInputs">Number of inputs to the network</argument>
+///<argument="int hiddenNodes">Number of nodes in the hidden layer</argument>
+///<argument="int numOutputs">Number of outputs of the network</argument>
+///</summary>
+LinearLayerNetwork * MakeNet (char option, int numInputs, int hiddenNodes, int numOutputs) {
+								
+	switch(option)
+	{
+		case 'L': //Creates and returns single Linear activation layer
+		return new LinearLayerNetwork (numInputs, numOutputs);
+		
+		case 'S': //Creates and returns single Sigmoidal activation layer
+		return new SigmoidalLayerNetwork (numInputs, numOutputs);
+		
+		default: //Creates and returns Milti Sigmoidal activation layer, with both layers in one arena
+		{
+			Arena *arena = new Arena (LinearLayerNetwork::LayerBytes (numInputs, hiddenNodes) 
+									+ LinearLayerNetwork::LayerBytes (hiddenNodes, numOutputs));
+			
+			//The output layer is made first, so takes its random weights before the hidden layer, as it always has.
+			//It is sigmoidal, as targets are in 0..1, unless giving the probabilities of classes
+			LinearLayerNetwork *outputLayer;
+			if (option == 'C') outputLayer = new SoftmaxLayerNetwork (hiddenNodes, numOutputs, arena);
+			else outputLayer = new SigmoidalLayerNetwork (hiddenNodes, numOutputs, arena);
+			
+			switch (option)
+			{
+				case TanhActivation::TYPE: return new ActivationMultiLayerNetwork<TanhActivation> (numInputs, hiddenNodes, outputLayer, arena);
+				case ReluActivation::TYPE: return new ActivationMultiLayerNetwork<ReluActivation> (numInputs, hiddenNodes, outputLayer, arena);
+				case LeakyReluActivation::TYPE: return new ActivationMultiLayerNetwork<LeakyReluActivation> (numInputs, hiddenNodes, outputLayer, arena);
+				case HardSigmoidActivation::TYPE: return new ActivationMultiLayerNetwork<HardSigmoidActivation> (numInputs, hiddenNodes, outputLayer, arena);
+				default: return new MultiLayerNetwork (numInputs, hiddenNodes, outputLayer, arena);
+			}
+		}
+	}
+}
+
 #endif
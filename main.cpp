@@ -21,6 +21,25 @@
 
 
 
+///<summary>
+/// Reports when a data set could not be loaded
+///
+///<argument="dataset &data"> Location to the dataset that was loaded</argument>
+///<argument="const char *filename"> Path and filename the dataset was loaded from</argument>
+///
+///<return="bool"> True if the dataset is empty</return>
+///</summary>
+bool data_missing (dataset &data, const char *filename) {
+
+	if (data.numIns() == 0)
+	{
+		cout << filename << " [!] File not found : May be in wrong directory" << endl;
+		return true;
+	}
+	return false;
+}
+
+
 ///<summary>
 /// Tests the network by passing each element in dataset: data to network: net
 ///
@@ -30,14 +49,48 @@
 ///	IF = 0: prints SSE and % classifications
 ///	IF = 1: prints above + inputs and outputs
 /// IF = -1: doesn't print anything</argument>
+///<argument="HardwareCounters *events"> If given, counts the hardware events of the pass and prints them after the SSE</argument>
 ///</summary>
-void TestTheNet (LinearLayerNetwork *net, dataset &data, int option) {
+void TestTheNet (LinearLayerNetwork *net, dataset &data, int option, HardwareCounters *events = 0) {
 
+	//SSE and % classifications, found in the same pass as the outputs
+	MetricsAccumulator metrics (data);
+	
+	if (events) events -> Start();
+	
 	//Passes dataset to network	
-	net -> ComputeNetwork (data);
+	net -> ComputeNetwork (data, &metrics);
+	
+	if (events) events -> Stop();
 	
 	//Printing mode as described in summary
-	if (option >= 0) data.printdata(option);
+	if (option >= 0) data.printdata(option, &metrics);
+	
+	if (events && option >= 0) events -> Print (data.numData());
+}
+
+
+///<summary>
+/// Opens hardware event counters, or reports why they cannot be used
+///
+///<argument="bool count_events"> If false, no counters are opened</argument>
+///
+///<return="HardwareCounters*"> The counters, or 0 if not wanted or none could be opened</return>
+///</summary>
+HardwareCounters * OpenCounters (bool count_events) {
+
+	if (!count_events) return 0;
+	
+	HardwareCounters *events = new HardwareCounters();
+	
+	if (!events -> Available())
+	{
+		cout << "Hardware counters unavailable [" << events -> Error() << "] : training without them" << endl;
+		delete events;
+		return 0;
+	}
+	
+	return events;
 }				
 
 
@@ -90,35 +143,6 @@ void SetTheWeights (LinearLayerNetwork *net, char option) {
 }
 
 
-///<summary>
-/// Creates and returns a neural-layer
-///
-///<argument="char option"> Controls the mode of operation of the function:
-/// IF = 'L': Creates and returns linear activation layer
-/// IF = 'S': Creates and returns sigmoidal activation layer 
-/// ELSE: Creates and returns multi-layer sigmoidal activation network</argument>
-///<argument="int hiddenNodes">Number of nodes in the hidden layer</argument>
-///<argument="dataset &data">Location to the dataset containing data to be used</argument>
-///
-///<return="LinearLayerNetwork*">Layer of neurons</return>
-///</summary>
-LinearLayerNetwork * MakeNet (char option, int hiddenNodes, dataset &data) {
-								
-	switch(option)
-	{
-		case 'L': //Creates and returns single Linear activation layer
-		return new LinearLayerNetwork (data.numIns(), data.numOuts());
-		
-		case 'S': //Creates and returns single Sigmoidal activation layer
-		return new SigmoidalLayerNetwork (data.numIns(), data.numOuts());
-		
-		default: //Creates and returns Milti Sigmoidal activation layer
-		return new MultiLayerNetwork (data.numIns(), hiddenNodes, new SigmoidalLayerNetwork (hiddenNodes, data.numOuts()) );
-		
-	}
-}
-
-						
 ///<summary>
 /// Gets character input from user, sets letter to upper case if it isn't so already.
 ///
@@ -213,8 +237,9 @@ void setlparas (double* learningParameters) {
 ///<argument="char* filename"> Path to file from which to load data</argument>
 ///<argument="char* dataname"> Name to be given to the data</argument>
 ///<argument="double* learningParameters">Array containing the parameters: {learning-rate, momentum}</argument>
+///<argument="TelemetrySink epoch_log">Where the epochs of learning are reported: the console, or a file named after the data</argument>
 ///</summary>
-void testnet (char network_option, int weight_option, int hiddenNodes, char* filename, char* dataname, double* learningParameters) {
+void testnet (char network_option, int weight_option, int hiddenNodes, char* filename, char* dataname, double* learningParameters, TelemetrySink epoch_log = SINK_CONSOLE) {
 	
 	//Maximum amount of Epochs
 	int max_epoch;
@@ -238,7 +263,7 @@ void testnet (char network_option, int weight_option, int hiddenNodes, char* fil
 	}
 
 	//Initialise random-number generator
-	srand(weight_option);
+	SeedThreadRandom(weight_option);
 	
 	//IF statement is true:
 	//For linear-activation networks
@@ -255,6 +280,9 @@ void testnet (char network_option, int weight_option, int hiddenNodes, char* fil
 	//Creates the appropriate neural-network
 	LinearLayerNetwork *net = MakeNet (network_option, hiddenNodes, data);
 	
+	//SSE and % classifications of the epochs that are printed
+	MetricsAccumulator metrics (data);
+	
 	
 	//IF statement is true:
 	//For when weights are not random						
@@ -275,7 +303,7 @@ void testnet (char network_option, int weight_option, int hiddenNodes, char* fil
 	while(!exit)
 	{
 		cout << endl << "SELECT:" << endl 
-					 << "[L]earn. [P]resent Data. [C]hange Learning Constants. Find [W]eights. [S]ave Learnt Data. [A]bort." << endl
+					 << "[L]earn. [P]resent Data. [C]hange Learning Constants. Find [W]eights. [S]ave Learnt Data. [K]eep Checkpoint. [R]esume Checkpoint. [A]bort." << endl
 					 << ">" << flush;
 		user_input = getcapch(); 
 		
@@ -286,24 +314,38 @@ void testnet (char network_option, int weight_option, int hiddenNodes, char* fil
 			
 			case 'L': //Mode: Learn
 			{
+				//Epochs reported from a thread of their own, so learning never waits on the console or a file
+				Telemetry *epochs = new Telemetry (epoch_log, dataname, data.numOuts());
+				
+				//SSE for logic and numerical data, % classifications for classifiers, as printdata shows
+				bool sse = data.dataType() < 2;
+				
 				for(int i = 0; i < max_epoch; i++)
 				{
-					//Passes data to the network and updates weights
-					net -> AdaptNetwork (data, learningParameters);
-					
-					//IF statement is true:
 					//Every Epochs for linear-activation networks
 					//Every 200 Epochs for sigmoidal-activation networks
-					if( (max_epoch < 10) || ((i % 200) == 0))
+					bool report = (max_epoch < 10) || ((i % 200) == 0);
+					
+					double start = epochs -> Now();
+					
+					//Passes data to the network and updates weights, finding the metrics only if they are to be printed
+					net -> AdaptNetwork (data, learningParameters, report ? &metrics : 0);
+					
+					double seconds = epochs -> Now() - start;
+					
+					if(report)
 					{
-						//Prints the Epoch number 
-						cout << "\n\tEpoch " << setw(6) << i + current_epoch << endl;
-		
-						//Prints the relevant data
-						data.printdata(0);
+						//Reports the Epoch number and the relevant data
+						epochs -> Record (sse ? TELEMETRY_SSE : TELEMETRY_CORRECT, i + current_epoch, 
+										  sse ? metrics.CalcSSE() : metrics.CalcCorrectClassifications(), data.numOuts(), start, seconds, dataname);
 					}
+					else epochs -> Record (TELEMETRY_TIMING, i + current_epoch, 0, 0, start, seconds, dataname);
 					
 				}
+				
+				//Waits for the last epochs to be reported
+				delete epochs;
+				
 				//Updates current Epoch to its true value
 				current_epoch = current_epoch + max_epoch - 1;
 			} break;
@@ -326,16 +368,120 @@ void testnet (char network_option, int weight_option, int hiddenNodes, char* fil
 				data.savedata();			
 			} break;
 			
+			case 'K'://Mode: Keep Checkpoint of the network and training state
+			{
+				TrainingState state = { current_epoch, { learningParameters[0], learningParameters[1] }, 0, ORDER_FILE };
+				
+				string checkpoint_name = string(dataname) + ".ckpt";
+				
+				if (Checkpoint::Save (checkpoint_name.c_str(), net, state, &data))
+					cout << "Checkpoint saved to " << checkpoint_name << endl;
+				else
+					cout << "Unable to create " << checkpoint_name << endl;
+			} break;
+			
+			case 'R'://Mode: Resume from Checkpoint, replacing the network and training state
+			{
+				TrainingState state;
+				
+				string checkpoint_name = string(dataname) + ".ckpt";
+				
+				LinearLayerNetwork *loaded = Checkpoint::Load (checkpoint_name.c_str(), state);
+				
+				//Checkpoint must fit the data
+				if ( (loaded == 0) || (loaded->HowManyInputs() != data.numIns()) || (loaded->HowManyOutputs() != data.numOuts()) )
+				{
+					cout << checkpoint_name << " [!] Not found or not a checkpoint for this data" << endl;
+					delete loaded;
+				} 
+				else 
+				{
+					delete net;
+					net = loaded;
+					
+					current_epoch = (int) state.epoch;
+					dcopy (2, state.learningParameters, learningParameters);
+					
+					cout << "Resumed at Epoch " << current_epoch << endl;
+					TestTheNet (net, data, 1);
+				}
+			} break;
+			
 			//Ignore unrecognised inputs
 			default: break;
 		}
 	}
+	
+	delete net;
+}
+
+
+///<summary>
+/// Prints the time taken by each phase of each layer since the last PhaseProfile::Reset(), and saves it as JSON.
+/// Does nothing unless built with ANN_PROFILE defined
+///
+///<argument="const char *dataname"> Name of the data set trained on; the JSON is saved to <dataname>.profile.json</argument>
+///</summary>
+void ReportProfile (const char *dataname) {
+
+	if (!PhaseProfile::Enabled()) return;
+	
+	PhaseProfile::Print();
+	
+	string profile_name = string(dataname) + ".profile.json";
+	
+	FILE *file = fopen (profile_name.c_str(), "w");
+	if (file == 0)
+	{
+		cout << profile_name << " [!] Unable to create" << endl;
+		return;
+	}
+	
+	PhaseProfile::WriteJson (file);
+	fprintf (file, "\n");
+	fclose (file);
+}
+
+
+///<summary>
+/// Replaces the network with the latest of the rotating checkpoints a CheckpointScheduler wrote, if one fits the data,
+/// so a run stopped part way carries on where its last checkpoint left it
+///
+///<argument="const char *baseName"> Start of the name of each checkpoint, as given to the CheckpointScheduler</argument>
+///<argument="LinearLayerNetwork *&net"> Network, replaced by the checkpoint's</argument>
+///<argument="dataset &data"> Data the network is trained on</argument>
+///<argument="double* learningParameters"> Array onto which the saved parameters are copied: {learning-rate, momentum}</argument>
+///
+///<return="int"> Epoch to carry on from, 0 if there is no checkpoint to resume</return>
+///</summary>
+int ResumeLatest (const char *baseName, LinearLayerNetwork *&net, dataset &data, double* learningParameters) {
+
+	TrainingState state;
+	
+	LinearLayerNetwork *loaded = CheckpointScheduler::LoadLatest (baseName, 3, state);
+	
+	//Checkpoint must fit the data
+	if ( (loaded == 0) || (loaded->HowManyInputs() != data.numIns()) || (loaded->HowManyOutputs() != data.numOuts()) )
+	{
+		cout << baseName << " [!] No checkpoint for this data : training from the start" << endl;
+		delete loaded;
+		return 0;
+	}
+	
+	delete net;
+	net = loaded;
+	
+	dcopy (2, state.learningParameters, learningParameters);
+	
+	cout << "Resumed at Epoch " << state.epoch << endl;
+	return (int) state.epoch;
 }
 
 
 ///<summary>
 /// Exposes a network against a training set and an unseen set, saves the end result 
-/// so that it can be plotted using tadpole
+/// so that it can be plotted using tadpole. The class of each item is given as one target per class,
+/// and the network has a softmax output layer giving the probability of each
 ///
 ///<argument="double* learningParameters">Array containing the parameters: {learning-rate, momentum}</argument>
 ///<argument="int hiddenNeurons">Number of hidden neurons to be used in the network</argument>
@@ -345,15 +491,22 @@ void testnet (char network_option, int weight_option, int hiddenNodes, char* fil
 /// ELSE: sets random weights</argument>
 ///<argument="char *training_set">Used to create the training set</argument>
 ///<argument="char *unseen_set">Used to create the unseen set</argument>
+///<argument="int checkpoint_every">Epochs between checkpoints written in the background to iristrain.<n>.ckpt, 0 for none</argument>
+///<argument="bool resume">If true, carries on from the latest of those checkpoints, if there is one</argument>
+///<argument="bool count_events">If true, hardware events of each epoch are counted and printed next to the % classifications</argument>
+///<argument="TelemetrySink epoch_log">Where the epochs are reported: the console, or a file named iristrain.*</argument>
 ///</summary>
-void classtest (double* learningParameters, int hiddenNeurons, int max_epoch, int weight_option, char *training_set, char *unseen_set) {
+void classtest (double* learningParameters, int hiddenNeurons, int max_epoch, int weight_option, char *training_set, char *unseen_set, int checkpoint_every = 0, bool resume = false, bool count_events = false, TelemetrySink epoch_log = SINK_CONSOLE) {
 	
 	//Unused variables?
 	//(previous sum of valid.SSE, current sum)
 	//double vwas = 1000, vsum = 0;			
 	
 	//Initialises random-number generator
-	srand(weight_option);
+	SeedThreadRandom(weight_option);
+	
+	//Times only this run
+	PhaseProfile::Reset();
 	
 	//Creates the training set
     dataset train (training_set, "iristrain");
@@ -361,47 +514,93 @@ void classtest (double* learningParameters, int hiddenNeurons, int max_epoch, in
     //Creates the unseen set
 	dataset unseen (unseen_set, "irisunseen");
 	
-	//Creates a network with given nymber of hidden neurons
-	LinearLayerNetwork * net = MakeNet ('N', hiddenNeurons, train);
+	//One target per class, so each item is classified by the largest output
+	train.MakeOneHot();
+	unseen.MakeOneHot();
+	
+	//Creates a network with given nymber of hidden neurons, and a softmax output if the sets have one-hot classes
+	LinearLayerNetwork * net = MakeNet ((train.dataType() == 3) ? 'C' : 'N', hiddenNeurons, train);
+	
+	//Epoch to start from: that of the latest checkpoint, if resuming
+	int first_epoch = resume ? ResumeLatest ("iristrain", net, train, learningParameters) : 0;
+	
+	//Cycles, instructions and misses of each pass, if wanted and available
+	HardwareCounters *events = OpenCounters (count_events);
 	
 	//Test the training set on the untrained network
-	TestTheNet (net, train, 0);				
+	TestTheNet (net, train, 0, events);				
 	
 	//Test the unseen set on the network
-	TestTheNet (net, unseen, 0);			
+	TestTheNet (net, unseen, 0, events);			
 	
 	//Epoch number so far
 	int current_epoch; 
+	
+	//% classifications of the epochs that are printed
+	MetricsAccumulator metrics (train);
+	
+	//Rotating checkpoints, written without holding up training
+	CheckpointScheduler *checkpoints = (checkpoint_every > 0) ? new CheckpointScheduler ("iristrain", net, checkpoint_every, 0, 3, &train) : 0;
+	
+	//Epochs reported from a thread of their own, so training never waits on the console or a file
+	Telemetry *epochs = new Telemetry (epoch_log, "iristrain", train.numOuts());
 
 	//Train until max_epoch is reached
-	for( current_epoch = 0; current_epoch < max_epoch; current_epoch++ )
+	for( current_epoch = first_epoch; current_epoch < max_epoch; current_epoch++ )
 	{
+		//Every 50 epochs
+		bool report = (current_epoch % 50) == 0;
+		
+		double start = epochs -> Now();
+		
+		if(events) events -> Start();
+		
 		//Pass the training set to the network
-		net -> AdaptNetwork (train, learningParameters);
+		net -> AdaptNetwork (train, learningParameters, report ? &metrics : 0);
 		
-		//IF statement is true:
-		//Every 50 epochs
-		if( (current_epoch % 50) == 0)
+		if(events) events -> Stop();
+		
+		double seconds = epochs -> Now() - start;
+		
+		if(checkpoints != 0)
 		{
-			//Prints current Epoch
-			cout << "\t" << current_epoch << flush;
-			
-			//Prints relevant data
-			train.printarray(" ", 'C', 0, -1);
+			TrainingState state = { current_epoch + 1, { learningParameters[0], learningParameters[1] }, 0, ORDER_FILE };
+			checkpoints -> Poll (net, state);
 		}
+		
+		//Reports current Epoch and relevant data, and the events of the epoch on the same line;
+		//one-hot outputs all hold the % of the whole class, so only one is reported
+		if(report) epochs -> Record (TELEMETRY_CORRECT, current_epoch, metrics.CalcCorrectClassifications(), (train.dataType() == 3) ? 1 : train.numOuts(), start, seconds, 0, events, train.numData());
+		else epochs -> Record (TELEMETRY_TIMING, current_epoch, 0, 0, start, seconds, 0, events, train.numData());
+	}
+	
+	//Waits for the last epochs to be reported
+	delete epochs;
+	
+	//Waits for the last checkpoint to be written
+	if(checkpoints != 0)
+	{
+		checkpoints -> Flush();
+		cout << "Checkpoints written: [" << checkpoints -> Written() << "] put off: [" << checkpoints -> Deferred() << "]" << endl;
+		delete checkpoints;
 	}
 	
 	//Tests the training set on the trained network AND prints %(percentage) classification
-	TestTheNet (net, train, 0);
+	TestTheNet (net, train, 0, events);
 	
 	//Saves data in a file tadpole can use to plot
 	train.savedata(1);
 	
 	//Tests the unseen set on the trained network AND prints %(percentage) classification
-	TestTheNet (net, unseen, 0);
+	TestTheNet (net, unseen, 0, events);
+	
+	delete events;
 	
 	//Saves data in a file tadpole can use to plot
 	unseen.savedata(1);						
+	
+	//Where the time went, when built with ANN_PROFILE
+	ReportProfile ("iristrain");
 }
 
 
@@ -418,12 +617,19 @@ void classtest (double* learningParameters, int hiddenNeurons, int max_epoch, in
 ///<argument="char *training_set">Path and filename for the training set</argument>
 ///<argument="char *validation_set">Path and filename for the validation set</argument>
 ///<argument="char *unseen_set">Path and filename for the unseen set</argument>
+///<argument="int checkpoint_every">Epochs between checkpoints written in the background to Training_set.<n>.ckpt, 0 for none</argument>
+///<argument="bool resume">If true, carries on from the latest of those checkpoints, if there is one</argument>
+///<argument="bool count_events">If true, hardware events of each epoch are counted and printed next to the % classifications</argument>
+///<argument="TelemetrySink epoch_log">Where the epochs are reported: the console, or a file named Training_set.*</argument>
 ///</summary>
-void numtest (double* learningParameters, int hiddenNeurons, int max_epoch, int usevalid, int weight_option, char *training_set, char *validation_set, char *unseen_set) 
+void numtest (double* learningParameters, int hiddenNeurons, int max_epoch, int usevalid, int weight_option, char *training_set, char *validation_set, char *unseen_set, int checkpoint_every = 0, bool resume = false, bool count_events = false, TelemetrySink epoch_log = SINK_CONSOLE) 
 {
 	
 	//Initialise Random-Number Generator
-	srand(weight_option);
+	SeedThreadRandom(weight_option);
+	
+	//Times only this run
+	PhaseProfile::Reset();
 	
 	//Declare and Initialise dataset for the Training Set
 	dataset train (training_set, "Training_set");
@@ -439,14 +645,20 @@ void numtest (double* learningParameters, int hiddenNeurons, int max_epoch, int
 	//Create network (using MakeNet() )
 	LinearLayerNetwork *net = MakeNet (usevalid, hiddenNeurons, train);
 	
+	//Epoch to start from: that of the latest checkpoint, if resuming
+	int first_epoch = resume ? ResumeLatest ("Training_set", net, train, learningParameters) : 0;
+	
+	//Cycles, instructions and misses of each pass, if wanted and available
+	HardwareCounters *events = OpenCounters (count_events);
+	
 	//Show Training Set to untrained network and report SSE
-	TestTheNet (net, train, 0);
+	TestTheNet (net, train, 0, events);
 	
 	//IF usevalid is TRUE, show Validation Set to untrained network and report SSE 
-	if(usevalid) TestTheNet(net, validation, 0);
+	if(usevalid) TestTheNet(net, validation, 0, events);
 	
 	//Show Unseen set to trained network and report SSE
-	TestTheNet (net, unseen, 0);
+	TestTheNet (net, unseen, 0, events);
 	
 	
 	//Epoch sentinel
@@ -460,12 +672,36 @@ void numtest (double* learningParameters, int hiddenNeurons, int max_epoch, int
 		double previous_average_SSE = 0;
 
 	
+		//% classifications of the epochs that are printed
+		MetricsAccumulator metrics (train);
+		
+		//Rotating checkpoints, written without holding up training
+		CheckpointScheduler *checkpoints = (checkpoint_every > 0) ? new CheckpointScheduler ("Training_set", net, checkpoint_every, 0, 3, &train) : 0;
+		
+		//Epochs reported from a thread of their own, so training never waits on the console or a file
+		Telemetry *epochs = new Telemetry (epoch_log, "Training_set", train.numOuts());
+
+	
 	//FOR each epoch 
-	for(current_epoch = 0; current_epoch < max_epoch; current_epoch++)
+	for(current_epoch = first_epoch; current_epoch < max_epoch; current_epoch++)
 	{
 	
-		//Pass training set to network
-		net -> AdaptNetwork (train, learningParameters);
+		double start = epochs -> Now();
+		
+		if(events) events -> Start();
+		
+		//Pass training set to network, finding the metrics on epochs that are printed
+		net -> AdaptNetwork (train, learningParameters, ((current_epoch % 20) == 0) ? &metrics : 0);
+		
+		if(events) events -> Stop();
+		
+		double seconds = epochs -> Now() - start;
+		
+		if(checkpoints != 0)
+		{
+			TrainingState state = { current_epoch + 1, { learningParameters[0], learningParameters[1] }, 0, ORDER_FILE };
+			checkpoints -> Poll (net, state);
+		}
 		
 		if(usevalid)
 		{	
@@ -473,16 +709,11 @@ void numtest (double* learningParameters, int hiddenNeurons, int max_epoch, int
 			current_average_SSE += validation.TotalSSE();
 		}
 	
-		//Print SSE on training set every 20 epoch
+		//Report on training set every 20 epoch: current Epoch, relevant data, and the events of the epoch on the same line
 		if( (current_epoch % 20) == 0)
-		{
-			//Prints current Epoch
-			cout << "\t" << current_epoch << flush;
-			
-			//Prints relevant data
-			train.printarray(" ", 'C', 0, -1);
-			
-		}
+			epochs -> Record (TELEMETRY_CORRECT, current_epoch, metrics.CalcCorrectClassifications(), train.numOuts(), start, seconds, 0, events, train.numData());
+		else
+			epochs -> Record (TELEMETRY_TIMING, current_epoch, 0, 0, start, seconds, 0, events, train.numData());
 		
 		//IF usevalid is true: THEN test every 10 Epochs
 		if( (usevalid) && ((current_epoch % 10) == 0) )
@@ -499,7 +730,8 @@ void numtest (double* learningParameters, int hiddenNeurons, int max_epoch, int
 				break;
 			}
 			
-			printf("\tCurrentSSE[%0.30f]\tPreviousSSE[%0.30f]\n\n", current_average_SSE, previous_average_SSE);
+			double averages[] = { current_average_SSE, previous_average_SSE };
+			epochs -> Record (TELEMETRY_VALIDATION, current_epoch, averages, 2, epochs -> Now(), 0);
 				
 			
 			//Prepares for next iteration
@@ -509,30 +741,438 @@ void numtest (double* learningParameters, int hiddenNeurons, int max_epoch, int
 		}
 	}
 	
+	//Waits for the last epochs to be reported
+	delete epochs;
+	
 	//Output number of epochs taken
 	printf("\nNumber of Epochs taken: [%d]\n", current_epoch);
 	
+	//Waits for the last checkpoint to be written
+	if(checkpoints != 0)
+	{
+		checkpoints -> Flush();
+		printf("Checkpoints written: [%d] put off: [%d]\n", checkpoints -> Written(), checkpoints -> Deferred());
+		delete checkpoints;
+	}
+	
 	//Pass Training Set to trained network and report SSE
-	TestTheNet (net, train, 0);
+	TestTheNet (net, train, 0, events);
 	
 	//IF usevalid is TRUE, show Validation Set to trained network and report SSE 
-	if(usevalid) TestTheNet(net, validation, 0);
+	if(usevalid) TestTheNet(net, validation, 0, events);
 	
 	//Pass Unseen set to trained network and report SSE
-	TestTheNet (net, unseen, 0);
+	TestTheNet (net, unseen, 0, events);
+	
+	delete events;
 	
 	//Saves data and sets it up for the tadpole plotting program
 	unseen.savedata(1);
 	
+	//Where the time went, when built with ANN_PROFILE
+	ReportProfile ("Training_set");
+}
+
+
+
+
+///<summary>
+/// Trains a multi-layered network from the same initial weights with each way of ordering the rows per epoch,
+/// then prints the epochs needed to reach a target SSE and the mean time per epoch for each
+///
+///<argument="double *learningParameters">Array containing the parameters: {learning-rate, momentum}</argument>
+///<argument="int hiddenNeurons">Number of hidden neurons in the network</argument>
+///<argument="int max_epoch">Maximum amount of epochs</argument>
+///<argument="double target_SSE">Training stops once the total SSE on the training set is below this</argument>
+///<argument="int weight_option">Seed for the random weights and for the orderings</argument>
+///<argument="const char *training_set">Path and filename for the training set</argument>
+///</summary>
+void ordertest (double* learningParameters, int hiddenNeurons, int max_epoch, double target_SSE, int weight_option, const char *training_set)
+{
+	dataset train (training_set, "Training_set");
+	
+	//If the file cannot be loaded
+	if (data_missing(train, training_set)) return;
+	
+	OrderStrategy strategies[] = { ORDER_FILE, ORDER_SHUFFLE, ORDER_BLOCK_SHUFFLE };
+	
+	for (int s = 0; s < 3; s++)
+	{
+		//Same initial weights for each strategy
+		SeedThreadRandom(weight_option);
+		
+		LinearLayerNetwork *net = MakeNet ('N', hiddenNeurons, train);
+		
+		SampleOrder order (train.numData(), strategies[s], weight_option, train.numInRow() * sizeof(double));
+		
+		//Time spent learning, excluding the SSE checks
+		double seconds = 0;
+		
+		int current_epoch;
+		bool reached = false;
+		
+		for (current_epoch = 0; current_epoch < max_epoch && !reached; current_epoch++)
+		{
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			
+			net -> AdaptNetwork (train, learningParameters, order.NextEpoch());
+			
+			seconds += chrono::duration<double> (chrono::steady_clock::now() - start).count();
+			
+			reached = train.TotalSSE() < target_SSE;
+		}
+		
+		cout << setw(14) << order.Name() << "  block rows " << setw(6) << order.BlockRows()
+			 << "  epochs " << setw(7) << current_epoch << (reached ? "" : " (target not reached)")
+			 << "  per epoch " << setw(10) << 1000 * seconds / current_epoch << "ms" << endl;
+		
+		delete net;
+	}
 }
 
 
+///<summary>
+/// Runs k-fold cross-validation of a multi-layered network on one data set, training the folds concurrently
+///
+///<argument="double *learningParameters">Array containing the parameters: {learning-rate, momentum}</argument>
+///<argument="int hiddenNeurons">Number of hidden neurons in the network</argument>
+///<argument="int max_epoch">Amount of epochs each fold is trained for</argument>
+///<argument="int numFolds">Amount of folds</argument>
+///<argument="int numThreads">Maximum amount of folds trained at once</argument>
+///<argument="int weight_option">Seed for the random weights</argument>
+///<argument="const char *data_set">Path and filename for the data set</argument>
+///</summary>
+void crossvalidate (double* learningParameters, int hiddenNeurons, int max_epoch, int numFolds, int numThreads, int weight_option, const char *data_set)
+{
+	//The one data set shared by all folds
+	dataset data (data_set, "CrossValidation_set");
+	
+	//If the file cannot be loaded
+	if (data_missing(data, data_set)) return;
+	
+	CrossValidator validator (data, numFolds, numThreads, 'N', hiddenNeurons, max_epoch, learningParameters);
+	
+	//Trains and tests all folds
+	validator.Run (weight_option);
+	
+	//Prints each fold, then mean and variance
+	validator.PrintReport ();
+}
 
 
 ///<summary>
-/// GUI for the program
+/// Serves a checkpointed network over a Unix domain socket and loads it from local clients, each sending
+/// the raw inputs of the rows of a data set in turn. Every reply is checked against the outputs found by
+/// passing the whole data set through the network, then the server's latencies and throughput are printed
+///
+///<argument="const char *checkpoint_name">Path and filename of the checkpoint to serve</argument>
+///<argument="const char *data_set">Path and filename for the data set the requests are taken from</argument>
+///<argument="int numClients">Amount of clients sending requests at once</argument>
+///<argument="int seconds">How long the clients send requests for</argument>
+///<argument="int poolThreads">Threads the wide layers of each batch are split across, 1 to run on the serving thread alone</argument>
 ///</summary>
-int main() {
+void servetest (const char *checkpoint_name, const char *data_set, int numClients, int seconds, int poolThreads)
+{
+	TrainingState state;
+	DataScaling scaling;
+	
+	LinearLayerNetwork *net = Checkpoint::Load (checkpoint_name, state, &scaling);
+	
+	dataset data (data_set, "Served_set");
+	
+	//If the file cannot be loaded
+	if (data_missing(data, data_set)) { delete net; return; }
+	
+	//A softmax classifier, as classtest checkpoints, was trained on one target per class
+	if (net != 0 && net->HowManyOutputs() > data.numOuts()) data.MakeOneHot();
+	
+	//Checkpoint must fit the data
+	if ( (net == 0) || (net->HowManyInputs() != data.numIns()) || (net->HowManyOutputs() != data.numOuts()) )
+	{
+		cout << checkpoint_name << " [!] Not found or not a checkpoint for this data" << endl;
+		delete net;
+		return;
+	}
+	
+	int numIns = data.numIns(), numOuts = data.numOuts();
+	
+	//Raw inputs of each row, and the outputs expected for them, found before any client starts
+	vector<double> rawInputs (data.numData() * numIns);
+	vector<double> expected (data.numData() * numOuts);
+	
+	net->ComputeNetwork (data);
+	
+	for (int row=0; row < data.numData(); row++)
+	{
+		dcopy (numIns, data.CalcScaledData(row, 'I'), &rawInputs[row * numIns]);
+		dcopy (numOuts, data.CalcScaledData(row, 'O'), &expected[row * numOuts]);
+	}
+	
+	const char *socket_path = "/tmp/ann_inference.sock";
+	
+	//Attached once the expected outputs are found, as only the serving thread may then run the network
+	SpinPool pool (poolThreads);
+	net->SetPool (&pool);
+	
+	InferenceServer server (net, scaling, socket_path);
+	
+	if (!server.Start())
+	{
+		cout << socket_path << " [!] Unable to create socket" << endl;
+		delete net;
+		return;
+	}
+	
+	atomic<long long> mismatches (0);
+	chrono::steady_clock::time_point stop = chrono::steady_clock::now() + chrono::seconds (seconds);
+	
+	vector<thread> clients;
+	
+	for (int c=0; c < numClients; c++)
+	{
+		clients.push_back (thread ([&, c] () {
+			
+			InferenceClient client (socket_path, numIns, numOuts);
+			double outputs[numOuts];
+			
+			for (int row = c % data.numData(); client.IsOpen() && chrono::steady_clock::now() < stop; row = (row + 1) % data.numData())
+			{
+				if (!client.Predict (&rawInputs[row * numIns], outputs)) break;
+				
+				for (int ct=0; ct < numOuts; ct++)
+					if (fabs (outputs[ct] - expected[row * numOuts + ct]) > 1e-9) mismatches++;
+			}
+		}));
+	}
+	
+	for (size_t c=0; c < clients.size(); c++) clients[c].join();
+	
+	server.Stop();
+	
+	cout << "Served " << checkpoint_name << " to [" << numClients << "] clients. Mismatched outputs [" << mismatches << "]" << endl;
+	server.PrintStats();
+	
+	delete net;
+}
+
+
+///<summary>
+/// Times predictions of single rows for several networks trained on one data set, both by wrapping each row in
+/// a dataset as was needed before and by a Predictor, then prints the latency percentiles of each and the
+/// largest difference between the Predictor and the outputs found by passing the whole data set through the network
+///
+///<argument="double *learningParameters">Array containing the parameters: {learning-rate, momentum}</argument>
+///<argument="int max_epoch">Amount of epochs each network is trained for</argument>
+///<argument="int weight_option">Seed for the random weights</argument>
+///<argument="const char *data_set">Path and filename for the data set</argument>
+///<argument="int poolThreads">Threads the wide layers of each Predictor are split across, 1 to predict on the calling thread alone</argument>
+///</summary>
+void predicttest (double* learningParameters, int max_epoch, int weight_option, const char *data_set, int poolThreads)
+{
+	dataset data (data_set, "Predicted_set");
+	
+	//If the file cannot be loaded
+	if (data_missing(data, data_set)) return;
+	
+	DataScaling scaling;
+	data.GetScaling (scaling);
+	
+	int numIns = data.numIns(), numOuts = data.numOuts();
+	
+	//Networks timed: {option, hidden neurons}
+	const char options[] = { 'L', 'S', 'N', 'N', 'N', 'N' };
+	const int hiddens[] = { 0, 0, 5, 10, 20, 50 };
+	const int numNetworks = 6;
+	
+	//Calls timed for each way of predicting
+	const int numCalls = 20000;
+	
+	//Raw inputs of every row
+	vector<double> rawInputs (data.numData() * numIns);
+	for (int row=0; row < data.numData(); row++)
+		dcopy (numIns, data.CalcScaledData(row, 'I'), &rawInputs[row * numIns]);
+	
+	vector<double> latencies (numCalls);
+	
+	SpinPool pool (poolThreads);
+	
+	printf ("\n%-10s %-10s %10s %10s %10s %12s\n", "Network", "Path", "p50 ns", "p99 ns", "p99.9 ns", "Max diff");
+	
+	for (int n=0; n < numNetworks; n++)
+	{
+		SeedThreadRandom (weight_option);
+		
+		LinearLayerNetwork *net = MakeNet (options[n], hiddens[n], data);
+		
+		for (int epoch=0; epoch < max_epoch; epoch++)
+			net->AdaptNetwork (data, learningParameters);
+		
+		//Outputs of every row, as the dataset rescales them
+		net->ComputeNetwork (data);
+		vector<double> expected (data.numData() * numOuts);
+		for (int row=0; row < data.numData(); row++)
+			dcopy (numOuts, data.CalcScaledData(row, 'O'), &expected[row * numOuts]);
+		
+		char name[16];
+		if (options[n] == 'N') sprintf (name, "M %d", hiddens[n]); else sprintf (name, "%c", options[n]);
+		
+		double outputs[numOuts];
+		
+		//Path 1 : wrap each row in a dataset
+		double maxDifference = 0;
+		for (int call=0; call < numCalls; call++)
+		{
+			int row = call % data.numData();
+			
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			
+			double rowData[numIns + numOuts];
+			scaling.ScaleInputs (&rawInputs[row * numIns], rowData);
+			for (int ct=0; ct < numOuts; ct++) rowData[numIns + ct] = 0;
+			
+			dataset single (numIns, numOuts, 1, rowData, "Single_row");
+			net->ComputeNetwork (single);
+			scaling.RescaleOutputs (single.GetNthOutputs(0), outputs);
+			
+			latencies[call] = chrono::duration<double, nano> (chrono::steady_clock::now() - start).count();
+			
+			for (int ct=0; ct < numOuts; ct++)
+				maxDifference = max (maxDifference, fabs (outputs[ct] - expected[row * numOuts + ct]));
+		}
+		
+		printf ("%-10s %-10s %10.0f %10.0f %10.0f %12.3g\n", name, "dataset", Percentile (latencies, 0.5), Percentile (latencies, 0.99), Percentile (latencies, 0.999), maxDifference);
+		
+		//Path 2 : Predictor, with the scaling folded into the weights
+		Predictor predictor (net, scaling);
+		predictor.SetPool (&pool);
+		
+		maxDifference = 0;
+		for (int call=0; call < numCalls; call++)
+		{
+			int row = call % data.numData();
+			
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			
+			predictor.Predict (&rawInputs[row * numIns], outputs);
+			
+			latencies[call] = chrono::duration<double, nano> (chrono::steady_clock::now() - start).count();
+			
+			for (int ct=0; ct < numOuts; ct++)
+				maxDifference = max (maxDifference, fabs (outputs[ct] - expected[row * numOuts + ct]));
+		}
+		
+		printf ("%-10s %-10s %10.0f %10.0f %10.0f %12.3g\n", name, "Predictor", Percentile (latencies, 0.5), Percentile (latencies, 0.99), Percentile (latencies, 0.999), maxDifference);
+		
+		delete net;
+	}
+}
+
+
+///<summary>
+/// Scores a file of any size with a checkpointed network, without the menu:
+///   score <checkpoint> <input file> <output file> [threads] [text|binary|columnar] [stages]
+/// then prints the rows scored and the time taken. Given more than one stage, the layers are pipelined across
+/// that many cores (see LayerPipeline) in place of the threads, and the occupancy of each stage is printed
+///
+///<argument="int argc">Amount of arguments, including the program name</argument>
+///<argument="char *argv[]">Arguments, argv[1] being "score"</argument>
+///
+///<return="int">0 if every row was scored, else 1</return>
+///</summary>
+int scorecommand (int argc, char *argv[])
+{
+	if (argc < 5)
+	{
+		cout << "Usage: " << argv[0] << " score <checkpoint> <input file> <output file> [threads] [text|binary|columnar] [stages]" << endl;
+		return 1;
+	}
+	
+	int numThreads = (argc > 5) ? atoi(argv[5]) : (int) thread::hardware_concurrency();
+	
+	WriterFormat format = WRITER_TEXT;
+	if (argc > 6 && strcmp(argv[6], "binary") == 0) format = WRITER_BINARY;
+	if (argc > 6 && strcmp(argv[6], "columnar") == 0) format = WRITER_COLUMNAR;
+	
+	TrainingState state;
+	DataScaling scaling;
+	
+	LinearLayerNetwork *net = Checkpoint::Load (argv[2], state, &scaling);
+	
+	if (net == 0)
+	{
+		cout << argv[2] << " [!] Not found or not a checkpoint" << endl;
+		return 1;
+	}
+	
+	BatchScorer scorer (net, scaling, numThreads);
+	
+	//Layers pipelined across cores, if more than one stage is asked for
+	int numStages = (argc > 7) ? atoi(argv[7]) : 1;
+	LayerPipeline *pipeline = (numStages > 1) ? new LayerPipeline (net, numStages) : 0;
+	scorer.UsePipeline (pipeline);
+	
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	
+	long long rows = scorer.Score (argv[3], argv[4], format);
+	
+	double seconds = chrono::duration<double> (chrono::steady_clock::now() - start).count();
+	
+	if (rows < 0) cout << argv[3] << " [!] " << scorer.Error() << endl;
+	else printf ("Scored [%lld] rows in [%.3f] seconds : [%.0f] rows/s\n", rows, seconds, rows / seconds);
+	
+	if (pipeline != 0 && rows >= 0) pipeline->Print();
+	
+	delete pipeline;
+	delete net;
+	
+	return (rows < 0) ? 1 : 0;
+}
+
+
+///<summary>
+/// Runs batches of experiments without the menu, writing results as JSON (see ExperimentDriver):
+///   run [--name value ...]
+///
+///<argument="int argc">Amount of arguments, including the program name</argument>
+///<argument="char *argv[]">Arguments, argv[1] being "run"</argument>
+///
+///<return="int">0 if all runs were made, else 1</return>
+///</summary>
+int runcommand (int argc, char *argv[])
+{
+	ExperimentDriver driver;
+	
+	if (!driver.ParseArguments (argc, argv, 2))
+	{
+		cerr << "[!] " << driver.Error() << endl;
+		ExperimentDriver::PrintUsage (argv[0]);
+		return 1;
+	}
+	
+	int status = driver.Run();
+	
+	if (status != 0) cerr << "[!] " << driver.Error() << endl;
+	
+	return status;
+}
+
+
+///<summary>
+/// GUI for the program; with arguments, runs the given command instead
+///</summary>
+int main(int argc, char *argv[]) {
+	
+	//Scoring of files and batches of experiments run without the menu
+	if (argc > 1 && strcmp(argv[1], "score") == 0) return scorecommand (argc, argv);
+	
+	if (argc > 1 && strcmp(argv[1], "run") == 0) return runcommand (argc, argv);
+	
+	if (argc > 1)
+	{
+		cout << "Usage: " << argv[0] << " [score | run] ..." << endl;
+		ExperimentDriver::PrintUsage (argv[0]);
+		return 1;
+	}
 	
 	int weight_option =0;
 
@@ -548,6 +1188,28 @@ int main() {
 	
 	char usevalid = 'Y';
 	
+	int numFolds = 5;
+	
+	double target_SSE = 0.01;
+	
+	int checkpoint_every = 0;
+	
+	char resume = 'N';
+	
+	string checkpoint_file = "iristrain.0.ckpt";
+	
+	int serve_seconds = 5;
+	
+	int pool_threads = 1;
+	
+	bool count_events = false;
+	
+	bool huge_pages = false;
+	
+	TelemetrySink epoch_log = SINK_CONSOLE;
+	
+	int numThreads = thread::hardware_concurrency() > 0 ? thread::hardware_concurrency() : 1;
+	
 
 	cout << "Richard J. Mitchell's Perceptron Network Program\n\tAdapted by Abdelrahmane Bray [Autumn 2014]" << endl;
 
@@ -583,9 +1245,16 @@ int main() {
 		cout << "Initial weights seed [" << weight_option << "] " << endl;
 		
 		cout << "Learning rate: [" << learningParameters[0] << "]. Momentum: [" << learningParameters[1] << "]" << endl;
+		
+		cout << "Hardware counters: [" << (count_events ? "on" : "off") << "]" << endl;
+		
+		cout << "Huge pages: [" << (huge_pages ? "on" : "off") << "]" << endl;
+		
+		const char *epoch_logs[] = { "console", "CSV", "JSON", "Chrome trace" };
+		cout << "Epoch log: [" << epoch_logs[epoch_log] << "]" << endl;
 
 		cout << endl << "MENU:: Select one of the following:" << endl
-			 << "[T]est Network. Set [N]etwork. Set Learning-[C]onstants. [I]nitialise Random Seed. [Q]uit" << endl
+			 << "[T]est Network. Set [N]etwork. Set Learning-[C]onstants. [I]nitialise Random Seed. [H]ardware Counters. Hu[G]e Pages. [E]poch Log. [Q]uit" << endl
 			 << ">" << flush;
 		
 		//Read user input
@@ -603,25 +1272,37 @@ int main() {
 				{
 					case 'L'://Test: Single layer network 
 					case 'S':
-					testnet (network_option, weight_option, 4, "Resource/logdata.txt", "AndOrXor", learningParameters); break;
+					testnet (network_option, weight_option, 4, "Resource/logdata.txt", "AndOrXor", learningParameters, epoch_log); break;
 					
 					case 'X'://Test against: XOR
-					testnet (network_option, weight_option, 2, "Resource/xordata.txt", "XOR", learningParameters); break;
+					testnet (network_option, weight_option, 2, "Resource/xordata.txt", "XOR", learningParameters, epoch_log); break;
 					
 					case 'O'://Test against: non-linear problem
-					testnet (network_option, weight_option, 4, "Resource/nonlinsep.txt", "NonLinSep", learningParameters); break;
+					testnet (network_option, weight_option, 4, "Resource/nonlinsep.txt", "NonLinSep", learningParameters, epoch_log); break;
 					
 					case 'C':
-					classtest (learningParameters, hiddenNeurons, max_epoch, weight_option, "Resource/iristrain.txt", "Resource/irisunseen.txt"); break;
+					classtest (learningParameters, hiddenNeurons, max_epoch, weight_option, "Resource/iristrain.txt", "Resource/irisunseen.txt", checkpoint_every, resume == 'Y', count_events, epoch_log); break;
 					
 					case 'U':
-					testnet (network_option, weight_option, 4, "Resource/username.txt", "Username", learningParameters); break;
+					testnet (network_option, weight_option, 4, "Resource/username.txt", "Username", learningParameters, epoch_log); break;
 					
 					case 'M':
-					numtest (learningParameters, hiddenNeurons, max_epoch, usevalid == 'Y', weight_option, "Resource/trainNorm.txt", "Resource/validNorm.txt", "Resource/unseenNorm.txt"); break;
+					numtest (learningParameters, hiddenNeurons, max_epoch, usevalid == 'Y', weight_option, "Resource/trainNorm.txt", "Resource/validNorm.txt", "Resource/unseenNorm.txt", checkpoint_every, resume == 'Y', count_events, epoch_log); break;
+					
+					case 'K'://Test: k-fold cross-validation on the iris set
+					crossvalidate (learningParameters, hiddenNeurons, max_epoch, numFolds, numThreads, weight_option, "Resource/iristrain.txt"); break;
+					
+					case 'P'://Test: orderings of the iris set
+					ordertest (learningParameters, hiddenNeurons, max_epoch, target_SSE, weight_option, "Resource/iristrain.txt"); break;
+					
+					case 'R'://Test: latency of single-row predictions on the iris set
+					predicttest (learningParameters, max_epoch, weight_option, "Resource/iristrain.txt", pool_threads); break;
+					
+					case 'V'://Test: serve a checkpoint of the iris classifier to local clients
+					servetest (checkpoint_file.c_str(), "Resource/iristrain.txt", numThreads, serve_seconds, pool_threads); break;
 					
 					default://Test against: Numerical Problem
-					numtest (learningParameters, hiddenNeurons, max_epoch, usevalid == 'Y', weight_option, "Resource/train.txt", "Resource/valid.txt", "Resource/unseen.txt"); break;
+					numtest (learningParameters, hiddenNeurons, max_epoch, usevalid == 'Y', weight_option, "Resource/train.txt", "Resource/valid.txt", "Resource/unseen.txt", checkpoint_every, resume == 'Y', count_events, epoch_log); break;
 				}
 				
 			}break;
@@ -629,7 +1310,7 @@ int main() {
 			case 'N'://Choice: Set Network
 			{
 				cout << "SELECT NETWORK:" << endl
-					 << "[L]inear. [S]igmoidal. [X]OR. [O]ther non-Separable. [C]lassifier. [N]umerical Probability." << endl
+					 << "[L]inear. [S]igmoidal. [X]OR. [O]ther non-Separable. [C]lassifier. [N]umerical Probability. [K]-fold Cross-validation. [P]resentation Order. Ser[V]e Checkpoint. P[R]ediction Latency." << endl
 					 << ">" << flush;
 					 
 				//Get user input
@@ -661,6 +1342,86 @@ int main() {
 						cin >> max_epoch;		
 						cin.ignore(1);	
 						
+						cout << "ENTER epochs between checkpoints [0 for none]: " << flush;
+						cin >> checkpoint_every;
+						cin.ignore(1);
+						
+						//A run stopped part way may carry on from the checkpoints it wrote
+						resume = 'N';
+						if (checkpoint_every > 0)
+						{
+							cout << "Resume from the latest checkpoint [Y/N]: " << flush;
+							resume = getcapch();
+						}
+						
+					}break;
+					
+					case 'K'://Choice: k-fold Cross-validation
+					{
+						cout << "ENTER number of folds: " << flush;
+						cin >> numFolds;
+						cin.ignore(1);
+						
+						cout << "ENTER number of folds trained at once: " << flush;
+						cin >> numThreads;
+						cin.ignore(1);
+						
+						cout << "ENTER number of nodes in hidden layer: " << flush;
+						cin >> hiddenNeurons;
+						cin.ignore(1);
+						
+						cout << "ENTER number of epochs for learning: " << flush;
+						cin >> max_epoch;
+						cin.ignore(1);
+						
+					}break;
+					
+					case 'P'://Choice: Presentation Order
+					{
+						cout << "ENTER number of nodes in hidden layer: " << flush;
+						cin >> hiddenNeurons;
+						cin.ignore(1);
+						
+						cout << "ENTER max number of epochs for learning: " << flush;
+						cin >> max_epoch;
+						cin.ignore(1);
+						
+						cout << "ENTER target SSE: " << flush;
+						cin >> target_SSE;
+						cin.ignore(1);
+						
+					}break;
+					
+					case 'R'://Choice: Prediction Latency
+					{
+						cout << "ENTER number of epochs for learning: " << flush;
+						cin >> max_epoch;
+						cin.ignore(1);
+						
+						cout << "ENTER threads each prediction is split across: " << flush;
+						cin >> pool_threads;
+						cin.ignore(1);
+						
+					}break;
+					
+					case 'V'://Choice: Serve Checkpoint
+					{
+						cout << "ENTER checkpoint to serve: " << flush;
+						cin >> checkpoint_file;
+						cin.ignore(1);
+						
+						cout << "ENTER number of local clients: " << flush;
+						cin >> numThreads;
+						cin.ignore(1);
+						
+						cout << "ENTER seconds to serve for: " << flush;
+						cin >> serve_seconds;
+						cin.ignore(1);
+						
+						cout << "ENTER threads each batch is split across: " << flush;
+						cin >> pool_threads;
+						cin.ignore(1);
+						
 					}break;
 					
 					default: break;
@@ -670,6 +1431,28 @@ int main() {
 			case 'C'://Choice: Set Learning-Constants
 			setlparas(learningParameters); break;
 			
+			case 'H'://Choice: Count hardware events in classifier and numerical tests
+			count_events = !count_events; break;
+			
+			case 'G'://Choice: Back the arrays of large data sets and networks with huge pages
+			huge_pages = !huge_pages;
+			Arena::SetHugePages (huge_pages); break;
+			
+			case 'E'://Choice: Where epochs of learning are reported
+			{
+				cout << "SELECT EPOCH LOG:" << endl
+					 << "[C]onsole. CS[V] file. [J]SON file. Chrome [T]race file." << endl
+					 << ">" << flush;
+				
+				switch(getcapch())
+				{
+					case 'V': epoch_log = SINK_CSV; break;
+					case 'J': epoch_log = SINK_JSON; break;
+					case 'T': epoch_log = SINK_TRACE; break;
+					default: epoch_log = SINK_CONSOLE; break;
+				}
+			}break;
+			
 			case 'I'://Choice: Initialise Random Seed
 			{			
 				switch(network_option)
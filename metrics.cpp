@@ -0,0 +1,189 @@
+/*
+*	Library Module Implementing the accumulation of SSE and % correct classifications
+*/
+
+#ifndef METRICS_CPP
+#define METRICS_CPP
+
+#include "Header/library.h"
+
+
+///<summary>
+/// Constructor, copies the min/max of the targets so they can be applied to outputs and targets alike
+///</summary>
+MetricsAccumulator::MetricsAccumulator (dataset &data)
+{
+	numOutputs = data.numoutputs;
+	datatype = data.datatype;
+
+	minimum = new double [numOutputs];
+	range = new double [numOutputs];
+	isScaled = new double [numOutputs];
+	sse = new double [numOutputs];
+	correct = new double [numOutputs];
+	meanSSE = new double [numOutputs];
+	percentCorrect = new double [numOutputs];
+
+	for (int ct=0; ct < numOutputs; ct++)
+	{
+		//Outputs have the same min/max as the targets
+		int column = data.numinputs + ct;
+
+		bool scaled = (data.maxdata != 0) && (data.maxdata[column] > data.mindata[column]);
+
+		minimum[ct] = scaled ? data.mindata[column] : 0;
+		range[ct] = scaled ? data.maxdata[column] - data.mindata[column] : 0;
+		isScaled[ct] = scaled ? 1 : 0;
+	}
+
+	Reset();
+}
+
+
+MetricsAccumulator::~MetricsAccumulator ()
+{
+	delete [] minimum;
+	delete [] range;
+	delete [] isScaled;
+	delete [] sse;
+	delete [] correct;
+	delete [] meanSSE;
+	delete [] percentCorrect;
+}
+
+
+void MetricsAccumulator::Reset ()
+{
+	count = 0;
+
+	for (int ct=0; ct < numOutputs; ct++)
+	{
+		sse[ct] = 0;
+		correct[ct] = 0;
+	}
+}
+
+
+///<summary>
+/// Rescales as dataset::RescaleValue: min + (value - 0.1) * (max - min) / 0.8 where min < max, else value.
+/// Both are found and one is chosen by the isScaled mask, so the loop can be vectorised
+///</summary>
+void MetricsAccumulator::Rescale (const double values[], double scaled[])
+{
+	for (int ct=0; ct < numOutputs; ct++)
+	{
+		double rescaled = minimum[ct] + (values[ct] - 0.1) * range[ct] / 0.8;
+		scaled[ct] = isScaled[ct] * rescaled + (1 - isScaled[ct]) * values[ct];
+	}
+}
+
+
+///<summary>
+/// Adds the squared error of each output and whether its rescaled value matches the rescaled target:
+/// logic data compares the side of 0.5, numerical data compares to within 0.001,
+/// and classifier data compares the nearest class. One-hot classes compare the largest output
+/// with the target of 1, so a row is right or wrong as a whole and every output counts it alike
+///</summary>
+void MetricsAccumulator::Accumulate (const double outputs[], const double targets[])
+{
+	for (int ct=0; ct < numOutputs; ct++)
+	{
+		double error = outputs[ct] - targets[ct];
+		sse[ct] += error * error;
+	}
+
+	switch (datatype)
+	{
+		case 0:
+		{
+			for (int ct=0; ct < numOutputs; ct++)
+				correct[ct] += ( (outputs[ct] > 0.5) == (targets[ct] > 0.5) );
+		} break;
+
+		case 2:
+		{
+			double scaledOutputs[numOutputs];
+			double scaledTargets[numOutputs];
+
+			Rescale (outputs, scaledOutputs);
+			Rescale (targets, scaledTargets);
+
+			for (int ct=0; ct < numOutputs; ct++)
+				correct[ct] += ( floor(0.5 + scaledOutputs[ct]) == floor(0.5 + scaledTargets[ct]) );
+		} break;
+
+		case 3:
+		{
+			int best = 0, target = 0;
+			for (int ct=1; ct < numOutputs; ct++)
+			{
+				if (outputs[ct] > outputs[best]) best = ct;
+				if (targets[ct] > targets[target]) target = ct;
+			}
+
+			for (int ct=0; ct < numOutputs; ct++) correct[ct] += (best == target);
+		} break;
+
+		default:
+		{
+			double scaledOutputs[numOutputs];
+			double scaledTargets[numOutputs];
+
+			Rescale (outputs, scaledOutputs);
+			Rescale (targets, scaledTargets);
+
+			for (int ct=0; ct < numOutputs; ct++)
+				correct[ct] += ( fabs(scaledOutputs[ct] - scaledTargets[ct]) < 0.001 );
+		} break;
+	}
+
+	count++;
+}
+
+
+int MetricsAccumulator::Count ()
+{
+	return count;
+}
+
+
+double * MetricsAccumulator::CalcSSE ()
+{
+	for (int ct=0; ct < numOutputs; ct++)
+		meanSSE[ct] = (count > 0) ? sse[ct] / count : 0;
+
+	return &meanSSE[0];
+}
+
+
+double MetricsAccumulator::TotalSSE ()
+{
+	double ans = 0;
+
+	CalcSSE();
+	for (int ct=0; ct < numOutputs; ct++) ans += meanSSE[ct];
+
+	return ans;
+}
+
+
+double * MetricsAccumulator::CalcCorrectClassifications ()
+{
+	for (int ct=0; ct < numOutputs; ct++)
+		percentCorrect[ct] = (count > 0) ? 100 * correct[ct] / count : 0;
+
+	return &percentCorrect[0];
+}
+
+
+void MetricsAccumulator::printarray (const char *s, char which, int nl)
+{
+	switch (which) {
+	case 's' :
+	case 'S' : arrout(s, numOutputs, CalcSSE(), nl); break;
+	case 'c' :
+	case 'C' : arrout(s, (datatype == 3) ? 1 : numOutputs, CalcCorrectClassifications(), nl); break;
+	}
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+*	Library Module Implementing the per-epoch ordering of rows in a dataset
+*/
+
+#ifndef ORDER_CPP
+#define ORDER_CPP
+
+#include "Header/library.h"
+
+
+///<summary>
+/// Constructor, works out the size of a block and starts with rows in file order
+///</summary>
+SampleOrder::SampleOrder (int rows, OrderStrategy theStrategy, unsigned long long theSeed, int rowBytes, int blockBytes)
+{
+	numRows = rows;
+	strategy = theStrategy;
+
+	//As many rows as fit in one block, but at least one
+	blockRows = (rowBytes > 0) ? blockBytes / rowBytes : 1;
+	if (blockRows < 1) blockRows = 1;
+	if (blockRows > numRows) blockRows = (numRows > 0) ? numRows : 1;
+
+	order = new int [numRows > 0 ? numRows : 1];
+	blockOrder = new int [(numRows + blockRows - 1) / blockRows + 1];
+
+	for (int i=0; i < numRows; i++) order[i] = i;
+
+	seed = DeriveSeed (theSeed, STREAM_ORDER);
+	epoch = 0;
+}
+
+
+SampleOrder::~SampleOrder ()
+{
+	delete [] order;
+	delete [] blockOrder;
+}
+
+
+int SampleOrder::RandomBelow (int n)
+{
+	return random.Below (n);
+}
+
+
+void SampleOrder::Shuffle (int values[], int num)
+{
+	for (int i = num - 1; i > 0; i--)
+	{
+		int j = RandomBelow (i + 1);
+		int temp = values[i];
+		values[i] = values[j];
+		values[j] = temp;
+	}
+}
+
+
+///<summary>
+/// Reorders the rows as set by the strategy:
+/// ORDER_FILE leaves them in file order, ORDER_SHUFFLE shuffles all of them,
+/// ORDER_BLOCK_SHUFFLE shuffles the blocks then the rows within each block, so rows
+/// that are near in memory are still presented close together
+///</summary>
+const int * SampleOrder::NextEpoch ()
+{
+	random.Seed (seed, epoch++);
+
+	switch (strategy)
+	{
+		case ORDER_SHUFFLE:
+		{
+			//Start from file order, so each epoch's order depends only on the seed and the epoch
+			for (int i=0; i < numRows; i++) order[i] = i;
+			Shuffle (order, numRows);
+		} break;
+
+		case ORDER_BLOCK_SHUFFLE:
+		{
+			int numBlocks = (numRows + blockRows - 1) / blockRows;
+
+			for (int b=0; b < numBlocks; b++) blockOrder[b] = b;
+			Shuffle (blockOrder, numBlocks);
+
+			int ndi = 0;
+			for (int b=0; b < numBlocks; b++)
+			{
+				int first = blockOrder[b] * blockRows;
+				int last = first + blockRows;
+				if (last > numRows) last = numRows;
+
+				//Copy the block's rows, then shuffle them in place
+				for (int i=first; i < last; i++) order[ndi + i - first] = i;
+				Shuffle (&order[ndi], last - first);
+
+				ndi += last - first;
+			}
+		} break;
+
+		default: break;
+	}
+
+	return order;
+}
+
+
+int SampleOrder::BlockRows ()
+{
+	return blockRows;
+}
+
+
+const char * SampleOrder::Name ()
+{
+	switch (strategy)
+	{
+		case ORDER_SHUFFLE: return "Shuffle";
+		case ORDER_BLOCK_SHUFFLE: return "BlockShuffle";
+		default: return "FileOrder";
+	}
+}
+
+
+unsigned long long SampleOrder::GetState ()
+{
+	return epoch;
+}
+
+
+void SampleOrder::SetState (unsigned long long newState)
+{
+	epoch = newState;
+}
+
+#endif
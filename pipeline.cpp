@@ -0,0 +1,417 @@
+/*
+*	Library Module Implementing layer-pipelined inference across cores
+*/
+
+#ifndef PIPELINE_CPP
+#define PIPELINE_CPP
+
+#include "Header/library.h"
+
+
+// Implementation of SpscQueue *****************************
+
+template <class T> SpscQueue<T>::SpscQueue (int capacity)
+{
+	size_t size = 1;
+	while (size < (size_t) max (capacity, 1)) size *= 2;
+
+	items.resize (size);
+	mask = size - 1;
+	head = 0;
+	tail = 0;
+}
+
+
+///<summary>
+/// The item is stored before tail is raised, which publishes it to the consumer
+///</summary>
+template <class T> bool SpscQueue<T>::TryPush (const T &item)
+{
+	size_t at = tail.load (memory_order_relaxed);
+
+	if (at - head.load (memory_order_acquire) > mask) return false;
+
+	items[at & mask] = item;
+	tail.store (at + 1, memory_order_release);
+
+	return true;
+}
+
+
+///<summary>
+/// The item is copied before head is raised, which frees its place to the producer
+///</summary>
+template <class T> bool SpscQueue<T>::TryPop (T &item)
+{
+	size_t at = head.load (memory_order_relaxed);
+
+	if (at == tail.load (memory_order_acquire)) return false;
+
+	item = items[at & mask];
+	head.store (at + 1, memory_order_release);
+
+	return true;
+}
+
+
+static double SecondsSince (chrono::steady_clock::time_point start)
+{
+	return chrono::duration<double> (chrono::steady_clock::now() - start).count();
+}
+
+
+// Implementation of LayerPipeline *****************************
+
+///<summary>
+/// Pauses between tries, yielding the core every POOL_SPINS of them, then parks. A waiter raises parked before
+/// it tries again under the lock, and Notify follows each change with a fence before it reads parked, so either
+/// the waiter sees the change or Notify sees the waiter and wakes it under the lock the waiter waits with
+///</summary>
+template <class Ready> void LayerPipeline::WaitFor (Ready ready)
+{
+	for (int spins=1; !ready(); spins++)
+	{
+		if (spins >= POOL_PARK_SPINS)
+		{
+			unique_lock<mutex> lock (parking);
+			parked.fetch_add (1);
+			atomic_thread_fence (memory_order_seq_cst);
+
+			wake.wait (lock, ready);
+
+			parked.fetch_sub (1);
+			return;
+		}
+
+		SpinPause();
+		if (spins % POOL_SPINS == 0) this_thread::yield();
+	}
+}
+
+
+void LayerPipeline::Notify ()
+{
+	atomic_thread_fence (memory_order_seq_cst);
+
+	if (parked.load() > 0)
+	{
+		lock_guard<mutex> lock (parking);
+		wake.notify_all();
+	}
+}
+
+
+template <class T> void LayerPipeline::Push (SpscQueue<T> &queue, const T &item)
+{
+	WaitFor ([&] () { return queue.TryPush (item); });
+	Notify();
+}
+
+
+template <class T> void LayerPipeline::Pop (SpscQueue<T> &queue, T &item)
+{
+	WaitFor ([&] () { return queue.TryPop (item); });
+	Notify();
+}
+
+
+///<summary>
+/// Each stage takes layers until it holds its share of the weights, taking the next layer only if that brings
+/// it nearer its share, and leaving at least one layer for each stage after it.
+/// Every buffer of each stage starts free, and is passed round from then on
+///</summary>
+LayerPipeline::LayerPipeline (LinearLayerNetwork *network, int numStages, int rowsInBatch, int firstCore)
+	: submittedBatches (0), parked (0), busy (false)
+{
+	net = network;
+	microRows = max (1, rowsInBatch);
+	numRows = 0;
+	seconds = 0;
+
+	int numLayers = net->HowManyLayers();
+	numStages = max (1, min (numStages, numLayers));
+
+	vector<int> layerInputs (numLayers), layerNeurons (numLayers);
+	vector<long long> layerWeights (numLayers);
+	long long total = 0;
+
+	for (int l=0; l < numLayers; l++)
+	{
+		char layerType;
+		net->DescribeLayer (l, layerInputs[l], layerNeurons[l], layerType);
+
+		layerWeights[l] = (long long) (layerInputs[l] + 1) * layerNeurons[l];
+		total += layerWeights[l];
+	}
+
+	int cores = thread::hardware_concurrency() > 0 ? thread::hardware_concurrency() : 1;
+	int layer = 0;
+	long long done = 0;
+
+	for (int s=0; s < numStages; s++)
+	{
+		PipelineStage stage;
+
+		stage.firstLayer = layer;
+		stage.weights = 0;
+		stage.widest = 0;
+
+		double share = (double) total * (s + 1) / numStages;
+
+		do
+		{
+			stage.weights += layerWeights[layer];
+			done += layerWeights[layer];
+			if (layer > stage.firstLayer) stage.widest = max (stage.widest, layerInputs[layer]);
+			layer++;
+		}
+		while (layer < numLayers - (numStages - 1 - s) && done + layerWeights[layer] / 2.0 <= share);
+
+		stage.numLayers = layer - stage.firstLayer;
+		stage.numInputs = layerInputs[stage.firstLayer];
+		stage.numOutputs = layerNeurons[layer - 1];
+		stage.core = (firstCore + s) % cores;
+		stage.pinned = false;
+
+		if (s + 1 < numStages) stage.buffers.resize ((size_t) PIPELINE_BUFFERS * microRows * stage.numOutputs);
+		stage.hidden.resize ((size_t) 2 * microRows * stage.widest);
+
+		stages.push_back (stage);
+
+		inbound.push_back (new SpscQueue<PipelineBatch> (PIPELINE_BUFFERS));
+
+		if (s + 1 < numStages)
+		{
+			freed.push_back (new SpscQueue<int> (PIPELINE_BUFFERS));
+			for (int b=0; b < PIPELINE_BUFFERS; b++) freed.back()->TryPush (b);
+		}
+	}
+
+	ResetCounters();
+
+	settled = new atomic<long long>[numStages];
+	for (int s=0; s < numStages; s++) settled[s] = 0;
+
+	for (int s=0; s < numStages; s++) workers.push_back (thread (&LayerPipeline::StageLoop, this, s));
+}
+
+
+///<summary>
+/// A micro-batch of no rows is passed from each stage to the next as it ends
+///</summary>
+LayerPipeline::~LayerPipeline ()
+{
+	PipelineBatch end = { 0, 0, 0, -1, chrono::steady_clock::now() };
+	Push (*inbound[0], end);
+
+	for (size_t s=0; s < workers.size(); s++) workers[s].join();
+
+	delete [] settled;
+	for (size_t s=0; s < inbound.size(); s++) delete inbound[s];
+	for (size_t s=0; s < freed.size(); s++) delete freed[s];
+}
+
+
+bool LayerPipeline::PinToCore (int core)
+{
+#ifdef __linux__
+	cpu_set_t cores;
+	CPU_ZERO (&cores);
+	CPU_SET (core, &cores);
+
+	return pthread_setaffinity_np (pthread_self(), sizeof(cores), &cores) == 0;
+#else
+	return false;
+#endif
+}
+
+
+///<summary>
+/// The calling thread cuts the rows into micro-batches for the first stage. The clock of the pipeline runs
+/// from when it is given rows while empty until Wait finds it empty again
+///</summary>
+long long LayerPipeline::Submit (const double inputs[], int rows, double outputs[])
+{
+	int numInputs = net->HowManyInputs(), numOutputs = net->HowManyOutputs();
+
+	if (!busy)
+	{
+		busy = true;
+		busySince = chrono::steady_clock::now();
+	}
+
+	for (int first=0; first < rows; first += microRows)
+	{
+		PipelineBatch batch = { &inputs[(size_t) first * numInputs], &outputs[(size_t) first * numOutputs],
+								min (microRows, rows - first), -1, chrono::steady_clock::now() };
+		Push (*inbound[0], batch);
+
+		submittedBatches++;
+	}
+
+	numRows += rows;
+
+	return submittedBatches;
+}
+
+
+///<summary>
+/// A stage counts a micro-batch settled once it has finished with it and its counters, so once every stage has
+/// settled the ticket's micro-batches, the outputs and the counters may all be read
+///</summary>
+void LayerPipeline::Wait (long long ticket)
+{
+	WaitFor ([&] () {
+		for (size_t s=0; s < stages.size(); s++)
+			if (settled[s].load (memory_order_acquire) < ticket) return false;
+		return true;
+	});
+
+	if (busy && ticket == submittedBatches)
+	{
+		busy = false;
+		seconds += SecondsSince (busySince);
+	}
+}
+
+
+void LayerPipeline::Run (const double inputs[], int rows, double outputs[])
+{
+	Wait (Submit (inputs, rows, outputs));
+}
+
+
+void LayerPipeline::StageLoop (int s)
+{
+	PipelineStage &stage = stages[s];
+	bool last = (s + 1 == (int) stages.size());
+
+	stage.pinned = PinToCore (stage.core);
+
+	for (;;)
+	{
+		PipelineBatch batch;
+
+		chrono::steady_clock::time_point waited = chrono::steady_clock::now();
+		Pop (*inbound[s], batch);
+
+		if (batch.rows == 0)
+		{
+			if (!last) Push (*inbound[s + 1], batch);
+			return;
+		}
+
+		//Only the wait after the rows were given counts as starved: before then the pipeline was idle
+		stage.starvedSeconds += SecondsSince (max (waited, batch.submitted));
+
+		//Inputs: the caller's rows for the first stage, else a buffer of the stage before
+		const double *layerInputs = (s == 0) ? batch.inputs : &stages[s - 1].buffers[(size_t) batch.buffer * microRows * stage.numInputs];
+
+		//Outputs: the caller's rows for the last stage, else a buffer of this one once the stage after frees one
+		int buffer = -1;
+		double *stageOutputs;
+
+		if (last) stageOutputs = batch.outputs;
+		else
+		{
+			waited = chrono::steady_clock::now();
+			Pop (*freed[s], buffer);
+			stage.blockedSeconds += SecondsSince (waited);
+
+			stageOutputs = &stage.buffers[(size_t) buffer * microRows * stage.numOutputs];
+		}
+
+		chrono::steady_clock::time_point busy = chrono::steady_clock::now();
+
+		for (int l=0; l < stage.numLayers; l++)
+		{
+			double *layerOutputs = (l == stage.numLayers - 1) ? stageOutputs : &stage.hidden[(size_t) (l % 2) * microRows * stage.widest];
+
+			net->ForwardLayerBatch (stage.firstLayer + l, layerInputs, batch.rows, layerOutputs);
+
+			layerInputs = layerOutputs;
+		}
+
+		stage.busySeconds += SecondsSince (busy);
+		stage.batches++;
+
+		//The stage before may fill its buffer again
+		if (s > 0) Push (*freed[s - 1], batch.buffer);
+
+		if (!last)
+		{
+			PipelineBatch next = batch;
+			next.buffer = buffer;
+
+			waited = chrono::steady_clock::now();
+			Push (*inbound[s + 1], next);
+			stage.blockedSeconds += SecondsSince (waited);
+		}
+
+		settled[s].fetch_add (1, memory_order_release);
+		Notify();
+	}
+}
+
+
+int LayerPipeline::HowManyStages ()
+{
+	return (int) stages.size();
+}
+
+
+const PipelineStage & LayerPipeline::Stage (int stage)
+{
+	return stages[stage];
+}
+
+
+double LayerPipeline::RunSeconds ()
+{
+	return seconds;
+}
+
+
+double LayerPipeline::Occupancy (int stage)
+{
+	return (seconds > 0) ? stages[stage].busySeconds / seconds : 0;
+}
+
+
+void LayerPipeline::ResetCounters ()
+{
+	for (size_t s=0; s < stages.size(); s++)
+	{
+		stages[s].batches = 0;
+		stages[s].busySeconds = 0;
+		stages[s].starvedSeconds = 0;
+		stages[s].blockedSeconds = 0;
+	}
+
+	numRows = 0;
+	seconds = 0;
+}
+
+
+///<summary>
+/// Shares are of the time of every Run; a stage busy far more than the others is the one to split.
+/// A core marked ? is the one the stage was meant for, but its thread could not be pinned there
+///</summary>
+void LayerPipeline::Print ()
+{
+	printf ("Pipeline: stages [%d] rows [%lld] seconds [%.3f] rows/sec [%.0f]\n",
+			HowManyStages(), numRows, seconds, (seconds > 0) ? numRows / seconds : 0.0);
+
+	printf ("\tStage\tLayers\tWeights\t\tCore\tBatches\t%%Busy\t%%Starved\t%%Blocked\n");
+
+	for (int s=0; s < HowManyStages(); s++)
+	{
+		PipelineStage &stage = stages[s];
+		double share = (seconds > 0) ? 100 / seconds : 0;
+
+		printf ("\t%d\t%d-%d\t%-12lld\t%d%s\t%lld\t%.1f\t%.1f\t\t%.1f\n", s, stage.firstLayer, stage.firstLayer + stage.numLayers - 1,
+				stage.weights, stage.core, stage.pinned ? "" : "?", stage.batches, stage.busySeconds * share, stage.starvedSeconds * share, stage.blockedSeconds * share);
+	}
+}
+
+#endif
@@ -0,0 +1,128 @@
+/*
+*	Library Module Implementing a pool of spinning threads for splitting wide layers
+*/
+
+#ifndef POOL_CPP
+#define POOL_CPP
+
+#include "Header/library.h"
+
+
+void SpinPause ()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#endif
+}
+
+
+// Implementation of SpinPool *****************************
+
+SpinPool::SpinPool (int numThreads)
+	: numParts (max (1, numThreads)), task (0), context (0), generation (0), remaining (0), running (true), parked (0)
+{
+	for (int part=1; part < numParts; part++) workers.push_back (thread (&SpinPool::WorkerLoop, this, part));
+}
+
+
+SpinPool::~SpinPool ()
+{
+	running.store (false, memory_order_release);
+
+	{
+		lock_guard<mutex> lock (parking);
+		wake.notify_all();
+	}
+
+	for (size_t t=0; t < workers.size(); t++) workers[t].join();
+}
+
+
+///<summary>
+/// A worker raises parked before it checks generation, and Run raises generation before it checks parked, both
+/// sequentially consistent, so either the worker sees the task or Run sees the worker parked and wakes it.
+/// The check and the wait are under the mutex Run notifies under, so no wake falls between them
+///</summary>
+void SpinPool::WorkerLoop (int part)
+{
+	long long seen = 0;
+
+	for (;;)
+	{
+		long long next;
+
+		for (int spins=1; (next = generation.load (memory_order_acquire)) == seen; spins++)
+		{
+			if (!running.load (memory_order_acquire)) return;
+
+			if (spins >= POOL_PARK_SPINS)
+			{
+				unique_lock<mutex> lock (parking);
+				parked.fetch_add (1);
+
+				wake.wait (lock, [&] () { return generation.load() != seen || !running.load(); });
+
+				parked.fetch_sub (1);
+				spins = 0;
+				continue;
+			}
+
+			SpinPause();
+			if (spins % POOL_SPINS == 0) this_thread::yield();
+		}
+
+		seen = next;
+
+		task (context, part, numParts);
+
+		remaining.fetch_sub (1, memory_order_release);
+	}
+}
+
+
+///<summary>
+/// The task and the count of parts are written before generation is raised, which publishes them to the workers;
+/// the count falling to 0 publishes the workers' results back to the caller
+///</summary>
+void SpinPool::Run (PoolTask theTask, void *theContext)
+{
+	if (numParts == 1)
+	{
+		theTask (theContext, 0, 1);
+		return;
+	}
+
+	task = theTask;
+	context = theContext;
+	remaining.store (numParts - 1, memory_order_relaxed);
+	generation.fetch_add (1);
+
+	if (parked.load() > 0)
+	{
+		lock_guard<mutex> lock (parking);
+		wake.notify_all();
+	}
+
+	task (context, 0, numParts);
+
+	for (int spins=1; remaining.load (memory_order_acquire) != 0; spins++)
+	{
+		SpinPause();
+		if (spins % POOL_SPINS == 0) this_thread::yield();
+	}
+}
+
+
+int SpinPool::HowManyParts ()
+{
+	return numParts;
+}
+
+
+void SpinPool::Split (int count, int part, int numParts, int &begin, int &end)
+{
+	begin = (int) ((long long) count * part / numParts);
+	end = (int) ((long long) count * (part + 1) / numParts);
+}
+
+#endif
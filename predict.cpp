@@ -0,0 +1,216 @@
+/*
+*	Library Module Implementing single-row prediction with the data scaling folded into the weights
+*/
+
+#ifndef PREDICT_CPP
+#define PREDICT_CPP
+
+#include "Header/library.h"
+
+
+///<summary>
+/// Scaled input = a * raw + b, so each weight w on it becomes w * a and the bias gains w * b.
+/// Raw output = c * output + d, so a linear last layer has every weight times c and d added to the bias
+///</summary>
+Predictor::Predictor (LinearLayerNetwork *net, const DataScaling &scaling)
+	: pool (0)
+{
+	Checkpoint::Describe (net, layers);
+
+	weights.resize (net->HowManyWeights());
+	net->ReturnTheWeights (&weights[0]);
+
+	int widest = 0;
+	for (size_t l=0, start=0; l < layers.size(); l++)
+	{
+		layerStart.push_back ((int) start);
+		start += (layers[l].numInputs + 1) * layers[l].numNeurons;
+		widest = max (widest, layers[l].numNeurons);
+	}
+
+	hidden[0].resize (widest);
+	hidden[1].resize (widest);
+
+	datatype = scaling.datatype;
+	hasScaling = !scaling.mindata.empty();
+
+	int numIns = HowManyInputs();
+	int numOuts = HowManyOutputs();
+
+	//Input scaling, folded into the first layer
+	if (hasScaling)
+	{
+		CheckpointLayer &first = layers[0];
+
+		for (int neuron=0; neuron < first.numNeurons; neuron++)
+		{
+			double *neuronWeights = &weights[neuron * (numIns + 1)];
+
+			for (int ct=0; ct < numIns; ct++)
+			{
+				double range = scaling.maxdata[ct] - scaling.mindata[ct];
+				if (range <= 0) continue;
+
+				double a = 0.8 / range;
+				double b = 0.1 - 0.8 * scaling.mindata[ct] / range;
+
+				neuronWeights[0] += neuronWeights[ct + 1] * b;
+				neuronWeights[ct + 1] *= a;
+			}
+		}
+	}
+
+	//Output rescaling: logic outputs are only thresholded, so they keep c = 1, d = 0
+	outputScale.assign (numOuts, 1.0);
+	outputOffset.assign (numOuts, 0.0);
+
+	if (hasScaling && datatype != 0)
+	{
+		for (int ct=0; ct < numOuts; ct++)
+		{
+			int column = numIns + ct;
+			double range = scaling.maxdata[column] - scaling.mindata[column];
+
+			if (range > 0)
+			{
+				outputScale[ct] = range / 0.8;
+				outputOffset[ct] = scaling.mindata[column] - 0.1 * outputScale[ct];
+			}
+		}
+	}
+
+	CheckpointLayer &last = layers.back();
+	foldedOutputs = (last.layerType == 'L');
+
+	if (foldedOutputs)
+	{
+		for (int neuron=0; neuron < last.numNeurons; neuron++)
+		{
+			double *neuronWeights = &weights[layerStart.back() + neuron * (last.numInputs + 1)];
+
+			for (int ct=0; ct < last.numInputs + 1; ct++)
+				neuronWeights[ct] *= outputScale[neuron];
+
+			neuronWeights[0] += outputOffset[neuron];
+		}
+	}
+}
+
+
+///<summary>
+/// Layer of a Predictor and the row being predicted, shared by the parts of a task of the pool
+///</summary>
+struct PredictLayerTask {
+
+	const CheckpointLayer *layer;
+	const double *weights;
+	const double *inputs;
+	double *outputs;
+};
+
+
+///<summary>
+/// Sums and activates one part of the neurons of a layer, as CalcOutputs does; the pool calls it
+/// for each part, and Predict for the whole layer when it is not split
+///</summary>
+static void PredictNeurons (void *context, int part, int numParts)
+{
+	PredictLayerTask &task = *(PredictLayerTask *) context;
+	const CheckpointLayer &layer = *task.layer;
+
+	int first, last;
+	SpinPool::Split (layer.numNeurons, part, numParts, first, last);
+
+	const double *layerWeights = &task.weights[first * (layer.numInputs + 1)];
+
+	for (int neuron = first; neuron < last; neuron++)
+	{
+		double sum = *layerWeights++;
+
+		for (int ct=0; ct < layer.numInputs; ct++)
+			sum += task.inputs[ct] * *layerWeights++;
+
+		//Activation of the layer, as in LayerType()
+		task.outputs[neuron] = ActivateSum ((char) layer.layerType, sum);
+	}
+}
+
+
+///<summary>
+/// Each layer sums its inputs as CalcOutputs does, from the raw inputs for the first layer and from the previous
+/// layer's buffer after; the last layer writes straight into rawOutputs
+///</summary>
+void Predictor::Predict (const double rawInputs[], double rawOutputs[])
+{
+	const double *layerInputs = rawInputs;
+	int numLayers = (int) layers.size();
+
+	for (int l=0; l < numLayers; l++)
+	{
+		const CheckpointLayer &layer = layers[l];
+
+		double *layerOutputs = (l == numLayers - 1) ? rawOutputs : &hidden[l % 2][0];
+
+		PredictLayerTask task = { &layer, &weights[layerStart[l]], layerInputs, layerOutputs };
+
+		if (pool != 0 && pool->HowManyParts() > 1 && (layer.numInputs + 1) * layer.numNeurons >= POOL_MIN_WEIGHTS)
+			pool->Run (PredictNeurons, &task);
+		else
+			PredictNeurons (&task, 0, 1);
+
+		if (layer.layerType == 'C') Softmax (layerOutputs, layer.numNeurons);
+
+		layerInputs = layerOutputs;
+	}
+
+	if (!hasScaling) return;
+
+	int numOuts = HowManyOutputs();
+
+	for (int ct=0; ct < numOuts; ct++)
+	{
+		double value = rawOutputs[ct];
+
+		if (!foldedOutputs) value = outputScale[ct] * value + outputOffset[ct];
+
+		if (datatype == 0) value = (value <= 0.5) ? 0 : 1;
+		else if (datatype == 2) value = floor(0.5 + value);
+
+		rawOutputs[ct] = value;
+	}
+}
+
+
+void Predictor::SetPool (SpinPool *thePool)
+{
+	pool = thePool;
+}
+
+
+int Predictor::HowManyInputs ()
+{
+	return layers[0].numInputs;
+}
+
+
+int Predictor::HowManyOutputs ()
+{
+	return layers.back().numNeurons;
+}
+
+
+///<summary>
+/// Finds the sample of the given rank with nth_element, so no full sort is needed
+///</summary>
+double Percentile (vector<double> &samples, double fraction)
+{
+	if (samples.empty()) return 0;
+
+	size_t rank = min (samples.size() - 1, (size_t) (samples.size() * fraction));
+
+	nth_element (samples.begin(), samples.begin() + rank, samples.end());
+
+	return samples[rank];
+}
+
+#endif
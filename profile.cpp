@@ -0,0 +1,178 @@
+/*
+*	Library Module Implementing the per-layer timing of training and testing
+*/
+
+#ifndef PROFILE_CPP
+#define PROFILE_CPP
+
+#include "Header/library.h"
+
+
+//Names of the phases, as printed and as keys of the JSON
+const char *PROFILE_PHASE_NAMES[PROFILE_PHASES] = { "forward", "store", "errors", "deltas", "weights" };
+
+
+vector<ProfileThread *> PhaseProfile::running;
+ProfileCounters PhaseProfile::ended;
+mutex PhaseProfile::lock;
+
+
+// Implementation of ProfileThread *****************************
+
+ProfileThread::ProfileThread ()
+{
+	memset (&counters, 0, sizeof(counters));
+
+	lock_guard<mutex> guard (PhaseProfile::lock);
+	PhaseProfile::running.push_back (this);
+}
+
+
+ProfileThread::~ProfileThread ()
+{
+	lock_guard<mutex> guard (PhaseProfile::lock);
+
+	PhaseProfile::Add (PhaseProfile::ended, counters);
+	PhaseProfile::running.erase (find (PhaseProfile::running.begin(), PhaseProfile::running.end(), this));
+}
+
+
+// Implementation of PhaseProfile *****************************
+
+///<summary>
+/// Each thread makes its counters the first time it times anything
+///</summary>
+ProfileCounters & PhaseProfile::ThreadCounters ()
+{
+	static thread_local ProfileThread counters;
+
+	return counters.counters;
+}
+
+
+bool PhaseProfile::Enabled ()
+{
+#ifdef ANN_PROFILE
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+void PhaseProfile::Add (ProfileCounters &to, const ProfileCounters &from)
+{
+	for (int layer=0; layer < PROFILE_MAX_LAYERS; layer++)
+	{
+		for (int phase=0; phase < PROFILE_PHASES; phase++)
+		{
+			to.phases[layer][phase].calls += from.phases[layer][phase].calls;
+			to.phases[layer][phase].seconds += from.phases[layer][phase].seconds;
+			to.phases[layer][phase].flops += from.phases[layer][phase].flops;
+			to.phases[layer][phase].specialized += from.phases[layer][phase].specialized;
+		}
+	}
+
+	to.passes += from.passes;
+	to.samples += from.samples;
+	to.passSeconds += from.passSeconds;
+}
+
+
+void PhaseProfile::Reset ()
+{
+	lock_guard<mutex> guard (lock);
+
+	memset (&ended, 0, sizeof(ended));
+
+	for (size_t t=0; t < running.size(); t++) memset (&running[t]->counters, 0, sizeof(ProfileCounters));
+}
+
+
+ProfileCounters PhaseProfile::Totals ()
+{
+	lock_guard<mutex> guard (lock);
+
+	ProfileCounters totals = ended;
+
+	for (size_t t=0; t < running.size(); t++) Add (totals, running[t]->counters);
+
+	return totals;
+}
+
+
+double PhaseProfile::SamplesPerSecond (const ProfileCounters &counters)
+{
+	return (counters.passSeconds > 0) ? counters.samples / counters.passSeconds : 0;
+}
+
+
+double PhaseProfile::GigaFlops (const PhaseTotals &totals)
+{
+	return (totals.seconds > 0) ? totals.flops / totals.seconds / 1e9 : 0;
+}
+
+
+///<summary>
+/// Layers no phase was called for are left out; the share is of the time of all passes
+///</summary>
+void PhaseProfile::Print ()
+{
+	ProfileCounters totals = Totals();
+
+	printf ("Profile: passes [%lld] samples [%lld] seconds [%.3f] samples/sec [%.0f]\n",
+			totals.passes, totals.samples, totals.passSeconds, SamplesPerSecond (totals));
+
+	printf ("\tLayer\tPhase\t\tCalls\t\tms\t%%Pass\tGFLOP/s\tSpecialized\n");
+
+	for (int layer=0; layer < PROFILE_MAX_LAYERS; layer++)
+	{
+		for (int phase=0; phase < PROFILE_PHASES; phase++)
+		{
+			PhaseTotals &p = totals.phases[layer][phase];
+			if (p.calls == 0) continue;
+
+			printf ("\t%d\t%-8s\t%-12lld\t%.2f\t%.1f\t%.3f\t%lld\n", layer, PROFILE_PHASE_NAMES[phase], p.calls, p.seconds * 1e3,
+					(totals.passSeconds > 0) ? 100 * p.seconds / totals.passSeconds : 0.0, GigaFlops (p), p.specialized);
+		}
+	}
+}
+
+
+///<summary>
+/// {"enabled", "passes", "samples", "seconds", "samples_per_second", "layers":[{"layer", "forward":{...}, ...}]},
+/// each phase holding its calls, seconds, flops and gflops, and the calls run by kernels of the layer's size
+///</summary>
+void PhaseProfile::WriteJson (FILE *out)
+{
+	ProfileCounters totals = Totals();
+
+	fprintf (out, "{\"enabled\":%s,\"passes\":%lld,\"samples\":%lld,\"seconds\":%.10g,\"samples_per_second\":%.10g,\"layers\":[",
+			Enabled() ? "true" : "false", totals.passes, totals.samples, totals.passSeconds, SamplesPerSecond (totals));
+
+	bool first = true;
+
+	for (int layer=0; layer < PROFILE_MAX_LAYERS; layer++)
+	{
+		long long calls = 0;
+		for (int phase=0; phase < PROFILE_PHASES; phase++) calls += totals.phases[layer][phase].calls;
+		if (calls == 0) continue;
+
+		fprintf (out, "%s{\"layer\":%d", first ? "" : ",", layer);
+		first = false;
+
+		for (int phase=0; phase < PROFILE_PHASES; phase++)
+		{
+			PhaseTotals &p = totals.phases[layer][phase];
+
+			fprintf (out, ",\"%s\":{\"calls\":%lld,\"seconds\":%.10g,\"flops\":%.10g,\"gflops\":%.10g,\"specialized\":%lld}",
+					PROFILE_PHASE_NAMES[phase], p.calls, p.seconds, p.flops, GigaFlops (p), p.specialized);
+		}
+
+		fprintf (out, "}");
+	}
+
+	fprintf (out, "]}");
+}
+
+#endif
@@ -0,0 +1,343 @@
+/*
+*	Library Module Implementing magnitude pruning and networks of sparse weights
+*/
+
+#ifndef PRUNE_CPP
+#define PRUNE_CPP
+
+#include "Header/library.h"
+
+
+// Implementation of WeightPruner *****************************
+
+WeightPruner::WeightPruner (LinearLayerNetwork *net)
+{
+	Checkpoint::Describe (net, layers);
+
+	for (size_t l=0, start=0; l < layers.size(); l++)
+	{
+		layerStart.push_back ((int) start);
+		start += (layers[l].numInputs + 1) * layers[l].numNeurons;
+	}
+
+	keep.assign (net->HowManyWeights(), 1);
+	weights.resize (net->HowManyWeights());
+	deltaWeights.resize (net->HowManyWeights());
+}
+
+
+bool WeightPruner::IsBias (int layer, int index)
+{
+	return (index - layerStart[layer]) % (layers[layer].numInputs + 1) == 0;
+}
+
+
+///<summary>
+/// nth_element puts the count smallest magnitudes first, in no order, without sorting the rest
+///</summary>
+void WeightPruner::PruneSmallest (vector<int> &candidates, int count)
+{
+	count = max (0, min (count, (int) candidates.size()));
+	if (count == 0) return;
+
+	nth_element (candidates.begin(), candidates.begin() + (count - 1), candidates.end(),
+				 [&] (int a, int b) { return fabs (weights[a]) < fabs (weights[b]); });
+
+	for (int ct=0; ct < count; ct++) keep[candidates[ct]] = 0;
+}
+
+
+int WeightPruner::PruneRatio (LinearLayerNetwork *net, double ratio, PruneScope scope)
+{
+	Reapply (net);
+
+	ratio = max (0.0, min (1.0, ratio));
+	vector<int> candidates;
+
+	for (int l=0; l < (int) layers.size(); l++)
+	{
+		for (int index = layerStart[l]; index < layerStart[l] + (layers[l].numInputs + 1) * layers[l].numNeurons; index++)
+			if (!IsBias (l, index)) candidates.push_back (index);
+
+		if (scope == PRUNE_PER_LAYER)
+		{
+			PruneSmallest (candidates, (int) (ratio * candidates.size() + 0.5));
+			candidates.clear();
+		}
+	}
+
+	if (scope == PRUNE_GLOBAL) PruneSmallest (candidates, (int) (ratio * candidates.size() + 0.5));
+
+	Reapply (net);
+
+	return HowManyPrunable() - HowManyKept();
+}
+
+
+int WeightPruner::PruneThreshold (LinearLayerNetwork *net, double threshold, PruneScope scope)
+{
+	Reapply (net);
+
+	for (int l=0; l < (int) layers.size(); l++)
+	{
+		int end = layerStart[l] + (layers[l].numInputs + 1) * layers[l].numNeurons;
+		double cut = threshold;
+
+		if (scope == PRUNE_PER_LAYER)
+		{
+			double total = 0;
+			int kept = 0;
+
+			for (int index = layerStart[l]; index < end; index++)
+				if (keep[index] && !IsBias (l, index)) { total += fabs (weights[index]); kept++; }
+
+			cut = (kept > 0) ? threshold * total / kept : 0;
+		}
+
+		for (int index = layerStart[l]; index < end; index++)
+			if (!IsBias (l, index) && fabs (weights[index]) < cut) keep[index] = 0;
+	}
+
+	Reapply (net);
+
+	return HowManyPrunable() - HowManyKept();
+}
+
+
+///<summary>
+/// Also copies the weights out, so that the Prune functions rank the weights as they are now
+///</summary>
+void WeightPruner::Reapply (LinearLayerNetwork *net)
+{
+	net->ReturnTheWeights (&weights[0]);
+	net->ReturnTheDeltaWeights (&deltaWeights[0]);
+
+	for (size_t ct=0; ct < keep.size(); ct++)
+	{
+		if (keep[ct]) continue;
+
+		weights[ct] = 0;
+		deltaWeights[ct] = 0;
+	}
+
+	net->SetTheWeights (&weights[0]);
+	net->SetTheDeltaWeights (&deltaWeights[0]);
+}
+
+
+///<summary>
+/// Rows are passed one at a time, with the pruned weights put back to 0 after each: every row's deltas are found before
+/// any weight changes, so each forward pass, and each change, is that of the pruned network alone
+///</summary>
+void WeightPruner::FineTune (LinearLayerNetwork *net, dataset &data, const double learningParameters[], int epochs)
+{
+	for (int epoch=0; epoch < epochs; epoch++)
+	{
+		for (int row=0; row < data.numData(); row++)
+		{
+			net->AdaptRows (data, &row, 1, learningParameters);
+			Reapply (net);
+		}
+	}
+}
+
+
+int WeightPruner::HowManyPrunable ()
+{
+	int total = 0;
+
+	for (size_t l=0; l < layers.size(); l++) total += layers[l].numInputs * layers[l].numNeurons;
+
+	return total;
+}
+
+
+int WeightPruner::HowManyKept ()
+{
+	int total = 0;
+
+	for (int l=0; l < (int) layers.size(); l++)
+		for (int index = layerStart[l]; index < layerStart[l] + (layers[l].numInputs + 1) * layers[l].numNeurons; index++)
+			if (keep[index] && !IsBias (l, index)) total++;
+
+	return total;
+}
+
+
+double WeightPruner::LayerDensity (int layer)
+{
+	int end = layerStart[layer] + (layers[layer].numInputs + 1) * layers[layer].numNeurons;
+	int kept = 0;
+
+	for (int index = layerStart[layer]; index < end; index++)
+		if (keep[index] && !IsBias (layer, index)) kept++;
+
+	return (layers[layer].numInputs > 0) ? (double) kept / (layers[layer].numInputs * layers[layer].numNeurons) : 1;
+}
+
+
+// Implementation of SparseWeightNetwork *****************************
+
+///<summary>
+/// Weights are taken in SetTheWeights order, a bias then numInputs weights for each neuron of each layer
+///</summary>
+SparseWeightNetwork::SparseWeightNetwork (LinearLayerNetwork *net)
+{
+	Checkpoint::Describe (net, layers);
+
+	vector<double> allWeights (net->HowManyWeights());
+	net->ReturnTheWeights (&allWeights[0]);
+
+	int widest = 0;
+	rowStart.push_back (0);
+
+	for (size_t l=0, start=0; l < layers.size(); l++)
+	{
+		const CheckpointLayer &layer = layers[l];
+		int numWeights = (layer.numInputs + 1) * layer.numNeurons;
+
+		int nonZeros = 0;
+		for (int ct=0; ct < numWeights; ct++)
+			if (ct % (layer.numInputs + 1) != 0 && allWeights[start + ct] != 0) nonZeros++;
+
+		bool isSparse = nonZeros <= SPARSE_LAYER_DENSITY * layer.numInputs * layer.numNeurons;
+		sparse.push_back (isSparse);
+
+		denseStart.push_back ((int) denseWeights.size());
+		neuronStart.push_back ((int) biases.size());
+
+		if (!isSparse) denseWeights.insert (denseWeights.end(), &allWeights[start], &allWeights[start] + numWeights);
+		else
+		{
+			const double *neuronWeights = &allWeights[start];
+
+			for (int neuron=0; neuron < layer.numNeurons; neuron++, neuronWeights += layer.numInputs + 1)
+			{
+				biases.push_back (neuronWeights[0]);
+
+				for (int ct=0; ct < layer.numInputs; ct++)
+				{
+					if (neuronWeights[ct + 1] == 0) continue;
+
+					columns.push_back (ct);
+					values.push_back (neuronWeights[ct + 1]);
+				}
+
+				rowStart.push_back ((int) columns.size());
+			}
+		}
+
+		start += numWeights;
+		widest = max (widest, layer.numNeurons);
+	}
+
+	hidden[0].resize (widest);
+	hidden[1].resize (widest);
+}
+
+
+void SparseWeightNetwork::DenseSums (int layer, const double inputs[], double sums[])
+{
+	const double *layerWeights = &denseWeights[denseStart[layer]];
+	int numInputs = layers[layer].numInputs;
+
+	for (int neuron=0; neuron < layers[layer].numNeurons; neuron++)
+	{
+		double sum = *layerWeights++;
+
+		for (int ct=0; ct < numInputs; ct++)
+			sum += inputs[ct] * *layerWeights++;
+
+		sums[neuron] = sum;
+	}
+}
+
+
+///<summary>
+/// Each neuron gathers the inputs of its non-zero weights, in order of column, so its sum is added up
+/// in the same order as DenseSums and the network give, less the zero products
+///</summary>
+void SparseWeightNetwork::SparseSums (int layer, const double inputs[], double sums[])
+{
+	int first = neuronStart[layer];
+
+	for (int neuron=0; neuron < layers[layer].numNeurons; neuron++)
+	{
+		double sum = biases[first + neuron];
+
+		for (int ct = rowStart[first + neuron]; ct < rowStart[first + neuron + 1]; ct++)
+			sum += inputs[columns[ct]] * values[ct];
+
+		sums[neuron] = sum;
+	}
+}
+
+
+void SparseWeightNetwork::Forward (const double inputs[], double outputs[])
+{
+	const double *layerInputs = inputs;
+	int numLayers = (int) layers.size();
+
+	for (int l=0; l < numLayers; l++)
+	{
+		const CheckpointLayer &layer = layers[l];
+		double *layerOutputs = (l == numLayers - 1) ? outputs : &hidden[l % 2][0];
+
+		if (sparse[l]) SparseSums (l, layerInputs, layerOutputs);
+		else DenseSums (l, layerInputs, layerOutputs);
+
+		//Activation of the layer, as in LayerType()
+		if (layer.layerType == 'C') Softmax (layerOutputs, layer.numNeurons);
+		else if (layer.layerType != 'L')
+			for (int neuron=0; neuron < layer.numNeurons; neuron++)
+				layerOutputs[neuron] = ActivateSum ((char) layer.layerType, layerOutputs[neuron]);
+
+		layerInputs = layerOutputs;
+	}
+}
+
+
+void SparseWeightNetwork::ComputeNetwork (dataset &data)
+{
+	vector<double> outputs (layers.back().numNeurons);
+
+	for (int row=0; row < data.numData(); row++)
+	{
+		Forward (data.GetNthInputs(row), &outputs[0]);
+		data.SetNthOutputs (row, &outputs[0]);
+	}
+}
+
+
+long long SparseWeightNetwork::HowManyStored ()
+{
+	return (long long) (denseWeights.size() + biases.size() + values.size());
+}
+
+
+///<summary>
+/// A sparse weight takes its value and an int column, a sparse neuron its bias and an int start
+///</summary>
+long long SparseWeightNetwork::StoredBytes ()
+{
+	return (long long) (denseWeights.size() * sizeof(double) + biases.size() * sizeof(double)
+						+ rowStart.size() * sizeof(int) + columns.size() * sizeof(int) + values.size() * sizeof(double));
+}
+
+
+long long SparseWeightNetwork::DenseBytes ()
+{
+	long long total = 0;
+
+	for (size_t l=0; l < layers.size(); l++) total += (long long) (layers[l].numInputs + 1) * layers[l].numNeurons;
+
+	return total * (long long) sizeof(double);
+}
+
+
+bool SparseWeightNetwork::IsSparse (int layer)
+{
+	return sparse[layer];
+}
+
+#endif
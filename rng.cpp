@@ -0,0 +1,111 @@
+/*
+*	Library Module Implementing the seeded random-number generators
+*/
+
+#ifndef RNG_CPP
+#define RNG_CPP
+
+#include "Header/library.h"
+
+
+///<summary>
+/// Finishing step of splitmix64: nearby inputs give unrelated outputs
+///</summary>
+unsigned long long MixBits (unsigned long long z)
+{
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+
+unsigned long long DeriveSeed (unsigned long long seed, unsigned long long stream)
+{
+	return MixBits (seed + MixBits (stream + 0x9E3779B97F4A7C15ULL));
+}
+
+
+// Implementation of RandomStream *****************************
+
+RandomStream::RandomStream (unsigned long long seed, unsigned long long stream)
+{
+	Seed (seed, stream);
+}
+
+
+///<summary>
+/// Fills the state with four splitmix64 steps from the derived seed, as the authors of xoshiro advise;
+/// the state can then never be all 0
+///</summary>
+void RandomStream::Seed (unsigned long long seed, unsigned long long stream)
+{
+	unsigned long long z = DeriveSeed (seed, stream);
+
+	for (int ct=0; ct < 4; ct++)
+	{
+		z += 0x9E3779B97F4A7C15ULL;
+		state[ct] = MixBits (z);
+	}
+}
+
+
+unsigned long long RandomStream::Next ()
+{
+	unsigned long long result = state[1] * 5;
+	result = ((result << 7) | (result >> 57)) * 9;
+
+	unsigned long long t = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+
+	state[2] ^= t;
+	state[3] = (state[3] << 45) | (state[3] >> 19);
+
+	return result;
+}
+
+
+///<summary>
+/// The top 53 bits, as many as a double holds
+///</summary>
+double RandomStream::Uniform ()
+{
+	return (Next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+double RandomStream::Symmetric ()
+{
+	return -1.0 + 2.0 * Uniform();
+}
+
+
+///<summary>
+/// Reduced to 0..n-1 by a multiply rather than a divide
+///</summary>
+int RandomStream::Below (int n)
+{
+	return (int) (((Next() >> 32) * (unsigned long long) n) >> 32);
+}
+
+
+// Generator of each thread *****************************
+
+RandomStream & ThreadRandom ()
+{
+	static thread_local RandomStream random;
+
+	return random;
+}
+
+
+void SeedThreadRandom (unsigned long long seed, unsigned long long stream)
+{
+	ThreadRandom().Seed (seed, stream);
+}
+
+#endif
@@ -0,0 +1,446 @@
+/*
+*	Library Module Implementing streaming batch scoring of input files
+*/
+
+#ifndef SCORE_CPP
+#define SCORE_CPP
+
+#include "Header/library.h"
+
+
+//Bytes of text read from the input at a time
+const size_t SCORE_TEXT_BLOCK = 1 << 20;
+
+
+///<summary>
+/// Constructor: two chunks per thread, so one can be read while another is scored, plus two for the reader and writer
+///</summary>
+BatchScorer::BatchScorer (LinearLayerNetwork *network, const DataScaling &dataScaling, int threads, int rowsInChunk)
+{
+	net = network;
+	scaling = dataScaling;
+
+	numInputs = net->HowManyInputs();
+	numOutputs = net->HowManyOutputs();
+
+	if (scaling.mindata.empty())
+	{
+		scaling.numinputs = numInputs;
+		scaling.numoutputs = numOutputs;
+	}
+
+	numThreads = (threads > 0) ? threads : 1;
+	chunkRows = (rowsInChunk > 0) ? rowsInChunk : 1;
+
+	chunks.resize (2 * numThreads + 2);
+	for (size_t c=0; c < chunks.size(); c++)
+	{
+		chunks[c].inputs.resize (chunkRows * numInputs);
+		chunks[c].outputs.resize (chunkRows * numOutputs);
+		chunks[c].rows = 0;
+	}
+
+	text.resize (SCORE_TEXT_BLOCK);
+
+	pipeline = 0;
+}
+
+
+void BatchScorer::UsePipeline (LayerPipeline *thePipeline)
+{
+	pipeline = thePipeline;
+}
+
+
+///<summary>
+/// Starts the reader and the scoring threads, then writes each chunk as soon as it and every chunk before it are scored
+///</summary>
+long long BatchScorer::Score (const char *inputFile, const char *outputFile, WriterFormat format)
+{
+	error.clear();
+
+	FILE *file = fopen (inputFile, "rb");
+	if (file == 0)
+	{
+		error = string("Unable to open ") + inputFile;
+		return -1;
+	}
+
+	//A binary input starts as every ResultWriter binary file does
+	char magic[sizeof(WRITER_MAGIC)];
+	bool binary = (fread (magic, 1, sizeof(magic), file) == sizeof(magic)) && (memcmp (magic, WRITER_MAGIC, sizeof(magic)) == 0);
+	rewind (file);
+
+	ResultWriter writer (outputFile, numOutputs, format, chunkRows);
+	if (!writer.IsOpen())
+	{
+		fclose (file);
+		error = string("Unable to create ") + outputFile;
+		return -1;
+	}
+
+	freeChunks.clear();
+	readChunks.clear();
+	for (size_t c=0; c < chunks.size(); c++) freeChunks.push_back ((int) c);
+	scoredChunks.assign (chunks.size(), -1);
+	endOfInput = false;
+	numRead = 0;
+
+	thread reader (&BatchScorer::ReadLoop, this, file, binary);
+
+	//A pipeline has threads of its own, so is fed by one
+	int scoringThreads = (pipeline != 0) ? 1 : numThreads;
+
+	vector<thread> scorers;
+	for (int t=0; t < scoringThreads; t++) scorers.push_back (thread (&BatchScorer::ScoreLoop, this));
+
+	long long rows = 0;
+
+	for (long long next=0; ; next++)
+	{
+		int c;
+		{
+			unique_lock<mutex> guard (lock);
+
+			changed.wait (guard, [&] () { return scoredChunks[next % chunks.size()] >= 0 || (endOfInput && next >= numRead); });
+
+			c = scoredChunks[next % chunks.size()];
+			if (c < 0) break;
+
+			scoredChunks[next % chunks.size()] = -1;
+		}
+
+		WriterChunk *out = writer.GetChunk();
+		dcopy (chunks[c].rows * numOutputs, &chunks[c].outputs[0], out->values);
+		out->rows = chunks[c].rows;
+		writer.Submit (out);
+
+		rows += chunks[c].rows;
+
+		{
+			lock_guard<mutex> guard (lock);
+			freeChunks.push_back (c);
+		}
+		changed.notify_all();
+	}
+
+	reader.join();
+	for (int t=0; t < scoringThreads; t++) scorers[t].join();
+
+	writer.Close();
+	fclose (file);
+
+	return error.empty() ? rows : -1;
+}
+
+
+const char * BatchScorer::Error ()
+{
+	return error.c_str();
+}
+
+
+void BatchScorer::ReadLoop (FILE *file, bool binary)
+{
+	if (binary) ReadBinary (file);
+	else ReadText (file);
+
+	{
+		lock_guard<mutex> guard (lock);
+		endOfInput = true;
+	}
+	changed.notify_all();
+}
+
+
+int BatchScorer::TakeFreeChunk ()
+{
+	unique_lock<mutex> guard (lock);
+
+	changed.wait (guard, [this] () { return !freeChunks.empty(); });
+
+	int c = freeChunks.front();
+	freeChunks.pop_front();
+
+	return c;
+}
+
+
+void BatchScorer::ChunkRead (int c)
+{
+	{
+		lock_guard<mutex> guard (lock);
+
+		if (chunks[c].rows > 0)
+		{
+			chunks[c].sequence = numRead++;
+			readChunks.push_back (c);
+		}
+		else freeChunks.push_back (c);
+	}
+	changed.notify_all();
+}
+
+
+///<summary>
+/// Skips white space, then parses the word up to the next white space. A word cut off by the end of
+/// the block is moved to the front, and the rest of the block filled from the file
+///</summary>
+bool BatchScorer::NextValue (FILE *file, double &value)
+{
+	for (;;)
+	{
+		while (textStart < textEnd && isspace (text[textStart])) textStart++;
+
+		size_t end = textStart;
+		while (end < textEnd && !isspace (text[end])) end++;
+
+		if (end > textStart && (end < textEnd || feof (file)))
+		{
+			from_chars_result parsed = from_chars (&text[textStart], &text[end], value);
+
+			//from_chars takes no leading '+', which >> does
+			if (parsed.ec != errc() || parsed.ptr != &text[end])
+			{
+				string word (&text[textStart], &text[end]);
+				char *stop;
+				value = strtod (word.c_str(), &stop);
+
+				if (*stop != 0)
+				{
+					error = "Not a number: " + word;
+					return false;
+				}
+			}
+
+			textStart = end;
+			return true;
+		}
+
+		if (feof (file)) return false;
+
+		//Keeps the unfinished word, and makes room for it if it fills the block
+		memmove (&text[0], &text[textStart], textEnd - textStart);
+		textEnd -= textStart;
+		textStart = 0;
+		if (textEnd == text.size()) text.resize (2 * text.size());
+
+		textEnd += fread (&text[textEnd], 1, text.size() - textEnd, file);
+	}
+}
+
+
+///<summary>
+/// Reads the sizes and datatype, skips the min/max (those of the checkpoint are used), then reads rows
+/// of inputs and targets, keeping the inputs. Rows are read until the stated amount, or until the end
+/// of the file if that is 0
+///</summary>
+void BatchScorer::ReadText (FILE *file)
+{
+	textStart = 0;
+	textEnd = 0;
+
+	double header[4];
+	for (int ct=0; ct < 4; ct++)
+	{
+		if (!NextValue (file, header[ct]))
+		{
+			if (error.empty()) error = "Missing sizes at the start of the file";
+			return;
+		}
+	}
+
+	int numins = (int) header[0], numouts = (int) header[1], datatype = (int) header[3];
+	long long remaining = (header[2] > 0) ? (long long) header[2] : LLONG_MAX;
+
+	if (numins != numInputs)
+	{
+		error = "File has " + to_string(numins) + " inputs, the network " + to_string(numInputs);
+		return;
+	}
+
+	double skipped;
+	if (datatype > 0)
+		for (int ct=0; ct < 2 * (numins + numouts); ct++)
+			if (!NextValue (file, skipped))
+			{
+				if (error.empty()) error = "Missing min/max";
+				return;
+			}
+
+	bool more = true;
+
+	while (more && remaining > 0)
+	{
+		int c = TakeFreeChunk();
+		ScoreChunk &chunk = chunks[c];
+		chunk.rows = 0;
+
+		while (chunk.rows < chunkRows && remaining > 0)
+		{
+			double *rowInputs = &chunk.inputs[chunk.rows * numInputs];
+
+			//End of the file, if it comes before the first input of a row
+			if (!NextValue (file, rowInputs[0]))
+			{
+				more = false;
+				break;
+			}
+
+			bool whole = true;
+			for (int ct=1; ct < numInputs && whole; ct++) whole = NextValue (file, rowInputs[ct]);
+			for (int ct=0; ct < numouts && whole; ct++) whole = NextValue (file, skipped);
+
+			if (!whole)
+			{
+				if (error.empty()) error = "Row " + to_string(numRead * chunkRows + chunk.rows + 1) + " is cut short";
+				more = false;
+				break;
+			}
+
+			chunk.rows++;
+			remaining--;
+		}
+
+		ChunkRead (c);
+	}
+}
+
+
+///<summary>
+/// Reads the header written by ResultWriter, then whole chunks of rows at a time,
+/// keeping the first numInputs columns of each
+///</summary>
+void BatchScorer::ReadBinary (FILE *file)
+{
+	char magic[sizeof(WRITER_MAGIC)];
+	int header[2];
+	long long numRows;
+
+	if (fread (magic, 1, sizeof(magic), file) != sizeof(magic) || fread (header, sizeof(int), 2, file) != 2 || fread (&numRows, sizeof(long long), 1, file) != 1)
+	{
+		error = "Binary header is cut short";
+		return;
+	}
+
+	int numColumns = header[1];
+
+	if (header[0] != WRITER_BINARY || numColumns < numInputs)
+	{
+		error = "Binary file must be in rows of at least " + to_string(numInputs) + " columns";
+		return;
+	}
+
+	//A file not closed properly has 0 rows stated, so is read to its end
+	long long remaining = (numRows > 0) ? numRows : LLONG_MAX;
+
+	vector<double> rowsRead ((size_t) chunkRows * numColumns);
+
+	while (remaining > 0)
+	{
+		int c = TakeFreeChunk();
+		ScoreChunk &chunk = chunks[c];
+
+		size_t wanted = (size_t) min<long long> (remaining, chunkRows);
+		size_t got = fread (&rowsRead[0], sizeof(double) * numColumns, wanted, file);
+
+		for (size_t row=0; row < got; row++)
+			dcopy (numInputs, &rowsRead[row * numColumns], &chunk.inputs[row * numInputs]);
+
+		chunk.rows = (int) got;
+		remaining -= got;
+
+		ChunkRead (c);
+
+		if (got < wanted)
+		{
+			long long dataBytes = ftell (file) - (long long) (sizeof(magic) + sizeof(header) + sizeof(numRows));
+
+			if (numRows > 0) error = "Binary file ends before its last row";
+			else if (dataBytes % (sizeof(double) * numColumns) != 0) error = "Binary file ends part way through a row";
+			break;
+		}
+	}
+}
+
+
+///<summary>
+/// Scales inputs and rescales outputs in place, each thread using a workspace of its own for ForwardBatch.
+/// A chunk given to the pipeline is waited for only once the next is given to it, so the stages run on from one
+/// chunk into the next instead of emptying between them; with no chunk read yet, the one in the pipeline is finished
+///</summary>
+void BatchScorer::ScoreLoop ()
+{
+	vector<double> workspace (net->BatchWorkspace (chunkRows) + 1);
+
+	//Chunk in the pipeline, else -1, and its ticket
+	int pending = -1;
+	long long ticket = 0;
+
+	for (;;)
+	{
+		int c = -1;
+		{
+			unique_lock<mutex> guard (lock);
+
+			if (pending < 0) changed.wait (guard, [this] () { return !readChunks.empty() || endOfInput; });
+
+			if (!readChunks.empty())
+			{
+				c = readChunks.front();
+				readChunks.pop_front();
+			}
+		}
+
+		if (c < 0)
+		{
+			if (pending < 0) return;
+
+			pipeline->Wait (ticket);
+			ChunkScored (pending);
+			pending = -1;
+			continue;
+		}
+
+		ScoreChunk &chunk = chunks[c];
+
+		for (int row=0; row < chunk.rows; row++)
+			scaling.ScaleInputs (&chunk.inputs[row * numInputs], &chunk.inputs[row * numInputs]);
+
+		if (pipeline != 0)
+		{
+			long long next = pipeline->Submit (&chunk.inputs[0], chunk.rows, &chunk.outputs[0]);
+
+			if (pending >= 0)
+			{
+				pipeline->Wait (ticket);
+				ChunkScored (pending);
+			}
+
+			pending = c;
+			ticket = next;
+			continue;
+		}
+
+		net->ForwardBatch (&chunk.inputs[0], chunk.rows, &chunk.outputs[0], &workspace[0]);
+
+		ChunkScored (c);
+	}
+}
+
+
+void BatchScorer::ChunkScored (int c)
+{
+	ScoreChunk &chunk = chunks[c];
+
+	for (int row=0; row < chunk.rows; row++)
+		scaling.RescaleOutputs (&chunk.outputs[row * numOutputs], &chunk.outputs[row * numOutputs]);
+
+	{
+		lock_guard<mutex> guard (lock);
+		scoredChunks[chunk.sequence % chunks.size()] = c;
+	}
+	changed.notify_all();
+}
+
+#endif
@@ -0,0 +1,399 @@
+/*
+*	Library Module Implementing a micro-batching inference server over a Unix domain socket
+*/
+
+#ifndef SERVER_CPP
+#define SERVER_CPP
+
+#include "Header/library.h"
+
+
+///<summary>
+/// Writes all of the bytes to a socket, waiting for room if it is full. Returns false if the other end has gone,
+/// or if there is still no room once the deadline has passed
+///
+///<argument="int milliseconds">Longest the whole write may take</argument>
+///</summary>
+bool SendAll (int fd, const char *bytes, size_t count, int milliseconds)
+{
+	chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::milliseconds (milliseconds);
+
+	while (count > 0)
+	{
+		ssize_t sent = send (fd, bytes, count, MSG_NOSIGNAL);
+
+		if (sent > 0)
+		{
+			bytes += sent;
+			count -= sent;
+		}
+		else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			int wait = (int) chrono::duration_cast<chrono::milliseconds> (deadline - chrono::steady_clock::now()).count();
+			if (wait <= 0) return false;
+
+			struct pollfd room = { fd, POLLOUT, 0 };
+			poll (&room, 1, wait);
+		}
+		else if (sent < 0 && errno == EINTR) {}
+		else return false;
+	}
+
+	return true;
+}
+
+
+///<summary>
+/// Reads exactly count bytes from a blocking socket. Returns false if the other end has gone
+///</summary>
+bool ReceiveAll (int fd, char *bytes, size_t count)
+{
+	while (count > 0)
+	{
+		ssize_t got = recv (fd, bytes, count, 0);
+
+		if (got > 0)
+		{
+			bytes += got;
+			count -= got;
+		}
+		else if (got < 0 && errno == EINTR) {}
+		else return false;
+	}
+
+	return true;
+}
+
+
+// Implementation of InferenceServer *****************************
+
+///<summary>
+/// Constructor. With no min/max saved alongside the network, requests are passed through unscaled
+///</summary>
+InferenceServer::InferenceServer (LinearLayerNetwork *network, const DataScaling &dataScaling, const char *path, int batchSize, int budgetMicroseconds)
+{
+	net = network;
+	scaling = dataScaling;
+
+	numInputs = net->HowManyInputs();
+	numOutputs = net->HowManyOutputs();
+
+	if (scaling.mindata.empty())
+	{
+		scaling.numinputs = numInputs;
+		scaling.numoutputs = numOutputs;
+	}
+
+	socketPath = path;
+	listener = -1;
+
+	maxBatch = (batchSize > 0) ? batchSize : 1;
+	budget = chrono::microseconds (budgetMicroseconds);
+
+	batchInputs.resize (maxBatch * numInputs);
+	batchOutputs.resize (maxBatch * numOutputs);
+	workspace.resize (net->BatchWorkspace (maxBatch) + 1);
+	rawOutputs.resize (numOutputs);
+
+	pending.reserve (maxBatch);
+
+	latencies.resize (SERVER_LATENCY_SAMPLES);
+	numLatencies = 0;
+
+	requests = 0;
+	batches = 0;
+	running = false;
+}
+
+
+InferenceServer::~InferenceServer ()
+{
+	Stop();
+}
+
+
+///<summary>
+/// Replaces any socket left at the path by an earlier server, then listens on it
+///</summary>
+bool InferenceServer::Start ()
+{
+	struct sockaddr_un address;
+	memset (&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+
+	if (socketPath.size() >= sizeof(address.sun_path)) return false;
+	strcpy (address.sun_path, socketPath.c_str());
+
+	unlink (socketPath.c_str());
+
+	listener = socket (AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	if (listener < 0) return false;
+
+	if (bind (listener, (struct sockaddr *) &address, sizeof(address)) != 0 || listen (listener, 128) != 0)
+	{
+		close (listener);
+		listener = -1;
+		return false;
+	}
+
+	started = chrono::steady_clock::now();
+	running = true;
+	worker = thread (&InferenceServer::ServeLoop, this);
+
+	return true;
+}
+
+
+void InferenceServer::Stop ()
+{
+	running = false;
+	if (worker.joinable()) worker.join();
+
+	for (size_t c=0; c < connections.size(); c++)
+		if (connections[c].fd >= 0) close (connections[c].fd);
+	connections.clear();
+	pending.clear();
+
+	if (listener >= 0)
+	{
+		close (listener);
+		unlink (socketPath.c_str());
+		listener = -1;
+	}
+}
+
+
+///<summary>
+/// Waits on the listener and on every client not already in the batch. While a batch is open the wait
+/// ends when the first request's budget runs out, else every 100ms to see whether the server is stopped
+///</summary>
+void InferenceServer::ServeLoop ()
+{
+	vector<struct pollfd> waitingOn;
+	vector<int> connectionOf;
+
+	while (running)
+	{
+		waitingOn.clear();
+		connectionOf.clear();
+
+		waitingOn.push_back ({ listener, POLLIN, 0 });
+		connectionOf.push_back (-1);
+
+		for (size_t c=0; c < connections.size(); c++)
+		{
+			if (connections[c].fd >= 0 && !connections[c].waiting)
+			{
+				waitingOn.push_back ({ connections[c].fd, POLLIN, 0 });
+				connectionOf.push_back ((int) c);
+			}
+		}
+
+		chrono::nanoseconds wait = chrono::milliseconds (100);
+		if (!pending.empty())
+		{
+			wait = connections[pending[0]].arrived + budget - chrono::steady_clock::now();
+			if (wait.count() < 0) wait = chrono::nanoseconds (0);
+		}
+
+		struct timespec timeout = { (time_t) (wait.count() / 1000000000), (long) (wait.count() % 1000000000) };
+
+		int ready = ppoll (&waitingOn[0], waitingOn.size(), &timeout, 0);
+
+		for (size_t w=0; ready > 0 && w < waitingOn.size(); w++)
+		{
+			if (waitingOn[w].revents == 0) continue;
+
+			if (connectionOf[w] < 0)
+			{
+				//New clients
+				int client;
+				while ((client = accept4 (listener, 0, 0, SOCK_NONBLOCK)) >= 0)
+				{
+					ServerConnection connection;
+					connection.fd = client;
+					connection.request.resize (numInputs);
+					connection.received = 0;
+					connection.waiting = false;
+
+					connections.push_back (connection);
+				}
+			}
+			else
+			{
+				ServerConnection &connection = connections[connectionOf[w]];
+
+				if (!ReadRequest (connection))
+				{
+					close (connection.fd);
+					connection.fd = -1;
+				}
+				else if (connection.waiting)
+				{
+					pending.push_back (connectionOf[w]);
+				}
+			}
+
+			if ((int) pending.size() >= maxBatch) RunBatch();
+		}
+
+		//Runs the batch once its budget is spent, or at once if every client is already in it, as none can join
+		int numConnected = 0;
+		for (size_t c=0; c < connections.size(); c++)
+			if (connections[c].fd >= 0) numConnected++;
+		
+		if (!pending.empty() && ((int) pending.size() == numConnected || chrono::steady_clock::now() >= connections[pending[0]].arrived + budget)) RunBatch();
+
+		//Clients that have gone are removed between batches, so pending never holds a stale index
+		if (pending.empty())
+		{
+			size_t kept = 0;
+			for (size_t c=0; c < connections.size(); c++)
+				if (connections[c].fd >= 0) connections[kept++] = connections[c];
+			connections.resize (kept);
+		}
+	}
+}
+
+
+///<summary>
+/// Reads as much of the request as has arrived, without blocking
+///</summary>
+bool InferenceServer::ReadRequest (ServerConnection &connection)
+{
+	size_t requestBytes = numInputs * sizeof(double);
+
+	ssize_t got = recv (connection.fd, (char *) &connection.request[0] + connection.received, requestBytes - connection.received, 0);
+
+	if (got == 0) return false;
+	if (got < 0) return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+
+	connection.received += got;
+
+	if (connection.received == requestBytes)
+	{
+		connection.waiting = true;
+		connection.arrived = chrono::steady_clock::now();
+	}
+
+	return true;
+}
+
+
+///<summary>
+/// Scales each request into its row of the batch, runs the batch, then rescales and sends each row of outputs
+///</summary>
+void InferenceServer::RunBatch ()
+{
+	int numRows = (int) pending.size();
+
+	for (int row=0; row < numRows; row++)
+		scaling.ScaleInputs (&connections[pending[row]].request[0], &batchInputs[row * numInputs]);
+
+	net->ForwardBatch (&batchInputs[0], numRows, &batchOutputs[0], &workspace[0]);
+
+	for (int row=0; row < numRows; row++)
+	{
+		ServerConnection &connection = connections[pending[row]];
+
+		scaling.RescaleOutputs (&batchOutputs[row * numOutputs], &rawOutputs[0]);
+
+		if (!SendAll (connection.fd, (const char *) &rawOutputs[0], numOutputs * sizeof(double), SERVER_SEND_MILLISECONDS))
+		{
+			close (connection.fd);
+			connection.fd = -1;
+		}
+
+		float microseconds = chrono::duration<float, micro> (chrono::steady_clock::now() - connection.arrived).count();
+
+		connection.received = 0;
+		connection.waiting = false;
+
+		lock_guard<mutex> guard (statsLock);
+		latencies[numLatencies++ % SERVER_LATENCY_SAMPLES] = microseconds;
+	}
+
+	requests += numRows;
+	batches++;
+	pending.clear();
+}
+
+
+///<summary>
+/// Percentiles are found on a copy of the kept latencies, so serving is held up only for the copy
+///</summary>
+ServerStats InferenceServer::GetStats ()
+{
+	ServerStats stats;
+	vector<double> sorted;
+
+	{
+		lock_guard<mutex> guard (statsLock);
+		sorted.assign (latencies.begin(), latencies.begin() + min<long long> (numLatencies, SERVER_LATENCY_SAMPLES));
+	}
+
+	stats.requests = requests;
+	stats.batches = batches;
+	stats.meanBatch = (stats.batches > 0) ? (double) stats.requests / stats.batches : 0;
+	stats.p50 = Percentile (sorted, 0.5);
+	stats.p99 = Percentile (sorted, 0.99);
+
+	double seconds = chrono::duration<double> (chrono::steady_clock::now() - started).count();
+	stats.requestsPerSecond = (seconds > 0) ? stats.requests / seconds : 0;
+
+	return stats;
+}
+
+
+void InferenceServer::PrintStats ()
+{
+	ServerStats stats = GetStats();
+
+	printf ("Requests [%lld] Batches [%lld] Mean batch [%.2f]\n", stats.requests, stats.batches, stats.meanBatch);
+	printf ("Latency p50 [%.1f us] p99 [%.1f us] Throughput [%.0f requests/s]\n", stats.p50, stats.p99, stats.requestsPerSecond);
+}
+
+
+// Implementation of InferenceClient *****************************
+
+InferenceClient::InferenceClient (const char *socketPath, int numIns, int numOuts)
+{
+	numInputs = numIns;
+	numOutputs = numOuts;
+
+	struct sockaddr_un address;
+	memset (&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy (address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+
+	fd = socket (AF_UNIX, SOCK_STREAM, 0);
+
+	if (fd >= 0 && connect (fd, (struct sockaddr *) &address, sizeof(address)) != 0)
+	{
+		close (fd);
+		fd = -1;
+	}
+}
+
+
+InferenceClient::~InferenceClient ()
+{
+	if (fd >= 0) close (fd);
+}
+
+
+bool InferenceClient::IsOpen ()
+{
+	return fd >= 0;
+}
+
+
+bool InferenceClient::Predict (const double rawInputs[], double rawOutputs[])
+{
+	if (fd < 0) return false;
+
+	return SendAll (fd, (const char *) rawInputs, numInputs * sizeof(double), SERVER_SEND_MILLISECONDS)
+		&& ReceiveAll (fd, (char *) rawOutputs, numOutputs * sizeof(double));
+}
+
+#endif
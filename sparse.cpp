@@ -0,0 +1,215 @@
+/*
+*	Library Module Implementing data sets of sparse inputs
+*/
+
+#ifndef SPARSE_CPP
+#define SPARSE_CPP
+
+#include "Header/library.h"
+
+
+///<summary>
+/// Rows that give a column outside the inputs, or not after the column before it, or a line that cannot be read,
+/// leave the set empty, as the sparse passes rely on the columns of each row being in order and given once
+///</summary>
+SparseDataset::SparseDataset (const char *filename, const char *theName)
+{
+	numInputs = 0;
+	numOutputs = 0;
+	numRows = 0;
+	name = theName;
+	rowStart.push_back (0);
+
+	ifstream file (filename);
+
+	int ins = 0, outs = 0, rows = 0;
+	if (!(file >> ins >> outs >> rows) || ins <= 0 || outs <= 0 || rows < 0) return;
+
+	string line;
+	getline (file, line);
+
+	vector<double> rowTargets (outs);
+
+	for (int row=0; row < rows; row++)
+	{
+		if (!getline (file, line))
+		{
+			rows = -1;
+			break;
+		}
+
+		const char *next = line.c_str();
+		char *end;
+
+		for (int ct=0; ct < outs; ct++)
+		{
+			rowTargets[ct] = strtod (next, &end);
+			if (end == next) rows = -1;
+			next = end;
+		}
+
+		//column:value pairs, to the end of the line
+		for (long previous = -1;; )
+		{
+			long column = strtol (next, &end, 10);
+			if (end == next) break;
+
+			if (*end != ':' || column <= previous || column >= ins)
+			{
+				rows = -1;
+				break;
+			}
+
+			previous = column;
+
+			next = end + 1;
+			double value = strtod (next, &end);
+			next = end;
+
+			if (value == 0) continue;
+
+			columns.push_back ((int) column);
+			values.push_back (value);
+		}
+
+		if (rows < 0) break;
+
+		rowStart.push_back ((int) columns.size());
+		targets.insert (targets.end(), rowTargets.begin(), rowTargets.end());
+	}
+
+	if (rows < 0)
+	{
+		cout << filename << " [!] Not a sparse data set" << endl;
+		rowStart.assign (1, 0);
+		columns.clear();
+		values.clear();
+		targets.clear();
+		return;
+	}
+
+	numInputs = ins;
+	numOutputs = outs;
+	numRows = rows;
+	outputs.assign ((size_t) numRows * numOutputs, 0.0);
+}
+
+
+SparseDataset::SparseDataset (int numIns, int numOuts, int theRows, const double data[], const char *theName)
+{
+	numInputs = numIns;
+	numOutputs = numOuts;
+	numRows = 0;
+	name = theName;
+	rowStart.push_back (0);
+
+	for (int row=0; row < theRows; row++)
+		AddRow (&data[(size_t) row * (numIns + numOuts)], &data[(size_t) row * (numIns + numOuts) + numIns]);
+
+	outputs.assign ((size_t) numRows * numOutputs, 0.0);
+}
+
+
+void SparseDataset::AddRow (const double inputs[], const double rowTargets[])
+{
+	for (int ct=0; ct < numInputs; ct++)
+	{
+		if (inputs[ct] == 0) continue;
+
+		columns.push_back (ct);
+		values.push_back (inputs[ct]);
+	}
+
+	rowStart.push_back ((int) columns.size());
+	targets.insert (targets.end(), rowTargets, rowTargets + numOutputs);
+	numRows++;
+}
+
+
+int SparseDataset::RowNonZeros (int n)
+{
+	return rowStart[n + 1] - rowStart[n];
+}
+
+
+const int * SparseDataset::GetNthColumns (int n)
+{
+	return columns.data() + rowStart[n];
+}
+
+
+const double * SparseDataset::GetNthValues (int n)
+{
+	return values.data() + rowStart[n];
+}
+
+
+double * SparseDataset::GetNthTargets (int n)
+{
+	return &targets[(size_t) n * numOutputs];
+}
+
+
+double * SparseDataset::GetNthOutputs (int n)
+{
+	return &outputs[(size_t) n * numOutputs];
+}
+
+
+void SparseDataset::SetNthOutputs (int n, const double rowOutputs[])
+{
+	dcopy (numOutputs, rowOutputs, GetNthOutputs(n));
+}
+
+
+double SparseDataset::TotalSSE ()
+{
+	double total = 0;
+
+	for (int ct=0; ct < numOutputs; ct++)
+	{
+		double sse = 0;
+
+		for (int row=0; row < numRows; row++)
+		{
+			double error = GetNthOutputs(row)[ct] - GetNthTargets(row)[ct];
+			sse += error * error;
+		}
+
+		if (numRows > 0) total += sse / numRows;
+	}
+
+	return total;
+}
+
+
+long long SparseDataset::NonZeros ()
+{
+	return (long long) columns.size();
+}
+
+
+int SparseDataset::numIns ()
+{
+	return numInputs;
+}
+
+
+int SparseDataset::numOuts ()
+{
+	return numOutputs;
+}
+
+
+int SparseDataset::numData ()
+{
+	return numRows;
+}
+
+
+const char * SparseDataset::Name ()
+{
+	return name.c_str();
+}
+
+#endif
@@ -0,0 +1,284 @@
+/*
+*	Library Module Implementing the telemetry of training: a lock-free ring and its writer thread
+*/
+
+#ifndef TELEMETRY_CPP
+#define TELEMETRY_CPP
+
+#include "Header/library.h"
+
+
+//Names of the kinds, as written to files
+const char *TELEMETRY_KIND_NAMES[] = { "timing", "sse", "correct", "validation" };
+
+//Extensions of the files of each sink
+const char *TELEMETRY_EXTENSIONS[] = { "", ".epochs.csv", ".epochs.jsonl", ".trace.json" };
+
+
+// Implementation of TelemetryRing *****************************
+
+TelemetryRing::TelemetryRing (int perRecord)
+{
+	valuesPerRecord = perRecord;
+	store.assign ((size_t) TELEMETRY_RING_SIZE * valuesPerRecord, 0.0);
+
+	head = 0;
+	tail = 0;
+}
+
+
+///<summary>
+/// Only the trainer moves head, so it is read relaxed; the release makes the record visible before the new head
+///</summary>
+bool TelemetryRing::Push (const TelemetryRecord &record, const double values[])
+{
+	size_t at = head.load (memory_order_relaxed);
+
+	if (at - tail.load (memory_order_acquire) == TELEMETRY_RING_SIZE) return false;
+
+	size_t slot = at & (TELEMETRY_RING_SIZE - 1);
+
+	records[slot] = record;
+	records[slot].values = &store[slot * valuesPerRecord];
+	for (int ct=0; ct < record.numValues; ct++) records[slot].values[ct] = values[ct];
+
+	head.store (at + 1, memory_order_release);
+
+	return true;
+}
+
+
+///<summary>
+/// The values are copied out before tail moves on, as the trainer may then reuse the slot
+///</summary>
+bool TelemetryRing::Pop (TelemetryRecord &record, double values[])
+{
+	size_t at = tail.load (memory_order_relaxed);
+
+	if (at == head.load (memory_order_acquire)) return false;
+
+	record = records[at & (TELEMETRY_RING_SIZE - 1)];
+	for (int ct=0; ct < record.numValues; ct++) values[ct] = record.values[ct];
+	record.values = values;
+
+	tail.store (at + 1, memory_order_release);
+
+	return true;
+}
+
+
+// Implementation of Telemetry *****************************
+
+///<summary>
+/// A file that cannot be created leaves the sink as the console, so nothing is lost.
+/// Records hold at least the two values of a validation record
+///</summary>
+Telemetry::Telemetry (TelemetrySink theSink, const char *name, int theMaxValues)
+	: ring (max (theMaxValues, 2))
+{
+	maxValues = max (theMaxValues, 2);
+	popped.assign (maxValues, 0.0);
+
+	sink = theSink;
+	file = stdout;
+
+	if (sink != SINK_CONSOLE)
+	{
+		string filename = string(name) + TELEMETRY_EXTENSIONS[sink];
+
+		file = fopen (filename.c_str(), "w");
+
+		if (file == 0)
+		{
+			cout << filename << " [!] Unable to create : epochs are printed instead" << endl;
+			file = stdout;
+			sink = SINK_CONSOLE;
+		}
+	}
+
+	if (sink == SINK_CSV) fprintf (file, "kind,epoch,start,seconds,set,ipc,l1d_per_row,llc_per_row,branch_per_row,values\n");
+	if (sink == SINK_TRACE) fprintf (file, "{\"traceEvents\":[\n");
+
+	closing = false;
+	dropped = 0;
+	truncated = 0;
+	written = 0;
+	started = chrono::steady_clock::now();
+
+	writer = thread (&Telemetry::WriteLoop, this);
+}
+
+
+Telemetry::~Telemetry ()
+{
+	Close();
+}
+
+
+double Telemetry::Now ()
+{
+	return chrono::duration<double> (chrono::steady_clock::now() - started).count();
+}
+
+
+bool Telemetry::Record (TelemetryKind kind, int epoch, const double values[], int numValues, double start, double seconds,
+						const char *name, HardwareCounters *events, long long samples)
+{
+	TelemetryRecord record;
+
+	record.kind = kind;
+	record.epoch = epoch;
+	record.numValues = (values != 0) ? min (numValues, maxValues) : 0;
+	record.values = 0;
+	record.start = start;
+	record.seconds = seconds;
+	record.name = name;
+
+	if (events != 0) events->Summarise (samples, record.events);
+	else for (int ct=0; ct < COUNTER_SUMMARY; ct++) record.events[ct] = -1;
+
+	if (record.numValues < numValues && values != 0) truncated++;
+
+	if (ring.Push (record, values)) return true;
+
+	dropped++;
+	return false;
+}
+
+
+void Telemetry::Close ()
+{
+	if (!writer.joinable()) return;
+
+	closing = true;
+	writer.join();
+
+	if (sink == SINK_TRACE) fprintf (file, "\n]}\n");
+
+	if (file != stdout) fclose (file);
+	else fflush (stdout);
+
+	if (dropped > 0) cout << "Telemetry dropped [" << dropped << "] records : the ring was full" << endl;
+	if (truncated > 0) cout << "Telemetry cut short [" << truncated << "] records : more than [" << maxValues << "] values" << endl;
+}
+
+
+long long Telemetry::Dropped ()
+{
+	return dropped;
+}
+
+
+long long Telemetry::Truncated ()
+{
+	return truncated;
+}
+
+
+///<summary>
+/// Writes records as they arrive, sleeping briefly when there are none; once closing, empties the ring then ends
+///</summary>
+void Telemetry::WriteLoop ()
+{
+	TelemetryRecord record;
+
+	for (;;)
+	{
+		bool finish = closing;
+
+		while (ring.Pop (record, &popped[0])) Write (record);
+
+		if (finish) break;
+
+		if (file != stdout) fflush (file);
+
+		this_thread::sleep_for (chrono::milliseconds (1));
+	}
+}
+
+
+///<summary>
+/// Console lines are those training printed before: "\t<epoch>  values" for classtest and numtest, the epoch then
+/// "<set> : Mean Sum Square Errors are ..." when a set is named (testnet), and the validation SSEs of numtest
+///</summary>
+void Telemetry::Write (TelemetryRecord &record)
+{
+	switch (sink)
+	{
+		case SINK_CONSOLE:
+		{
+			if (record.kind == TELEMETRY_VALIDATION)
+				printf ("\tCurrentSSE[%0.30f]\tPreviousSSE[%0.30f]\n\n", record.values[0], record.values[1]);
+
+			else if (record.kind != TELEMETRY_TIMING && record.name != 0)
+			{
+				cout << "\n\tEpoch " << setw(6) << record.epoch << endl;
+				cout << record.name << " : ";
+				arrout ((record.kind == TELEMETRY_SSE) ? "Mean Sum Square Errors are " : "% Correct Classifications ", record.numValues, record.values, 1);
+			}
+
+			else if (record.kind != TELEMETRY_TIMING)
+			{
+				cout << "\t" << record.epoch;
+
+				//Hardware events, if counted, on the same line
+				bool counted = false;
+				for (int ct=0; ct < COUNTER_SUMMARY; ct++) counted = counted || (record.events[ct] >= 0);
+
+				arrout (" ", record.numValues, record.values, counted ? 0 : 1);
+				if (counted) HardwareCounters::PrintSummary (record.events);
+			}
+
+			cout << flush;
+		} break;
+
+		case SINK_CSV:
+		{
+			fprintf (file, "%s,%d,%.9f,%.9f,%s", TELEMETRY_KIND_NAMES[record.kind], record.epoch, record.start, record.seconds, record.name ? record.name : "");
+
+			//Events not counted are left empty
+			for (int ct=0; ct < COUNTER_SUMMARY; ct++)
+			{
+				if (record.events[ct] >= 0) fprintf (file, ",%.6g", record.events[ct]);
+				else fprintf (file, ",");
+			}
+
+			for (int ct=0; ct < record.numValues; ct++) fprintf (file, ",%.17g", record.values[ct]);
+			fprintf (file, "\n");
+		} break;
+
+		case SINK_JSON:
+		{
+			fprintf (file, "{\"kind\":\"%s\",\"epoch\":%d,\"start\":%.9f,\"seconds\":%.9f", TELEMETRY_KIND_NAMES[record.kind], record.epoch, record.start, record.seconds);
+			if (record.name != 0) fprintf (file, ",\"set\":\"%s\"", record.name);
+
+			const char *eventNames[COUNTER_SUMMARY] = { "ipc", "l1d_per_row", "llc_per_row", "branch_per_row" };
+			for (int ct=0; ct < COUNTER_SUMMARY; ct++)
+				if (record.events[ct] >= 0) fprintf (file, ",\"%s\":%.6g", eventNames[ct], record.events[ct]);
+
+			fprintf (file, ",\"values\":[");
+			for (int ct=0; ct < record.numValues; ct++) fprintf (file, "%s%.17g", (ct > 0) ? "," : "", record.values[ct]);
+			fprintf (file, "]}\n");
+		} break;
+
+		case SINK_TRACE:
+		{
+			//Times in microseconds; each epoch a span, and its values a counter at its end.
+			//Validation records belong to an epoch already written, so add only their counter
+			if (record.kind != TELEMETRY_VALIDATION)
+				fprintf (file, "%s{\"name\":\"epoch %d\",\"cat\":\"train\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+						(written > 0) ? ",\n" : "", record.epoch, record.start * 1e6, record.seconds * 1e6);
+
+			if (record.numValues > 0)
+			{
+				fprintf (file, "%s{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{", (written > 0 || record.kind != TELEMETRY_VALIDATION) ? ",\n" : "", TELEMETRY_KIND_NAMES[record.kind], (record.start + record.seconds) * 1e6);
+				for (int ct=0; ct < record.numValues; ct++) fprintf (file, "%s\"%d\":%.17g", (ct > 0) ? "," : "", ct, record.values[ct]);
+				fprintf (file, "}}");
+			}
+		} break;
+	}
+
+	written++;
+}
+
+#endif
@@ -0,0 +1,224 @@
+/*
+*	Library Module Implementing the background writer of results
+*/
+
+#ifndef WRITER_CPP
+#define WRITER_CPP
+
+#include "Header/library.h"
+
+
+//Start of binary and columnar files, followed by the format, the amount of columns and the amount of rows
+const char WRITER_MAGIC[8] = { 'A', 'N', 'N', 'R', 'E', 'S', '0', '1' };
+
+//Most characters a value can take in text: sign, 6 digits, point, exponent, and the tab
+const int WRITER_MAX_CHARS = 16;
+
+
+///<summary>
+/// Constructor, opens the file, makes the pool of chunks and starts the background thread
+///</summary>
+ResultWriter::ResultWriter (const char *filename, int columns, WriterFormat theFormat, int chunkRows, int numChunks)
+{
+	numColumns = columns;
+	format = theFormat;
+	closing = false;
+	rowsWritten = 0;
+
+	if (chunkRows < 1) chunkRows = 1;
+	if (numChunks < 2) numChunks = 2;
+
+	file = fopen (filename, (format == WRITER_TEXT) ? "w" : "wb");
+
+	chunks.resize (numChunks);
+	for (int c=0; c < numChunks; c++)
+	{
+		chunks[c].values = new double [chunkRows * numColumns];
+		chunks[c].rows = 0;
+		chunks[c].capacity = chunkRows;
+		freeChunks.push_back (c);
+	}
+
+	textBytes = (size_t) chunkRows * (numColumns * WRITER_MAX_CHARS + 1);
+	text = new char [textBytes];
+
+	if (file != 0 && format != WRITER_TEXT)
+	{
+		//Row count is filled in by Close()
+		int header[2] = { (int) format, numColumns };
+		long long rows = 0;
+
+		fwrite (WRITER_MAGIC, 1, sizeof(WRITER_MAGIC), file);
+		fwrite (header, sizeof(int), 2, file);
+		fwrite (&rows, sizeof(long long), 1, file);
+	}
+
+	worker = thread (&ResultWriter::WriteLoop, this);
+}
+
+
+ResultWriter::~ResultWriter ()
+{
+	Close();
+
+	for (size_t c=0; c < chunks.size(); c++) delete [] chunks[c].values;
+	delete [] text;
+}
+
+
+bool ResultWriter::IsOpen ()
+{
+	return file != 0;
+}
+
+
+void ResultWriter::WriteHeader (const char *line)
+{
+	//Only text files take a header line, and only before the thread has written anything
+	if (file != 0 && format == WRITER_TEXT) fputs (line, file);
+}
+
+
+///<summary>
+/// Waits for a free chunk, which is how a producer that is faster than the disk is held back
+///</summary>
+WriterChunk * ResultWriter::GetChunk ()
+{
+	unique_lock<mutex> lock (queueLock);
+
+	chunkFreed.wait (lock, [this] () { return !freeChunks.empty(); });
+
+	int c = freeChunks.front();
+	freeChunks.pop_front();
+
+	chunks[c].rows = 0;
+	return &chunks[c];
+}
+
+
+void ResultWriter::Submit (WriterChunk *chunk)
+{
+	{
+		lock_guard<mutex> lock (queueLock);
+		fullChunks.push_back ((int) (chunk - &chunks[0]));
+	}
+	chunkFilled.notify_one();
+}
+
+
+///<summary>
+/// Writes chunks in the order submitted, returning each to the pool once written
+///</summary>
+void ResultWriter::WriteLoop ()
+{
+	for (;;)
+	{
+		int c;
+		{
+			unique_lock<mutex> lock (queueLock);
+
+			chunkFilled.wait (lock, [this] () { return closing || !fullChunks.empty(); });
+
+			if (fullChunks.empty()) return;		// closing, and nothing left
+
+			c = fullChunks.front();
+			fullChunks.pop_front();
+		}
+
+		WriteChunk (chunks[c]);
+
+		{
+			lock_guard<mutex> lock (queueLock);
+			freeChunks.push_back (c);
+		}
+		chunkFreed.notify_one();
+	}
+}
+
+
+///<summary>
+/// Text is formatted with to_chars as ofstream would (6 significant figures), into one buffer written at once.
+/// Binary writes the rows as they are; columnar writes the row count, then each column of the chunk
+///</summary>
+void ResultWriter::WriteChunk (WriterChunk &chunk)
+{
+	if (file == 0) return;
+
+	switch (format)
+	{
+		case WRITER_TEXT:
+		{
+			char *next = text;
+			const double *value = chunk.values;
+
+			for (int r=0; r < chunk.rows; r++)
+			{
+				for (int ct=0; ct < numColumns; ct++)
+				{
+					next = to_chars (next, next + WRITER_MAX_CHARS - 1, *value++, chars_format::general, 6).ptr;
+					*next++ = '\t';
+				}
+				*next++ = '\n';
+			}
+			fwrite (text, 1, next - text, file);
+		} break;
+
+		case WRITER_BINARY:
+		{
+			fwrite (chunk.values, sizeof(double), (size_t) chunk.rows * numColumns, file);
+		} break;
+
+		case WRITER_COLUMNAR:
+		{
+			//Transpose into the text buffer, which is always large enough to hold the chunk as doubles
+			double *columns = (double *) text;
+
+			for (int r=0; r < chunk.rows; r++)
+				for (int ct=0; ct < numColumns; ct++)
+					columns[ct * chunk.rows + r] = chunk.values[r * numColumns + ct];
+
+			fwrite (&chunk.rows, sizeof(int), 1, file);
+			fwrite (columns, sizeof(double), (size_t) chunk.rows * numColumns, file);
+		} break;
+	}
+
+	rowsWritten += chunk.rows;
+}
+
+
+///<summary>
+/// Stops the background thread once all chunks are written, fills in the row count of binary files and closes
+///</summary>
+void ResultWriter::Close ()
+{
+	if (!worker.joinable()) return;
+
+	{
+		lock_guard<mutex> lock (queueLock);
+		closing = true;
+	}
+	chunkFilled.notify_one();
+	worker.join();
+
+	if (file != 0)
+	{
+		if (format != WRITER_TEXT)
+		{
+			//The count is loaded out of the atomic, whose bytes need not be those of a long long
+			long long rows = rowsWritten;
+
+			fseek (file, sizeof(WRITER_MAGIC) + 2 * sizeof(int), SEEK_SET);
+			fwrite (&rows, sizeof(long long), 1, file);
+		}
+		fclose (file);
+		file = 0;
+	}
+}
+
+
+long long ResultWriter::RowsWritten ()
+{
+	return rowsWritten;
+}
+
+#endif